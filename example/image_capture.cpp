@@ -0,0 +1,435 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \example image_capture.cpp
+ * Self check of image_capture_session_t against a stand-in compositor.
+ *
+ * A minimal compositor built with the server bindings runs in a second
+ * thread and serves ext_image_copy_capture_manager_v1 for one output. It
+ * draws a small rectangle into its screen for every frame and sends it as
+ * damage, and it only answers captures as long as it has a frame budget,
+ * so the checks below know exactly which frames exist. An encoder thread
+ * consumes the frames and compares them with what the compositor drew:
+ * the pixels, the damage rectangles, the sequence numbers and the
+ * presentation times. The session is also checked to drop frames while the
+ * encoder is stalled, and to reallocate its shm buffers after the buffer
+ * constraints changed.
+ *
+ * Usage: image_capture
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+
+#include <wayland-client.hpp>
+#include <wayland-image-capture.hpp>
+#include <wayland-server.hpp>
+#include <wayland-server-protocol.hpp>
+#include <wayland-server-protocol-staging.hpp>
+
+using namespace wayland;
+
+namespace
+{
+  std::atomic<bool> ok{true};
+
+  void check(bool condition, const std::string &what)
+  {
+    if(!condition)
+    {
+      ok = false;
+      std::cout << "FAILED: " << what << std::endl;
+    }
+  }
+
+  bool contains(const capture_rect_t &outer, const capture_rect_t &inner)
+  {
+    return outer.x <= inner.x && outer.y <= inner.y
+      && outer.x + outer.width >= inner.x + inner.width
+      && outer.y + outer.height >= inner.y + inner.height;
+  }
+
+  // what the compositor showed in a frame
+  struct frame_record_t
+  {
+    int32_t width;
+    int32_t height;
+    std::vector<uint32_t> pixels;
+    capture_rect_t damage;
+  };
+
+  class stand_in_compositor_t
+  {
+  private:
+    server::display_t display;
+    server::global_output_t output;
+    server::global_ext_output_image_capture_source_manager_v1_t source_manager;
+    server::global_ext_image_copy_capture_manager_v1_t capture_manager;
+    wl_client *client = nullptr;
+    server::ext_image_copy_capture_session_v1_t session;
+
+    int32_t width = 64;
+    int32_t height = 32;
+    std::vector<uint32_t> screen;
+    bool full_damage = true;
+
+    // the frame the client asked to capture
+    server::ext_image_copy_capture_frame_v1_t frame;
+    server::buffer_t buffer;
+    std::vector<capture_rect_t> buffer_damage;
+    bool capture_requested = false;
+    std::set<wl_resource*> known_buffers;
+
+    void send_constraints()
+    {
+      session.buffer_size(width, height);
+      session.shm_format(server::shm_format::argb8888);
+      session.shm_format(server::shm_format::xrgb8888);
+      session.done();
+    }
+
+    void resize(int32_t new_width, int32_t new_height)
+    {
+      width = new_width;
+      height = new_height;
+      screen.assign(static_cast<std::size_t>(width) * height, 0xff202020);
+      full_damage = true;
+      if(capture_requested)
+      {
+        frame.failed(server::ext_image_copy_capture_frame_v1_failure_reason::buffer_constraints);
+        capture_requested = false;
+      }
+      send_constraints();
+    }
+
+    void produce()
+    {
+      uint64_t sequence = produced + 1;
+      capture_rect_t full = { 0, 0, width, height };
+      capture_rect_t rect = { static_cast<int32_t>(sequence * 5) % (width - 6),
+                              static_cast<int32_t>(sequence * 3) % (height - 4), 6, 4 };
+      for(int32_t y = rect.y; y < rect.y + rect.height; y++)
+        for(int32_t x = rect.x; x < rect.x + rect.width; x++)
+          screen[y * width + x] = 0xff000000 | static_cast<uint32_t>(sequence * 7919 + x * 31 + y);
+      capture_rect_t damage = full_damage ? full : rect;
+      full_damage = false;
+
+      // Only the parts that the client reported as stale and the new
+      // damage are written, so wrong buffer damage shows up as wrong pixels.
+      server::shm_buffer_t shm(buffer);
+      if(!shm || shm.get_width() != width || shm.get_height() != height)
+        wrong_buffers++;
+      else
+      {
+        // captures write into the memory of the client
+        auto *dst = const_cast<uint8_t*>(static_cast<const uint8_t*>(shm.get_data()));
+        std::vector<capture_rect_t> update = buffer_damage;
+        update.push_back(damage);
+        for(auto &r : update)
+          for(int32_t y = std::max(r.y, 0); y < std::min(r.y + r.height, height); y++)
+          {
+            int32_t x = std::max(r.x, 0);
+            int32_t w = std::min(r.x + r.width, width) - x;
+            if(w > 0)
+              std::memcpy(dst + y * shm.get_stride() + x * 4, &screen[y * width + x], w * 4);
+          }
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        records[sequence] = frame_record_t{ width, height, screen, damage };
+      }
+      frame.damage(damage.x, damage.y, damage.width, damage.height);
+      frame.presentation_time(0, 100, static_cast<uint32_t>(sequence));
+      frame.ready();
+      capture_requested = false;
+      produced = sequence;
+    }
+
+  public:
+    std::atomic<int> budget{0};
+    std::atomic<bool> resize_requested{false};
+    std::atomic<bool> stop_requested{false};
+    std::atomic<bool> quit{false};
+    std::atomic<uint64_t> produced{0};
+    std::atomic<unsigned int> wrong_buffers{0};
+    std::atomic<unsigned int> destroyed_buffers{0};
+    std::mutex mutex;
+    std::map<uint64_t, frame_record_t> records;
+
+    stand_in_compositor_t()
+      : output(display), source_manager(display), capture_manager(display)
+    {
+      display.init_shm();
+      screen.assign(static_cast<std::size_t>(width) * height, 0xff101010);
+      source_manager.on_bind() = [] (const server::client_t&, server::ext_output_image_capture_source_manager_v1_t manager)
+      {
+        manager.on_create_source() = [] (server::ext_image_capture_source_v1_t, server::output_t) { };
+      };
+      capture_manager.on_bind() = [this] (const server::client_t&, server::ext_image_copy_capture_manager_v1_t manager)
+      {
+        manager.on_create_session() = [this] (server::ext_image_copy_capture_session_v1_t s, server::ext_image_capture_source_v1_t,
+                                              server::ext_image_copy_capture_manager_v1_options)
+        {
+          session = s;
+          send_constraints();
+          session.on_create_frame() = [this] (server::ext_image_copy_capture_frame_v1_t f)
+          {
+            frame = f;
+            buffer_damage.clear();
+            frame.on_attach_buffer() = [this] (server::buffer_t b)
+            {
+              buffer = b;
+              if(known_buffers.insert(b.c_ptr()).second)
+              {
+                // not buffer_t::on_destroy(), which is the destroy request
+                // and is handled by libwayland for shm buffers
+                wl_resource *resource = b.c_ptr();
+                static_cast<server::resource_t&>(b).on_destroy() = [this, resource] ()
+                {
+                  known_buffers.erase(resource);
+                  destroyed_buffers++;
+                };
+              }
+            };
+            frame.on_damage_buffer() = [this] (int32_t x, int32_t y, int32_t w, int32_t h)
+            {
+              buffer_damage.push_back(capture_rect_t{ x, y, w, h });
+            };
+            frame.on_capture() = [this] () { capture_requested = true; };
+          };
+        };
+      };
+    }
+
+    void connect(int fd)
+    {
+      client = server::client_t(display, fd).c_ptr();
+    }
+
+    void run()
+    {
+      server::event_loop_t loop = display.get_event_loop();
+      while(!quit)
+      {
+        loop.dispatch(2);
+        if(resize_requested)
+        {
+          resize(48, 40);
+          resize_requested = false;
+        }
+        if(capture_requested && stop_requested)
+        {
+          frame.failed(server::ext_image_copy_capture_frame_v1_failure_reason::stopped);
+          capture_requested = false;
+        }
+        else if(capture_requested && budget > 0)
+        {
+          budget--;
+          produce();
+        }
+        display.flush_clients();
+      }
+      // disconnect while the handlers can still run
+      wl_client_destroy(client);
+    }
+  };
+}
+
+int main()
+{
+  int fds[2];
+  if(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) < 0)
+  {
+    std::cerr << "socketpair failed" << std::endl;
+    return 1;
+  }
+
+  stand_in_compositor_t compositor;
+  compositor.connect(fds[0]);
+  std::thread stand_in_compositor_thread([&] () { compositor.run(); });
+
+  display_t display(fds[1]);
+  registry_t registry = display.get_registry();
+  output_t output;
+  shm_t shm;
+  ext_image_copy_capture_manager_v1_t capture_manager;
+  ext_output_image_capture_source_manager_v1_t source_manager;
+  registry.on_global() = [&] (uint32_t name, const std::string &interface, uint32_t)
+  {
+    if(interface == output_t::interface_name)
+      registry.bind(name, output, 1);
+    else if(interface == shm_t::interface_name)
+      registry.bind(name, shm, 1);
+    else if(interface == ext_image_copy_capture_manager_v1_t::interface_name)
+      registry.bind(name, capture_manager, 1);
+    else if(interface == ext_output_image_capture_source_manager_v1_t::interface_name)
+      registry.bind(name, source_manager, 1);
+  };
+  display.roundtrip();
+
+  image_capture_session_t capture(capture_manager, source_manager.create_source(output), shm, 0, 2, 3);
+
+  // encoder thread
+  std::atomic<bool> paused{false};
+  std::atomic<bool> finished{false};
+  std::atomic<uint64_t> last_sequence{0};
+  std::atomic<unsigned int> consumed{0};
+  std::atomic<int32_t> last_width{0};
+  std::thread encoder([&] ()
+  {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    while(!finished)
+    {
+      pollfd fd = { capture.get_frame_fd(), POLLIN, 0 };
+      poll(&fd, 1, 5);
+      while(!paused)
+      {
+        const captured_frame_t *frame = capture.acquire_frame();
+        if(!frame)
+          break;
+        std::string name = "frame " + std::to_string(frame->sequence);
+        check(frame->sequence > last_sequence, name + ": sequence increases");
+        check(frame->presentation_time == std::chrono::seconds(100) + std::chrono::nanoseconds(frame->sequence),
+              name + ": presentation time");
+        check(frame->format == shm_format::xrgb8888, name + ": preferred format");
+
+        std::lock_guard<std::mutex> lock(compositor.mutex);
+        auto record = compositor.records.find(frame->sequence);
+        if(record == compositor.records.end())
+          check(false, name + ": was drawn by the compositor");
+        else if(record->second.width != static_cast<int32_t>(frame->width)
+                || record->second.height != static_cast<int32_t>(frame->height))
+          check(false, name + ": size");
+        else
+        {
+          // the pixels of the frame must match the screen at that time
+          bool same = true;
+          for(uint32_t y = 0; y < frame->height; y++)
+            same = same && std::memcmp(frame->data + y * frame->stride, &record->second.pixels[y * frame->width],
+                                       frame->width * 4) == 0;
+          check(same, name + ": pixels");
+
+          // the damage must cover everything drawn since the previous frame
+          bool covered = true;
+          for(uint64_t s = last_sequence + 1; s <= frame->sequence; s++)
+          {
+            auto r = compositor.records.find(s);
+            if(r == compositor.records.end() || r->second.width != record->second.width)
+              continue;
+            bool found = false;
+            for(auto &d : frame->damage)
+              found = found || contains(d, r->second.damage);
+            covered = covered && found;
+          }
+          check(covered, name + ": damage covers the changes");
+          if(frame->width != width || frame->height != height)
+            check(frame->damage.size() == 1 && frame->damage[0].width == static_cast<int32_t>(frame->width)
+                  && frame->damage[0].height == static_cast<int32_t>(frame->height),
+                  name + ": full damage after a resize");
+          else if(frame->sequence == last_sequence + 1)
+            check(frame->damage.size() == 1 && frame->damage[0].x == record->second.damage.x
+                  && frame->damage[0].y == record->second.damage.y
+                  && frame->damage[0].width == record->second.damage.width
+                  && frame->damage[0].height == record->second.damage.height,
+                  name + ": damage is the drawn rectangle");
+        }
+        width = frame->width;
+        height = frame->height;
+        last_width = static_cast<int32_t>(width);
+        last_sequence = frame->sequence;
+        capture.release_frame();
+        consumed++;
+      }
+    }
+  });
+
+  // dispatches the client side until a condition is met
+  auto pump_until = [&] (const std::function<bool()> &condition)
+  {
+    for(int i = 0; i < 5000 && !condition(); i++)
+    {
+      display.roundtrip();
+      pollfd fd = { capture.get_fd(), POLLIN, 0 };
+      if(poll(&fd, 1, 1) > 0)
+        capture.dispatch();
+    }
+    return condition();
+  };
+
+  std::cout << "Frames with an idle encoder" << std::endl;
+  compositor.budget = 10;
+  check(pump_until([&] () { return last_sequence == 10; }), "all 10 frames arrive");
+  check(capture.get_dropped() == 0, "no frames are dropped");
+
+  std::cout << "Frames with a stalled encoder" << std::endl;
+  paused = true;
+  compositor.budget = 8;
+  check(pump_until([&] () { return compositor.produced == 18; }), "the compositor produces 8 frames");
+  display.roundtrip();
+  // 3 frames fill the queue, the last one is kept back, the others are dropped
+  check(capture.get_dropped() == 4, "4 frames are dropped, got " + std::to_string(capture.get_dropped()));
+  paused = false;
+  check(pump_until([&] () { return last_sequence == 18; }), "the kept back frame arrives");
+  check(consumed == 14, "14 frames are consumed, got " + std::to_string(consumed));
+
+  std::cout << "Frames after a change of the buffer constraints" << std::endl;
+  compositor.resize_requested = true;
+  pump_until([&] () { return !compositor.resize_requested; });
+  compositor.budget = 3;
+  check(pump_until([&] () { return last_sequence == 21; }), "frames of the new size arrive");
+  display.roundtrip();
+  check(last_width == 48, "frames have the new size");
+  check(compositor.destroyed_buffers == 2, "the old shm buffers are destroyed, got " + std::to_string(compositor.destroyed_buffers));
+  check(compositor.wrong_buffers == 0, "all captured buffers match the constraints");
+  check(capture.get_dropped() == 4, "the cancelled capture is not counted as dropped");
+
+  std::cout << "Stopping the session" << std::endl;
+  compositor.stop_requested = true;
+  check(pump_until([&] () { return capture.is_stopped(); }), "the session stops");
+
+  finished = true;
+  encoder.join();
+  compositor.quit = true;
+  stand_in_compositor_thread.join();
+
+  std::cout << (ok ? "All checks passed" : "Some checks failed") << std::endl;
+  return ok ? 0 : 1;
+}
@@ -28,7 +28,6 @@
  */
 
 #include <stdexcept>
-#include <array>
 #include <memory>
 #include <algorithm>
 
@@ -37,8 +36,8 @@
 #include <wayland-client-protocol-unstable.hpp>
 #include <linux/input.h>
 #include <wayland-cursor.hpp>
-
-#include "shm_common.hpp"
+#include <wayland-shm-pool.hpp>
+#include <wayland-frame-clock.hpp>
 
 using namespace wayland;
 
@@ -55,6 +54,8 @@ private:
   zxdg_decoration_manager_v1_t xdg_decoration_manager;
   seat_t seat;
   shm_t shm;
+  presentation_t presentation;
+  clockid_t presentation_clock = CLOCK_MONOTONIC;
 
   // local objects
   surface_t surface;
@@ -64,14 +65,12 @@ private:
   zxdg_toplevel_decoration_v1_t xdg_toplevel_decoration;
   pointer_t pointer;
   keyboard_t keyboard;
-  callback_t frame_cb;
   cursor_image_t cursor_image;
   buffer_t cursor_buffer;
   surface_t cursor_surface;
 
-  std::shared_ptr<shared_mem_t> shared_mem;
-  std::array<buffer_t, 2> buffer;
-  int cur_buf;
+  std::unique_ptr<shm_buffer_pool_t> buffer_pool;
+  std::unique_ptr<frame_clock_t> frame_clock;
 
   bool running;
   bool has_pointer;
@@ -79,17 +78,13 @@ private:
   int width = 640;
   int height = 480;
 
-  void create_buffers(int w, int h)
+  void resize(int w, int h)
   {
+    // The buffer pool picks up the new size on the next draw
     if (w != 0)
       width = w;
     if (h != 0)
       height = h;
-    shared_mem.reset(new shared_mem_t(2 * width * height * 4));
-    auto pool = shm.create_pool(shared_mem->get_fd(), 2 * width * height * 4);
-    for(unsigned int c = 0; c < 2; c++)
-      buffer.at(c) = pool.create_buffer(c * width * height * 4, width, height, width * 4, shm_format::argb8888);
-    cur_buf = 0;
   }
 
   void draw(uint32_t serial = 0)
@@ -135,18 +130,19 @@ private:
       | (static_cast<uint32_t>(g * 255.0) << 8)
       | static_cast<uint32_t>(b * 255.0);
 
-    std::fill_n(static_cast<uint32_t*>(shared_mem->get_mem())+cur_buf*width*height, width*height, pixel);
-    surface.attach(buffer.at(cur_buf), 0, 0);
-    surface.damage(0, 0, width, height);
-    if(!cur_buf)
-      cur_buf = 1;
-    else
-      cur_buf = 0;
+    // skip drawing if the compositor still uses both buffers
+    shm_pool_buffer_t buffer = buffer_pool->acquire(width, height, shm_format::argb8888);
+    if(buffer)
+    {
+      std::fill_n(static_cast<uint32_t*>(buffer.get_data()), width*height, pixel);
+      surface.attach(buffer.get_buffer(), 0, 0);
+      surface.damage(0, 0, width, height);
+    }
 
-    // schedule next draw
-    frame_cb = surface.frame();
-    frame_cb.on_done() = [this] (uint32_t serial) { draw(serial); };
     surface.commit();
+
+    // schedule next draw
+    frame_clock->schedule(surface);
   }
 
 public:
@@ -174,6 +170,12 @@ public:
         registry.bind(name, seat, std::min(seat_t::interface_version, version));
       else if(interface == shm_t::interface_name)
         registry.bind(name, shm, std::min(shm_t::interface_version, version));
+      else if(interface == presentation_t::interface_name)
+      {
+        registry.bind(name, presentation, std::min(presentation_t::interface_version, version));
+        // sent right after binding, long before the frame clock exists
+        presentation.on_clock_id() = [&] (uint32_t clock_id) { presentation_clock = static_cast<clockid_t>(clock_id); };
+      }
     };
     display.roundtrip();
 
@@ -186,6 +188,10 @@ public:
     // create a surface
     surface = compositor.create_surface();
 
+    // pace drawing with frame callbacks and presentation feedback
+    frame_clock.reset(new frame_clock_t(surface, presentation, presentation_clock));
+    frame_clock->add_surface(surface, [&] (const frame_tick_t& tick) { draw(tick.callback_time); });
+
     // create a shell surface
     if(xdg_wm_base)
     {
@@ -197,7 +203,7 @@ public:
       xdg_toplevel.on_close() = [&] () { running = false; };
       xdg_toplevel.on_configure() = [&] (int32_t w, int32_t h, array_t)
       {
-        create_buffers(w, h);
+        resize(w, h);
         // Don't immediately redraw, as this would slow down resizes considerably.
       };
 
@@ -216,7 +222,7 @@ public:
       shell_surface.set_toplevel();
       shell_surface.on_configure() = [&] (wayland::shell_surface_resize, int32_t w, int32_t h)
       {
-        create_buffers(w, h);
+        resize(w, h);
         // Don't immediately redraw, as this would slow down resizes considerably.
       };
     }
@@ -233,8 +239,8 @@ public:
     pointer = seat.get_pointer();
     keyboard = seat.get_keyboard();
 
-    // create shared memory
-    create_buffers(width, height);
+    // create shared memory for double buffering
+    buffer_pool.reset(new shm_buffer_pool_t(shm, 2));
 
     // load cursor theme
     cursor_theme_t cursor_theme = cursor_theme_t("default", 16, shm);
@@ -274,7 +280,7 @@ public:
     };
 
     // draw stuff
-    draw();
+    frame_clock->schedule(surface);
   }
 
   void run()
@@ -0,0 +1,312 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \example shm_bench.cpp
+ * Benchmark for the memory backing of shm buffer pools.
+ *
+ * A client draws full frames into buffers from a shm_buffer_pool_t and
+ * commits them to a minimal compositor running in a second thread, which
+ * copies every frame out of the shared memory. Both sides report their
+ * throughput and, if perf events are available, their data TLB misses.
+ *
+ * Usage: shm_bench [width] [height] [frames] [normal|thp|huge]
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <wayland-client.hpp>
+#include <wayland-server.hpp>
+#include <wayland-server-protocol.hpp>
+#include <wayland-shm-pool.hpp>
+
+// data TLB load and store misses of the calling thread
+class tlb_counter_t
+{
+private:
+  int fds[2] = { -1, -1 };
+
+  static int open_counter(uint64_t op)
+  {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_DTLB | (op << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+
+public:
+  tlb_counter_t()
+  {
+    fds[0] = open_counter(PERF_COUNT_HW_CACHE_OP_READ);
+    fds[1] = open_counter(PERF_COUNT_HW_CACHE_OP_WRITE);
+  }
+
+  tlb_counter_t(const tlb_counter_t&) = delete;
+  tlb_counter_t &operator=(const tlb_counter_t&) = delete;
+
+  ~tlb_counter_t()
+  {
+    for(int fd : fds)
+      if(fd >= 0)
+        close(fd);
+  }
+
+  bool valid() const
+  {
+    return fds[0] >= 0 || fds[1] >= 0;
+  }
+
+  void start()
+  {
+    for(int fd : fds)
+      if(fd >= 0)
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+  }
+
+  void stop()
+  {
+    for(int fd : fds)
+      if(fd >= 0)
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+  }
+
+  uint64_t misses() const
+  {
+    uint64_t sum = 0;
+    for(int fd : fds)
+    {
+      uint64_t count = 0;
+      if(fd >= 0 && read(fd, &count, sizeof(count)) == sizeof(count))
+        sum += count;
+    }
+    return sum;
+  }
+};
+
+struct stats_t
+{
+  uint64_t bytes = 0;
+  std::chrono::steady_clock::duration time{};
+  uint64_t tlb_misses = 0;
+  bool tlb_valid = false;
+};
+
+void print_stats(const std::string &side, const stats_t &stats, unsigned int frames)
+{
+  double seconds = std::chrono::duration<double>(stats.time).count();
+  std::cout << std::setw(12) << std::left << side
+            << std::setw(10) << std::right << std::fixed << std::setprecision(2)
+            << (seconds > 0 ? static_cast<double>(stats.bytes) / seconds / 1e9 : 0.0) << " GB/s";
+  if(stats.tlb_valid)
+    std::cout << std::setw(14) << stats.tlb_misses / frames << " dTLB misses/frame";
+  else
+    std::cout << "      dTLB misses: n/a";
+  std::cout << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+  int32_t width = argc > 1 ? std::stoi(argv[1]) : 3840;
+  int32_t height = argc > 2 ? std::stoi(argv[2]) : 2160;
+  unsigned int frames = argc > 3 ? static_cast<unsigned int>(std::stoul(argv[3])) : 300;
+  std::string pages_name = argc > 4 ? argv[4] : "normal";
+
+  wayland::shm_pool_options_t options;
+  if(pages_name == "thp")
+    options.pages = wayland::shm_pool_pages::transparent_huge;
+  else if(pages_name == "huge")
+    options.pages = wayland::shm_pool_pages::huge;
+  else if(pages_name != "normal")
+  {
+    std::cerr << "Unknown page kind: " << pages_name << std::endl;
+    return 1;
+  }
+  if(width <= 0 || height <= 0 || frames == 0)
+  {
+    std::cerr << "Invalid arguments." << std::endl;
+    return 1;
+  }
+
+  // Minimal compositor that copies every committed frame.
+  wayland::server::display_t server_display;
+  server_display.init_shm();
+  wayland::server::global_compositor_t global_compositor(server_display);
+  stats_t server_stats;
+  std::vector<uint8_t> composited;
+  wayland::server::buffer_t pending_buffer;
+  wayland::server::callback_t pending_callback;
+  std::unique_ptr<tlb_counter_t> server_tlb;
+
+  global_compositor.on_bind() = [&] (const wayland::server::client_t& /*client*/, wayland::server::compositor_t compositor)
+  {
+    compositor.on_create_surface() = [&] (wayland::server::surface_t surface)
+    {
+      surface.on_attach() = [&] (wayland::server::buffer_t buffer, int32_t /*x*/, int32_t /*y*/)
+      {
+        pending_buffer = buffer;
+      };
+      surface.on_frame() = [&] (wayland::server::callback_t callback)
+      {
+        pending_callback = callback;
+      };
+      surface.on_commit() = [&] ()
+      {
+        if(pending_buffer)
+        {
+          wayland::server::shm_buffer_t shm_buffer(pending_buffer);
+          auto access = shm_buffer.begin_access();
+          auto pixels = shm_buffer.get_pixels<uint8_t>();
+          std::size_t row_size = static_cast<std::size_t>(pixels.get_width()) * 4;
+          composited.resize(row_size * pixels.get_height());
+
+          auto start = std::chrono::steady_clock::now();
+          server_tlb->start();
+          for(int32_t y = 0; y < pixels.get_height(); y++)
+            std::memcpy(&composited[row_size * y], pixels.row(y), row_size);
+          server_tlb->stop();
+          server_stats.time += std::chrono::steady_clock::now() - start;
+          server_stats.bytes += composited.size();
+
+          pending_buffer.release();
+          pending_buffer = wayland::server::buffer_t();
+        }
+        if(pending_callback)
+        {
+          pending_callback.done(0);
+          pending_callback = wayland::server::callback_t();
+        }
+      };
+    };
+  };
+
+  int fds[2];
+  if(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) < 0)
+  {
+    std::cerr << "socketpair failed." << std::endl;
+    return 1;
+  }
+  wayland::server::client_t server_client(server_display, fds[0]);
+
+  // Run server event loop in a thread, so both sides get their own counters.
+  std::atomic<bool> running(true);
+  auto thread = std::thread([&] ()
+  {
+    server_tlb.reset(new tlb_counter_t);
+    auto el = server_display.get_event_loop();
+    while(running)
+    {
+      el.dispatch(1);
+      server_display.flush_clients();
+    }
+    server_stats.tlb_misses = server_tlb->misses();
+    server_stats.tlb_valid = server_tlb->valid();
+  });
+
+  stats_t client_stats;
+  {
+    wayland::display_t display(fds[1]);
+    wayland::compositor_t compositor;
+    wayland::shm_t shm;
+    auto registry = display.get_registry();
+    registry.on_global() = [&] (uint32_t name, const std::string& interface, uint32_t /*version*/)
+    {
+      if(interface == wayland::compositor_t::interface_name)
+        registry.bind(name, compositor, 1);
+      else if(interface == wayland::shm_t::interface_name)
+        registry.bind(name, shm, 1);
+    };
+    display.roundtrip();
+
+    wayland::surface_t surface = compositor.create_surface();
+    wayland::shm_buffer_pool_t pool(shm, 2, 0, options);
+    tlb_counter_t client_tlb;
+
+    for(unsigned int frame = 0; frame < frames; frame++)
+    {
+      wayland::shm_pool_buffer_t buffer = pool.acquire(width, height);
+      while(!buffer)
+      {
+        display.dispatch();
+        buffer = pool.acquire(width, height);
+      }
+
+      // write a full frame
+      auto *pixels = static_cast<uint32_t*>(buffer.get_data());
+      std::size_t count = buffer.get_size() / 4;
+      uint32_t color = 0xff000000 | (frame * 0x010203);
+      auto start = std::chrono::steady_clock::now();
+      client_tlb.start();
+      for(std::size_t i = 0; i < count; i++)
+        pixels[i] = color;
+      client_tlb.stop();
+      client_stats.time += std::chrono::steady_clock::now() - start;
+      client_stats.bytes += buffer.get_size();
+
+      bool frame_done = false;
+      wayland::callback_t callback = surface.frame();
+      callback.on_done() = [&] (uint32_t /*time*/) { frame_done = true; };
+      surface.attach(buffer.get_buffer(), 0, 0);
+      surface.damage(0, 0, width, height);
+      surface.commit();
+      while(!frame_done)
+        display.dispatch();
+    }
+
+    client_stats.tlb_misses = client_tlb.misses();
+    client_stats.tlb_valid = client_tlb.valid();
+
+    const char *pages[] = { "normal", "transparent huge", "huge" };
+    std::cout << width << "x" << height << ", " << frames << " frames, "
+              << pages[static_cast<int>(pool.get_pages())] << " pages ("
+              << pool.get_page_size() / 1024 << " KiB), "
+              << (pool.is_sealed() ? "sealed" : "not sealed") << std::endl;
+  }
+
+  running = false;
+  thread.join();
+
+  print_stats("client draw", client_stats, frames);
+  print_stats("server copy", server_stats, frames);
+  return 0;
+}
@@ -46,7 +46,7 @@ shared_mem_t::shared_mem_t(size_t size)
   name = ss.str();
 
   // open shared memory file
-  fd = memfd_create(name.c_str(), 0);
+  fd = memfd_create(name.c_str(), MFD_CLOEXEC | MFD_ALLOW_SEALING);
   if(fd < 0)
     throw std::runtime_error("shm_open failed.");
 
@@ -54,6 +54,10 @@ shared_mem_t::shared_mem_t(size_t size)
   if(ftruncate(fd, size) < 0)
     throw std::runtime_error("ftruncate failed.");
 
+  // The size never changes. With the seals, the compositor knows that
+  // accessing the memory cannot cause SIGBUS.
+  fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL);
+
   // map memory
   mem = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
   if(mem == MAP_FAILED) // NOLINT
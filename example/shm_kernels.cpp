@@ -0,0 +1,260 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** \example shm_kernels.cpp
+ * Self check and benchmark for the pixel kernels of wayland-shm++.
+ *
+ * Every operation is run with each instruction set the CPU supports. A
+ * table of pixels with known results, computed by hand, checks the scalar
+ * and the SIMD paths for each format family. Then the results on random
+ * pixel data are compared byte by byte against the scalar implementation,
+ * and the throughput of every kernel is reported.
+ *
+ * Usage: shm_kernels [width] [height] [iterations]
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <wayland-client-protocol.hpp>
+#include <wayland-shm.hpp>
+
+using namespace wayland;
+
+namespace
+{
+  struct isa_name_t
+  {
+    shm_isa isa;
+    const char *name;
+  };
+
+  const isa_name_t isas[] =
+  {
+    { shm_isa::scalar, "scalar" },
+    { shm_isa::sse2, "sse2" },
+    { shm_isa::avx2, "avx2" },
+    { shm_isa::neon, "neon" }
+  };
+
+  uint32_t fmt(shm_format format)
+  {
+    return static_cast<uint32_t>(format);
+  }
+
+  struct image_buffer_t
+  {
+    std::vector<uint8_t> data;
+    shm_image_t image;
+
+    image_buffer_t(int32_t width, int32_t height, uint32_t format, unsigned int bytes)
+      : data(static_cast<std::size_t>(width) * height * bytes)
+    {
+      image = shm_image_t{ data.data(), width, height, static_cast<int32_t>(width * bytes), format };
+    }
+  };
+
+  struct operation_t
+  {
+    std::string name;
+    uint32_t src_format;
+    unsigned int src_bytes;
+    uint32_t dst_format;
+    unsigned int dst_bytes;
+    // works on the destination, which is initialized with the source if both formats are equal
+    std::function<void(const shm_image_t&, const shm_image_t&)> run;
+  };
+
+  // one pixel with its expected result, as little endian words
+  struct known_answer_t
+  {
+    std::string name;
+    uint32_t src_format;
+    unsigned int src_bytes;
+    uint64_t src;
+    uint32_t dst_format;
+    unsigned int dst_bytes;
+    uint64_t expected;
+    std::function<void(const shm_image_t&, const shm_image_t&)> run;
+  };
+
+  // Runs every known answer on a row that is long enough for the SIMD
+  // kernels and has a remainder for their scalar tails.
+  bool check_known_answers(const std::vector<known_answer_t> &answers, const char *isa)
+  {
+    const int32_t width = 37;
+    bool ok = true;
+    for(const auto &answer : answers)
+    {
+      image_buffer_t src(width, 1, answer.src_format, answer.src_bytes);
+      image_buffer_t dst(width, 1, answer.dst_format, answer.dst_bytes);
+      for(int32_t x = 0; x < width; x++)
+        std::memcpy(&src.data[x * answer.src_bytes], &answer.src, answer.src_bytes);
+      if(answer.src_format == answer.dst_format && answer.src_bytes == answer.dst_bytes)
+        dst.data = src.data;
+      answer.run(dst.image, src.image);
+      for(int32_t x = 0; x < width; x++)
+      {
+        uint64_t result = 0;
+        std::memcpy(&result, &dst.data[x * answer.dst_bytes], answer.dst_bytes);
+        if(result != answer.expected)
+        {
+          std::cout << std::setw(26) << std::left << answer.name << std::setw(8) << isa
+                    << "  pixel " << x << ": 0x" << std::hex << result
+                    << " instead of 0x" << answer.expected << std::dec << std::endl;
+          ok = false;
+          break;
+        }
+      }
+    }
+    return ok;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  int32_t width = argc > 1 ? std::stoi(argv[1]) : 1920;
+  int32_t height = argc > 2 ? std::stoi(argv[2]) : 1080;
+  int iterations = argc > 3 ? std::stoi(argv[3]) : 50;
+
+  auto blit = [] (const shm_image_t &dst, const shm_image_t &src) { shm_convert(dst, src); };
+  auto premultiply = [] (const shm_image_t &dst, const shm_image_t&) { shm_premultiply(dst); };
+  auto unpremultiply = [] (const shm_image_t &dst, const shm_image_t&) { shm_unpremultiply(dst); };
+  auto fill = [] (const shm_image_t &dst, const shm_image_t&) { shm_fill_rect(dst, 1, 1, dst.width - 2, dst.height - 2, 0x80402010); };
+
+  std::vector<operation_t> operations =
+  {
+    { "fill argb8888", fmt(shm_format::argb8888), 4, fmt(shm_format::argb8888), 4, fill },
+    { "premultiply argb8888", fmt(shm_format::argb8888), 4, fmt(shm_format::argb8888), 4, premultiply },
+    { "unpremultiply argb8888", fmt(shm_format::argb8888), 4, fmt(shm_format::argb8888), 4, unpremultiply },
+    { "premultiply rgba8888", fmt(shm_format::rgba8888), 4, fmt(shm_format::rgba8888), 4, premultiply },
+    { "argb8888 -> abgr8888", fmt(shm_format::argb8888), 4, fmt(shm_format::abgr8888), 4, blit },
+    { "xrgb8888 -> rgba8888", fmt(shm_format::xrgb8888), 4, fmt(shm_format::rgba8888), 4, blit },
+    { "rgb565 -> argb8888", fmt(shm_format::rgb565), 2, fmt(shm_format::argb8888), 4, blit },
+    { "bgr565 -> xbgr8888", fmt(shm_format::bgr565), 2, fmt(shm_format::xbgr8888), 4, blit },
+    { "argb8888 -> rgb565", fmt(shm_format::argb8888), 4, fmt(shm_format::rgb565), 2, blit },
+    { "argb8888 -> xrgb2101010", fmt(shm_format::argb8888), 4, fmt(shm_format::xrgb2101010), 4, blit },
+    { "argb8888 -> argb8888", fmt(shm_format::argb8888), 4, fmt(shm_format::argb8888), 4, blit }
+  };
+
+  uint32_t argb8888 = fmt(shm_format::argb8888);
+  uint32_t rgba8888 = fmt(shm_format::rgba8888);
+  std::vector<known_answer_t> answers =
+  {
+    // 8888 swizzles
+    { "argb8888 -> abgr8888", argb8888, 4, 0x80402010, fmt(shm_format::abgr8888), 4, 0x80102040, blit },
+    { "argb8888 -> bgra8888", argb8888, 4, 0x80402010, fmt(shm_format::bgra8888), 4, 0x10204080, blit },
+    { "xrgb8888 -> rgba8888", fmt(shm_format::xrgb8888), 4, 0x12345678, rgba8888, 4, 0x345678ff, blit },
+    { "abgr8888 -> xrgb8888", fmt(shm_format::abgr8888), 4, 0x80102040, fmt(shm_format::xrgb8888), 4, 0xff402010, blit },
+    // 565, expanded by bit replication and reduced with rounding
+    { "rgb565 -> argb8888", fmt(shm_format::rgb565), 2, 0xf800, argb8888, 4, 0xffff0000, blit },
+    { "rgb565 -> argb8888", fmt(shm_format::rgb565), 2, 0x8410, argb8888, 4, 0xff848284, blit },
+    { "bgr565 -> xbgr8888", fmt(shm_format::bgr565), 2, 0x07ff, fmt(shm_format::xbgr8888), 4, 0xff00ffff, blit },
+    { "argb8888 -> rgb565", argb8888, 4, 0xff848284, fmt(shm_format::rgb565), 2, 0x8410, blit },
+    { "argb8888 -> rgb565", argb8888, 4, 0x80ff7f00, fmt(shm_format::rgb565), 2, 0xfbe0, blit },
+    // 2101010
+    { "argb8888 -> xrgb2101010", argb8888, 4, 0x80ff8000, fmt(shm_format::xrgb2101010), 4, 0xfff80800, blit },
+    { "argb2101010 -> argb8888", fmt(shm_format::argb2101010), 4, 0xbff80000, argb8888, 4, 0xaaff8000, blit },
+    { "xrgb2101010 -> xbgr2101010", fmt(shm_format::xrgb2101010), 4, 0x00100803, fmt(shm_format::xbgr2101010), 4, 0xc0300801, blit },
+    // 16161616
+    { "argb8888 -> argb16161616", argb8888, 4, 0x80402010, fmt(shm_format::argb16161616), 8, 0x8080404020201010, blit },
+    { "argb8888 -> abgr16161616", argb8888, 4, 0x80402010, fmt(shm_format::abgr16161616), 8, 0x8080101020204040, blit },
+    { "argb8888 -> xrgb16161616", argb8888, 4, 0x80402010, fmt(shm_format::xrgb16161616), 8, 0xffff404020201010, blit },
+    { "argb16161616 -> argb8888", fmt(shm_format::argb16161616), 8, 0x80004000ffff0000, argb8888, 4, 0x8040ff00, blit },
+    // premultiplication at the edges of alpha
+    { "premultiply argb8888", argb8888, 4, 0x00ff8040, argb8888, 4, 0x00000000, premultiply },
+    { "premultiply argb8888", argb8888, 4, 0x01ff8040, argb8888, 4, 0x01010100, premultiply },
+    { "premultiply argb8888", argb8888, 4, 0x80ff8040, argb8888, 4, 0x80804020, premultiply },
+    { "premultiply argb8888", argb8888, 4, 0xffff8040, argb8888, 4, 0xffff8040, premultiply },
+    { "premultiply rgba8888", rgba8888, 4, 0xff804001, rgba8888, 4, 0x01010001, premultiply },
+    { "unpremultiply argb8888", argb8888, 4, 0x00ff8040, argb8888, 4, 0x00000000, unpremultiply },
+    { "unpremultiply argb8888", argb8888, 4, 0x01010100, argb8888, 4, 0x01ffff00, unpremultiply },
+    { "unpremultiply argb8888", argb8888, 4, 0x01ff0000, argb8888, 4, 0x01ff0000, unpremultiply },
+    { "unpremultiply argb8888", argb8888, 4, 0x80402010, argb8888, 4, 0x80804020, unpremultiply },
+    { "unpremultiply argb8888", argb8888, 4, 0xff804020, argb8888, 4, 0xff804020, unpremultiply },
+    { "unpremultiply rgba8888", rgba8888, 4, 0x01010001, rgba8888, 4, 0xffff0001, unpremultiply }
+  };
+
+  std::mt19937 rng(42);
+  bool ok = true;
+  for(const auto &isa : isas)
+    if(shm_set_isa(isa.isa))
+    {
+      bool passed = check_known_answers(answers, isa.name);
+      std::cout << "Known answers with " << isa.name << (passed ? ": ok" : ": FAILED") << std::endl;
+      ok = ok && passed;
+    }
+
+  std::cout << "Kernels: " << width << "x" << height << ", " << iterations << " iterations" << std::endl;
+  for(const auto &op : operations)
+  {
+    image_buffer_t src(width, height, op.src_format, op.src_bytes);
+    for(auto &byte : src.data)
+      byte = static_cast<uint8_t>(rng());
+    bool in_place = op.src_format == op.dst_format && op.src_bytes == op.dst_bytes;
+
+    std::vector<uint8_t> reference;
+    for(const auto &isa : isas)
+    {
+      if(!shm_set_isa(isa.isa))
+        continue;
+
+      // correctness against the scalar kernels
+      image_buffer_t dst(width, height, op.dst_format, op.dst_bytes);
+      if(in_place)
+        dst.data = src.data;
+      op.run(dst.image, src.image);
+      if(isa.isa == shm_isa::scalar)
+        reference = dst.data;
+      bool same = dst.data == reference;
+      ok = ok && same;
+
+      // throughput
+      std::chrono::steady_clock::duration time{};
+      for(int i = 0; i < iterations; i++)
+      {
+        if(in_place)
+          dst.data = src.data;
+        auto start = std::chrono::steady_clock::now();
+        op.run(dst.image, src.image);
+        time += std::chrono::steady_clock::now() - start;
+      }
+      double seconds = std::chrono::duration<double>(time).count();
+      double mpixels = static_cast<double>(width) * height * iterations / seconds / 1e6;
+      std::cout << std::setw(26) << std::left << op.name << std::setw(8) << isa.name
+                << std::setw(10) << std::right << std::fixed << std::setprecision(1) << mpixels << " Mpx/s"
+                << (same ? "" : "  MISMATCH") << std::endl;
+    }
+  }
+
+  return ok ? 0 : 1;
+}
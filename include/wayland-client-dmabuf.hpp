@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WAYLAND_CLIENT_DMABUF_HPP
+#define WAYLAND_CLIENT_DMABUF_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <wayland-util.hpp>
+
+namespace wayland
+{
+  /** \brief Entry of a linux-dmabuf format table
+   *
+   * The layout matches the table received with
+   * zwp_linux_dmabuf_feedback_v1_t::on_format_table().
+   */
+  struct dmabuf_format_t
+  {
+    uint32_t format;
+    uint32_t padding;
+    uint64_t modifier;
+  };
+
+  class dmabuf_format_table_t;
+
+  /** \brief Formats of a dmabuf feedback tranche
+   *
+   * Resolves the indices of a tranche_formats event into the format
+   * table, without copying either of them. The view is only valid as long
+   * as the index array and the table are alive.
+   */
+  class dmabuf_tranche_formats_t
+  {
+  private:
+    const dmabuf_format_t *table = nullptr;
+    std::size_t table_size = 0;
+    const uint16_t *indices = nullptr;
+    std::size_t count = 0;
+
+    dmabuf_tranche_formats_t(const dmabuf_format_t *table, std::size_t table_size,
+                             const uint16_t *indices, std::size_t count);
+    friend class dmabuf_format_table_t;
+
+  public:
+    class iterator
+    {
+    private:
+      const dmabuf_format_t *table = nullptr;
+      const uint16_t *index = nullptr;
+
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = dmabuf_format_t;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const dmabuf_format_t*;
+      using reference = const dmabuf_format_t&;
+
+      iterator() = default;
+      iterator(const dmabuf_format_t *table, const uint16_t *index)
+        : table(table), index(index)
+      {
+      }
+
+      reference operator*() const
+      {
+        return table[*index];
+      }
+
+      pointer operator->() const
+      {
+        return &table[*index];
+      }
+
+      iterator &operator++()
+      {
+        ++index;
+        return *this;
+      }
+
+      iterator operator++(int)
+      {
+        iterator tmp = *this;
+        ++index;
+        return tmp;
+      }
+
+      bool operator==(const iterator &i) const
+      {
+        return index == i.index;
+      }
+
+      bool operator!=(const iterator &i) const
+      {
+        return index != i.index;
+      }
+    };
+
+    dmabuf_tranche_formats_t() = default;
+
+    iterator begin() const;
+    iterator end() const;
+    std::size_t size() const;
+    bool empty() const;
+
+    /** \brief Format at position \a n of the tranche
+     *
+     * \exception std::out_of_range if \a n or the stored index is out of range
+     */
+    const dmabuf_format_t &at(std::size_t n) const;
+
+    /** \brief Format at position \a n of the tranche, without range checks */
+    const dmabuf_format_t &operator[](std::size_t n) const;
+  };
+
+  /** \brief Read-only mapping of a linux-dmabuf v4 format table
+   *
+   * A compositor usually sends the same table to every feedback object.
+   * load() maps each table only once and hands out shared references to
+   * the mapping, identified by the device and inode of the file. The
+   * mapping is released when the last reference is gone.
+   *
+   * \code
+   * dmabuf_format_table_t table;
+   * feedback.on_format_table() = [&] (int fd, uint32_t size)
+   *   {
+   *     table = dmabuf_format_table_t::load(fd, size);
+   *   };
+   * feedback.on_tranche_formats() = [&] (array_t indices)
+   *   {
+   *     for(const dmabuf_format_t &f : table.resolve(indices))
+   *       add_format(f.format, f.modifier);
+   *   };
+   * \endcode
+   *
+   * Copies of this object share the same mapping. This class is thread safe.
+   */
+  class dmabuf_format_table_t
+  {
+  private:
+    struct mapping_t;
+    std::shared_ptr<const mapping_t> mapping;
+
+  public:
+    dmabuf_format_table_t() = default;
+
+    /** \brief Map a format table
+     *
+     * \param fd File descriptor from the format_table event. It is closed
+     *           by this function in any case.
+     * \param size Size of the table from the format_table event
+     * \exception std::system_error if the file cannot be mapped
+     * \exception std::invalid_argument if the size is invalid
+     */
+    static dmabuf_format_table_t load(int fd, uint32_t size);
+
+    /** \brief Check whether a table was loaded */
+    operator bool() const;
+
+    /** \brief Resolve the index array of a tranche_formats event
+     *
+     * \exception std::invalid_argument if the array size is invalid
+     * \exception std::out_of_range if an index is outside the table
+     */
+    dmabuf_tranche_formats_t resolve(const array_t &indices) const;
+
+    /** \brief Pointer to the first entry of the table */
+    const dmabuf_format_t *data() const;
+
+    /** \brief Number of entries in the table */
+    std::size_t size() const;
+
+    const dmabuf_format_t &operator[](std::size_t n) const;
+  };
+}
+
+#endif
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WAYLAND_CLIENT_REGION_HPP
+#define WAYLAND_CLIENT_REGION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <wayland-client-protocol.hpp>
+#include <wayland-region.hpp>
+
+namespace wayland
+{
+  /** \brief Cache of wl_region objects
+   *
+   * Opaque and input regions are usually the same from frame to frame, or
+   * alternate between a few shapes, e.g. while a window is maximized. The
+   * cache keeps the wl_region objects of the most recently used rectangle
+   * sets and only creates a new one when a set was not seen recently. The
+   * compositor copies a region when it is set on a surface, so one
+   * wl_region can be used for any number of surfaces and commits.
+   */
+  class region_cache_t
+  {
+  private:
+    struct entry_t
+    {
+      std::size_t hash;
+      rect_set_t rects;
+      region_t region;
+      uint64_t last_use;
+    };
+
+    compositor_t compositor;
+    std::size_t capacity;
+    std::vector<entry_t> entries;
+    uint64_t use_counter = 0;
+
+  public:
+    /** \brief Create a region cache
+     *
+     * \param compositor Compositor used to create the regions
+     * \param capacity Maximum number of cached regions
+     */
+    region_cache_t(compositor_t compositor, std::size_t capacity = 8);
+
+    /** \brief Get a wl_region covering a rectangle set
+     *
+     * The least recently used region is destroyed when the cache is full.
+     */
+    region_t get(const rect_set_t &rects);
+
+    /** \brief Set the opaque region of a surface
+     *
+     * An empty set unsets the opaque region.
+     */
+    void set_opaque_region(surface_t &surface, const rect_set_t &rects);
+
+    /** \brief Set the input region of a surface
+     *
+     * Note that an empty set results in an empty input region, not in the
+     * infinite default region.
+     */
+    void set_input_region(surface_t &surface, const rect_set_t &rects);
+
+    /** \brief Destroy all cached regions */
+    void clear();
+
+    /** \brief Number of cached regions */
+    std::size_t size() const;
+  };
+
+  /** \brief Damage accumulator for a surface
+   *
+   * Collects the damage of a frame and sends it as a bounded number of
+   * merged damage_buffer requests before the commit. Overlapping and
+   * touching rectangles are merged, and if more than \a max_rects
+   * rectangles remain, they are reduced to a covering set, see
+   * rect_set_t::simplify().
+   *
+   * Damage is given in buffer coordinates. If the surface does not support
+   * wl_surface.damage_buffer (version < 4), it is converted to surface
+   * coordinates using the buffer scale.
+   */
+  class damage_accumulator_t
+  {
+  private:
+    surface_t surface;
+    std::size_t max_rects;
+    std::vector<rect_t> pending;
+    rect_set_t damage;
+    rect_t bounds{ 0, 0, 0, 0 };
+    int32_t scale = 1;
+
+    void merge();
+
+  public:
+    /** \brief Create a damage accumulator
+     *
+     * \param surface Surface to damage
+     * \param max_rects Maximum number of damage requests per commit
+     */
+    damage_accumulator_t(surface_t surface, std::size_t max_rects = 4);
+
+    void add(const rect_t &rect);
+    void add(int32_t x, int32_t y, int32_t width, int32_t height);
+    void add(const rect_set_t &rects);
+
+    /** \brief Damage the whole buffer */
+    void add_all();
+
+    /** \brief Set the size of the buffer
+     *
+     * Damage is clipped to the buffer. Before the size is set, damage is
+     * not clipped, and add_all() damages everything.
+     */
+    void set_buffer_size(int32_t width, int32_t height);
+
+    /** \brief Set the buffer scale used for surfaces without damage_buffer */
+    void set_buffer_scale(int32_t scale);
+
+    /** \brief Damage collected since the last flush, in buffer coordinates */
+    const rect_set_t &get_damage();
+
+    bool empty() const;
+
+    /** \brief Discard the collected damage */
+    void clear();
+
+    /** \brief Send the collected damage
+     *
+     * \return The number of damage requests sent
+     */
+    std::size_t flush();
+
+    /** \brief Send the collected damage and commit the surface */
+    void commit();
+  };
+}
+
+#endif
@@ -79,6 +79,7 @@ namespace wayland
   namespace detail
   {
     struct proxy_data_t;
+    struct proxy_group_data_t;
     // base class for event listener storage.
     struct events_base_t
     {
@@ -163,6 +164,8 @@ namespace wayland
                             uint32_t opcode, const wl_message *message,
                             wl_argument *args);
 
+    bool has_events() const;
+
     // marshal request
     proxy_t marshal_single(uint32_t opcode, const wl_interface *interface,
                            const std::vector<detail::argument_t>& args, std::uint32_t version = 0);
@@ -218,6 +221,15 @@ namespace wayland
     // Retrieve the previously set user data
     std::shared_ptr<detail::events_base_t> get_events();
 
+    // Allocate the event handler storage from the memory resource of the
+    // connection and set the dispatcher, unless this was already done.
+    template <typename events_type>
+    void init_events(int(*dispatcher)(uint32_t, const std::vector<detail::any>&, const std::shared_ptr<detail::events_base_t>&))
+    {
+      if(!has_events())
+        set_events(std::allocate_shared<events_type>(detail::allocator_t<events_type>(get_memory_resource())), dispatcher);
+    }
+
     // Constructs NULL proxies.
     proxy_t() = default;
 
@@ -225,6 +237,9 @@ namespace wayland
     // Construct from proxy as wrapper
     proxy_t(const proxy_t &wrapped_proxy, construct_proxy_wrapper_tag /*unused*/);
 
+    // Construct with a memory resource for the proxy data
+    proxy_t(wl_proxy *p, wrapper_type t, event_queue_t const& queue, memory_resource_t *resource);
+
   public:
     /** \brief Cronstruct a proxy_t from a wl_proxy pointer
         \param p Pointer to a wl_proxy
@@ -304,6 +319,13 @@ namespace wayland
       return type;
     }
 
+    /** \brief Get the memory resource of a proxy object.
+        \return The memory resource the bookkeeping data of this proxy is
+        allocated from. Proxies inherit it from the proxy that created
+        them, and ultimately from the display_t.
+    */
+    memory_resource_t *get_memory_resource() const;
+
     /** \brief Assign a proxy to an event queue.
         \param queue The event queue that will handle this proxy
 
@@ -491,6 +513,17 @@ namespace wayland
     */
     display_t(int fd);
 
+    /** \brief Connect to Wayland display on an already open fd.
+        \param fd The fd to use for the connection
+        \param resource Memory resource for the bookkeeping data of all
+        proxies of this connection
+
+        Like display_t(int), but all proxy data and event handler storage of
+        this connection is allocated from \a resource, which must outlive the
+        display and all its proxies.
+    */
+    display_t(int fd, memory_resource_t *resource);
+
     display_t(display_t &&d) noexcept;
     display_t(const display_t &d) = delete;
     display_t &operator=(const display_t &d) = delete;
@@ -506,6 +539,18 @@ namespace wayland
     */
     display_t(const std::string& name = {});
 
+    /**  \brief Connect to a Wayland display.
+         \param name Name of the Wayland display to connect to, see
+         display_t(const std::string&)
+         \param resource Memory resource for the bookkeeping data of all
+         proxies of this connection
+
+         All proxy data and event handler storage of this connection is
+         allocated from \a resource, which must outlive the display and all
+         its proxies.
+    */
+    display_t(const std::string& name, memory_resource_t *resource);
+
     /** \brief Use an existing connection to a Wayland display to
         construct a waylandpp display_t
         \param display C wl_display pointer to use; must not be nullptr
@@ -545,6 +590,15 @@ namespace wayland
     */
     event_queue_t create_queue() const;
 
+    /** \brief Get the allocation statistics of this connection.
+        \return The statistics of the memory resource of this display
+
+        If no memory resource was given on construction, the process-wide
+        new_delete_resource() is used and the statistics cover all
+        connections using it.
+    */
+    memory_stats_t get_memory_stats() const;
+
     /** \brief Get a display context's file descriptor.
         \return Display object file descriptor
 
@@ -764,6 +818,99 @@ namespace wayland
      */
     display_t proxy_create_wrapper();
   };
+
+  /** \brief Lifetime group for batch destruction of proxies
+
+      Proxies created while a proxy_group_t::scope_t is active in the
+      current thread are attached to the group. Their bookkeeping data and
+      event handler storage are allocated from one arena owned by the
+      group, instead of one heap allocation each.
+
+      destroy() destroys all attached proxies that still exist at once, in
+      reverse order of creation, so that objects are destroyed before the
+      objects they were created from (e.g. xdg_toplevel before xdg_surface
+      before wl_surface). All destroy requests are sent with a single
+      flush. Copies of a destroyed proxy_t stay valid C++ objects, but no
+      longer have an object (proxy_has_object() returns false).
+
+      \code
+      proxy_group_t group(display);
+      {
+        proxy_group_t::scope_t scope(group);
+        surface = compositor.create_surface();
+        subsurface = subcompositor.get_subsurface(surface, parent);
+        // ...
+      }
+      // on window close:
+      group.destroy();
+      \endcode
+
+      Proxies created in event handlers (new_id arguments of events) are
+      not attached. The arena is freed when the group and the last proxy
+      allocated from it are gone.
+
+      The arena does not reuse freed memory. Therefore only attached
+      proxies are allocated from it: proxies created from an attached
+      proxy outside of a scope, e.g. the frame callbacks of a grouped
+      wl_surface, are allocated from the memory resource of the display
+      and are not destroyed by the group.
+  */
+  class proxy_group_t
+  {
+  private:
+    detail::proxy_group_data_t *data = nullptr;
+
+  public:
+    /** \brief Attach new proxies to a group
+
+        While a scope_t exists, all proxies that are created by requests in
+        the current thread are attached to the group. Scopes can be nested,
+        the innermost one is used.
+    */
+    class scope_t
+    {
+    private:
+      detail::proxy_group_data_t *previous = nullptr;
+
+    public:
+      explicit scope_t(proxy_group_t &group);
+      scope_t(const scope_t&) = delete;
+      scope_t &operator=(const scope_t&) = delete;
+      ~scope_t();
+    };
+
+    /** \brief Create a lifetime group
+        \param display The display the proxies belong to
+        \param chunk_size Size of the arena chunks, which are allocated
+        from the memory resource of the display
+    */
+    explicit proxy_group_t(display_t &display, std::size_t chunk_size = 4096);
+    proxy_group_t(const proxy_group_t&) = delete;
+    proxy_group_t &operator=(const proxy_group_t&) = delete;
+    proxy_group_t(proxy_group_t &&g) noexcept;
+    proxy_group_t &operator=(proxy_group_t &&g) noexcept;
+
+    /** \brief Destroy the group and all proxies still attached to it
+     */
+    ~proxy_group_t();
+
+    /** \brief Destroy all attached proxies
+        \exception std::system_error if flushing the display fails
+
+        The destroy requests of all proxies are marshalled in reverse order
+        of creation, the wl_proxy objects are destroyed, and the display is
+        flushed once.
+    */
+    void destroy();
+
+    /** \brief Number of attached proxies that were not destroyed yet
+     */
+    std::size_t size() const;
+
+    /** \brief Get the allocation statistics of the arena
+     */
+    memory_stats_t get_memory_stats() const;
+  };
 }
 
 #include <wayland-client-protocol.hpp>
@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WAYLAND_COLOR_CACHE_HPP
+#define WAYLAND_COLOR_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <wayland-client-protocol-staging.hpp>
+
+namespace wayland
+{
+  namespace detail
+  {
+    struct image_description_cache_data_t;
+  }
+
+  /** \brief Parametric image description
+   *
+   * Mirrors the requests of image_description_creator_params_v1_t. Only
+   * the fields whose bit is set in valid are sent and compared. The
+   * protocol rules for combining them apply, e.g. a named and a power
+   * transfer function may not both be set.
+   */
+  struct image_description_params_t
+  {
+    enum : uint32_t
+    {
+      has_tf_named = 1u << 0,
+      has_tf_power = 1u << 1,
+      has_primaries_named = 1u << 2,
+      has_primaries = 1u << 3,
+      has_luminances = 1u << 4,
+      has_mastering_primaries = 1u << 5,
+      has_mastering_luminance = 1u << 6,
+      has_max_cll = 1u << 7,
+      has_max_fall = 1u << 8
+    };
+    uint32_t valid;
+
+    color_manager_v1_transfer_function tf_named;
+    uint32_t tf_power;
+    color_manager_v1_primaries primaries_named;
+    /** Red, green, blue and white point chromaticities, times 1000000 */
+    int32_t primaries[8];
+    uint32_t min_lum;
+    uint32_t max_lum;
+    uint32_t reference_lum;
+    int32_t mastering_primaries[8];
+    uint32_t mastering_min_lum;
+    uint32_t mastering_max_lum;
+    uint32_t max_cll;
+    uint32_t max_fall;
+
+    /** \brief Compare the fields set in valid */
+    bool operator==(const image_description_params_t &other) const;
+    bool operator!=(const image_description_params_t &other) const;
+  };
+
+  /** \brief State of a cached image description */
+  enum class image_description_status
+  {
+    /** not in the cache */
+    none,
+    /** created, waiting for ready or failed */
+    pending,
+    ready,
+    failed
+  };
+
+  /** \brief Cache of image descriptions of a color manager
+   *
+   * Image descriptions can only be used after the compositor sent ready,
+   * which takes a round trip per object. The cache shares one description
+   * per parametric description or ICC profile content, so identical
+   * descriptions of several surfaces or streams are only created once.
+   * Descriptions can be created ahead of their first use with prefetch().
+   *
+   * get() never blocks. If the description is not ready yet, it returns a
+   * null proxy and on_ready() is called once it is. Failed descriptions
+   * are kept as failed, so they are not requested again until they leave
+   * the cache.
+   *
+   * The cache holds up to the given number of descriptions and drops the
+   * least recently used one beyond that. Dropping only releases the
+   * reference of the cache, so descriptions still set on surfaces stay
+   * valid.
+   */
+  class image_description_cache_t
+  {
+  private:
+    std::unique_ptr<detail::image_description_cache_data_t> data;
+
+  public:
+    /** \brief Create a cache
+     *
+     * \param manager color_manager_v1 global
+     * \param capacity Maximum number of cached descriptions
+     */
+    image_description_cache_t(color_manager_v1_t manager, std::size_t capacity = 16);
+    ~image_description_cache_t();
+    image_description_cache_t(const image_description_cache_t&) = delete;
+    image_description_cache_t(image_description_cache_t&&) noexcept;
+    image_description_cache_t &operator=(const image_description_cache_t&) = delete;
+    image_description_cache_t &operator=(image_description_cache_t&&) noexcept;
+
+    /** \brief Ready description for parameters
+     *
+     * Creates the description if it is not cached.
+     *
+     * \return The description, or a null proxy if it is pending or failed
+     */
+    image_description_v1_t get(const image_description_params_t &params);
+
+    /** \brief Ready description for an ICC profile
+     *
+     * The profile is read from the file to look it up. The file descriptor
+     * is not closed.
+     *
+     * \param fd File containing the ICC profile
+     * \param offset Offset of the profile in the file
+     * \param length Length of the profile in bytes
+     * \return The description, or a null proxy if it is pending or failed
+     */
+    image_description_v1_t get_icc(int fd, uint32_t offset, uint32_t length);
+
+    /** \brief Create a description ahead of its first use */
+    void prefetch(const image_description_params_t &params);
+
+    /** \brief Create a description for an ICC profile ahead of its first use */
+    void prefetch_icc(int fd, uint32_t offset, uint32_t length);
+
+    /** \brief State of the description for parameters */
+    image_description_status get_status(const image_description_params_t &params) const;
+
+    /** \brief Number of cached descriptions */
+    std::size_t size() const;
+
+    /** \brief Drop all cached descriptions */
+    void clear();
+
+    /** \brief A pending description became ready */
+    std::function<void()> &on_ready();
+
+    /** \brief A pending description failed */
+    std::function<void(image_description_v1_cause, std::string)> &on_failed();
+  };
+}
+
+#endif
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WAYLAND_CURSOR_MANAGER_HPP
+#define WAYLAND_CURSOR_MANAGER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <wayland-client-protocol.hpp>
+#include <wayland-client-protocol-staging.hpp>
+#include <wayland-cursor.hpp>
+
+namespace wayland
+{
+  namespace detail
+  {
+    struct cursor_manager_data_t;
+  }
+
+  /** \brief Process wide cache of cursor themes
+   *
+   * Every theme is loaded only once per wl_shm global, name, size and
+   * loader, no matter how many windows or seats use it. The cache does not own the
+   * themes: a theme is unloaded as soon as the last cursor_theme_t,
+   * cursor_t or cursor_image_t referring to it is gone.
+   */
+  class cursor_theme_cache_t
+  {
+  public:
+    /** \brief Get a cursor theme, loading it on first use
+     *
+     * \param name Name of the theme, or an empty string for the default theme
+     * \param size Nominal size of the cursors in buffer pixels
+     * \param shm wl_shm global of the display the theme is used with
+     * \param native Whether to use the native Xcursor loader, see
+     *        cursor_theme_t
+     * \exception std::runtime_error if the theme cannot be loaded
+     */
+    static cursor_theme_t get(const std::string &name, int size, const shm_t &shm, bool native = false);
+  };
+
+  /** \brief Cursor of a pointer
+   *
+   * Shows named cursors on a wl_pointer. If the compositor supports
+   * wp_cursor_shape_v1, cursors with a CSS name, e.g. "default", "text"
+   * or "ew-resize", are shown by the compositor and no theme is loaded at
+   * all. Otherwise the images are taken from a theme of the
+   * cursor_theme_cache_t, which is loaded natively when the first image is
+   * needed. The theme is never handed out, so its missing
+   * libwayland-cursor objects do not matter.
+   * The theme size follows the buffer scale given by set_scale(), so
+   * windows with the same scale share one theme.
+   *
+   * Animated cursors are advanced by a timer whose file descriptor must be
+   * polled together with the display, see get_fd() and dispatch().
+   *
+   * \code
+   * cursor_manager_t cursor(pointer, compositor, shm, cursor_shape_manager);
+   * pointer.on_enter() = [&] (uint32_t serial, surface_t, double, double)
+   * {
+   *   cursor.enter(serial);
+   * };
+   * pointer.on_leave() = [&] (uint32_t, surface_t)
+   * {
+   *   cursor.leave();
+   * };
+   * cursor.set_cursor("text");
+   * \endcode
+   */
+  class cursor_manager_t
+  {
+  private:
+    std::unique_ptr<detail::cursor_manager_data_t> data;
+
+  public:
+    /** \brief Create a cursor manager
+     *
+     * \param pointer Pointer whose cursor is set
+     * \param compositor Compositor to create the cursor surface with
+     * \param shm wl_shm global for the theme buffers
+     * \param shape_manager Optional wp_cursor_shape_manager_v1 global
+     * \param theme Name of the theme. If empty, $XCURSOR_THEME or the
+     *        default theme is used.
+     * \param size Nominal cursor size. If 0, $XCURSOR_SIZE or 24 is used.
+     * \exception std::system_error if the timer cannot be created
+     */
+    cursor_manager_t(pointer_t pointer, compositor_t compositor, shm_t shm,
+                     cursor_shape_manager_v1_t shape_manager = cursor_shape_manager_v1_t(),
+                     std::string theme = "", int size = 0);
+    ~cursor_manager_t();
+    cursor_manager_t(const cursor_manager_t&) = delete;
+    cursor_manager_t(cursor_manager_t&&) noexcept;
+    cursor_manager_t &operator=(const cursor_manager_t&) = delete;
+    cursor_manager_t &operator=(cursor_manager_t&&) noexcept;
+
+    /** \brief Show the cursor after the pointer entered a surface
+     *
+     * Must be called from the wl_pointer.enter event.
+     *
+     * \param serial Serial of the enter event
+     */
+    void enter(uint32_t serial);
+
+    /** \brief Stop updating the cursor after the pointer left the surface
+     *
+     * Must be called from the wl_pointer.leave event. Stops the animation,
+     * and changes of the cursor are only applied with the next enter().
+     */
+    void leave();
+
+    /** \brief Select the cursor by name
+     *
+     * CSS cursor names are preferred, but any name of the theme can be
+     * used. If the theme lacks the cursor, the default cursor is shown.
+     * The cursor changes immediately if the pointer is on one of the
+     * client's surfaces.
+     */
+    void set_cursor(const std::string &name);
+
+    /** \brief Hide the cursor until the next call of set_cursor() */
+    void hide();
+
+    /** \brief Set the buffer scale of the surface under the pointer
+     *
+     * Selects the theme with the nominal size multiplied by the scale.
+     */
+    void set_scale(int32_t scale);
+
+    /** \brief Whether the cursor of the current name is shown by the compositor */
+    bool uses_shape() const;
+
+    /** \brief File descriptor of the animation timer
+     *
+     * When it becomes readable, dispatch() must be called.
+     */
+    int get_fd() const;
+
+    /** \brief Show the next frame of an animated cursor, if it is due */
+    void dispatch();
+  };
+}
+
+#endif
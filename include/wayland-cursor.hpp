@@ -51,6 +51,14 @@ namespace wayland
     uint32_t delay() const;
     // buffer will be destroyed when cursor_theme is destroyed
     buffer_t get_buffer() const;
+
+    /** \brief Get the libwayland-cursor image
+     *
+     * \exception std::runtime_error if the image belongs to a natively
+     * loaded theme, see cursor_theme_t
+     */
+    wl_cursor_image *c_ptr() const;
+    operator wl_cursor_image*() const;
   };
 
   class cursor_t : public detail::basic_wrapper<wl_cursor>
@@ -67,14 +75,67 @@ namespace wayland
     std::string name() const;
     cursor_image_t image(unsigned int n) const;
     int frame(uint32_t time) const;
+
+    /** \brief Get the libwayland-cursor cursor
+     *
+     * \exception std::runtime_error if the cursor belongs to a natively
+     * loaded theme, see cursor_theme_t
+     */
+    wl_cursor *c_ptr() const;
+    operator wl_cursor*() const;
   };
 
+  /** \brief Cursor theme
+   *
+   * By default, themes are loaded with libwayland-cursor. Themes can also
+   * be loaded by a native Xcursor loader, which looks them up in
+   * $XCURSOR_PATH or the default icon directories, including the themes
+   * they inherit from. Cursor files are mapped and indexed on the first
+   * get_cursor() of a cursor, and only the images with the nominal size
+   * closest to \a size are used. Their pixels are copied into a shm pool
+   * shared by the whole theme when cursor_image_t::get_buffer() is first
+   * called. If no theme directory exists at all, the theme is loaded with
+   * libwayland-cursor anyway, which provides built-in cursors.
+   *
+   * Natively loaded themes have no libwayland-cursor objects. c_ptr() of
+   * such a theme, and of its cursors and images, throws instead of
+   * returning a pointer that the wl_cursor functions cannot handle. The
+   * c_ptr() of the base classes is not checked, so code that needs the
+   * libwayland-cursor objects must not load themes natively. Use
+   * is_native() to tell the two kinds of themes apart.
+   */
   class cursor_theme_t : public detail::refcounted_wrapper<wl_cursor_theme>
   {
+  private:
+    cursor_theme_t(std::shared_ptr<wl_cursor_theme> theme);
+    friend class cursor_theme_cache_t;
+
   public:
     cursor_theme_t() = default;
-    cursor_theme_t(const std::string& name, int size, const shm_t& shm);
+
+    /** \brief Load a cursor theme
+     *
+     * \param name Name of the theme, or an empty string for the default theme
+     * \param size Nominal size of the cursors in buffer pixels
+     * \param shm wl_shm global used for the cursor buffers
+     * \param native Whether to use the native Xcursor loader instead of
+     *        libwayland-cursor, see above
+     * \exception std::runtime_error if the theme cannot be loaded
+     */
+    cursor_theme_t(const std::string& name, int size, const shm_t& shm, bool native = false);
+
     cursor_t get_cursor(const std::string& name) const;
+
+    /** \brief Whether the theme was loaded by the native Xcursor loader
+     */
+    bool is_native() const;
+
+    /** \brief Get the libwayland-cursor theme
+     *
+     * \exception std::runtime_error if the theme was loaded natively
+     */
+    wl_cursor_theme *c_ptr() const;
+    operator wl_cursor_theme*() const;
   };
 }
 
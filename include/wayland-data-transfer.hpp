@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WAYLAND_DATA_TRANSFER_HPP
+#define WAYLAND_DATA_TRANSFER_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace wayland
+{
+  namespace detail
+  {
+    struct data_transfer_data_t;
+  }
+
+  /** \brief State of a data transfer */
+  enum class transfer_status
+  {
+    running,
+    done,
+    cancelled,
+    failed
+  };
+
+  /** \brief Progress of a data transfer */
+  struct transfer_progress_t
+  {
+    /** \brief Transferred bytes */
+    std::size_t bytes = 0;
+    /** \brief Size of the data, or 0 if unknown */
+    std::size_t total = 0;
+    /** \brief Time since the transfer was started */
+    std::chrono::nanoseconds elapsed{0};
+
+    /** \brief Throughput in bytes per second */
+    double rate() const;
+  };
+
+  /** \brief Result of a finished data transfer */
+  struct transfer_result_t
+  {
+    transfer_status status = transfer_status::done;
+    /** \brief errno value if the transfer failed */
+    int error = 0;
+    /** \brief Received data, for transfers into memory */
+    std::string data;
+    transfer_progress_t progress;
+  };
+
+  /** \brief Asynchronous transfers of clipboard and drag and drop data
+   *
+   * Selection and drag and drop data is passed through pipes: the
+   * receiving client sends the write end with the receive request of an
+   * offer, e.g. wl_data_offer.receive, and the source client gets it with
+   * the send event of its source and writes the data. Doing this with
+   * blocking reads and writes stalls the application for large data or
+   * slow peers.
+   *
+   * The engine handles any number of these pipes with non-blocking I/O.
+   * Data is moved from and to files with splice(), so it does not pass
+   * through user space. Memfds are files as well, so large data that is
+   * offered repeatedly, e.g. an image, is best kept in a memfd.
+   *
+   * The engine is driven by its file descriptor, which must be polled
+   * together with the display, see get_fd() and dispatch(). All callbacks
+   * are called from dispatch(). The engine is not thread safe, but it may
+   * be driven by a worker thread, if all functions are called from there.
+   *
+   * \code
+   * data_transfer_t transfers;
+   * transfers.receive([&] (int fd) { offer.receive("text/plain;charset=utf-8", fd); display.flush(); },
+   *                   [] (transfer_result_t result) { paste(result.data); });
+   * source.on_send() = [&] (const std::string&, int fd) { transfers.send(fd, text); };
+   * \endcode
+   */
+  class data_transfer_t
+  {
+  private:
+    std::unique_ptr<detail::data_transfer_data_t> data;
+
+  public:
+    /** \brief Called when a transfer finished, failed or was cancelled */
+    using done_t = std::function<void(transfer_result_t)>;
+
+    /** \brief Create a transfer engine
+     *
+     * \exception std::system_error if the epoll instance cannot be created
+     */
+    data_transfer_t();
+    ~data_transfer_t();
+    data_transfer_t(const data_transfer_t&) = delete;
+    data_transfer_t(data_transfer_t&&) noexcept;
+    data_transfer_t &operator=(const data_transfer_t&) = delete;
+    data_transfer_t &operator=(data_transfer_t&&) noexcept;
+
+    /** \brief Receive data into memory
+     *
+     * Creates a pipe and passes its write end to the request function,
+     * which must send it with the receive request of an offer. The write
+     * end is closed afterwards, so the request must have been marshalled
+     * by then. Flushing the display is up to the caller.
+     *
+     * \param request Sends the receive request with the given fd
+     * \param done Called with the received data
+     * \param limit Maximum size of the data. Larger transfers fail with EFBIG.
+     * \return Id of the transfer
+     * \exception std::system_error if the pipe cannot be created
+     */
+    uint32_t receive(const std::function<void(int)> &request, done_t done, std::size_t limit = SIZE_MAX);
+
+    /** \brief Receive data into a file
+     *
+     * Same as receive(), but the data is written to a file descriptor,
+     * e.g. a file or a memfd, using splice().
+     *
+     * \param request Sends the receive request with the given fd
+     * \param fd Destination, which is duplicated
+     * \param done Called when the transfer finished
+     * \return Id of the transfer
+     * \exception std::system_error if the pipe cannot be created
+     */
+    uint32_t receive(const std::function<void(int)> &request, int fd, done_t done);
+
+    /** \brief Send data from memory
+     *
+     * \param fd File descriptor of the send event. The engine takes
+     *        ownership and closes it when done.
+     * \param data Data to send
+     * \param done Optionally called when the transfer finished
+     * \return Id of the transfer
+     */
+    uint32_t send(int fd, std::string data, done_t done = done_t());
+
+    /** \brief Send data from a file
+     *
+     * The whole file is sent with splice(), or with sendfile() if the
+     * receiver is not a pipe. The file offset is not changed, so the same
+     * file can be sent to several receivers at once.
+     *
+     * \param fd File descriptor of the send event. The engine takes
+     *        ownership and closes it when done.
+     * \param file Source file, e.g. a memfd, which is duplicated
+     * \param done Optionally called when the transfer finished
+     * \return Id of the transfer
+     * \exception std::system_error if the size of the file cannot be read
+     */
+    uint32_t send_file(int fd, int file, done_t done = done_t());
+
+    /** \brief Cancel a transfer
+     *
+     * The done callback is called with transfer_status::cancelled. Unknown
+     * ids are ignored.
+     */
+    void cancel(uint32_t id);
+
+    /** \brief Cancel all transfers */
+    void cancel_all();
+
+    /** \brief Progress of a running transfer
+     *
+     * \exception std::invalid_argument if the id is unknown
+     */
+    transfer_progress_t get_progress(uint32_t id) const;
+
+    /** \brief Number of running transfers */
+    std::size_t size() const;
+
+    /** \brief Called whenever data of a transfer was moved */
+    std::function<void(uint32_t, const transfer_progress_t&)> &on_progress();
+
+    /** \brief File descriptor that becomes readable when a transfer can make progress
+     *
+     * When it becomes readable, dispatch() must be called.
+     */
+    int get_fd() const;
+
+    /** \brief Move the data of all transfers that are ready */
+    void dispatch();
+  };
+}
+
+#endif
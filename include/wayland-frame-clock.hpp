@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WAYLAND_FRAME_CLOCK_HPP
+#define WAYLAND_FRAME_CLOCK_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <wayland-client-protocol.hpp>
+#include <wayland-client-protocol-extra.hpp>
+
+namespace wayland
+{
+  namespace detail
+  {
+    struct frame_clock_data_t;
+  }
+
+  /** \brief Timing of a frame handed out by frame_clock_t
+   *
+   * All times are given in the presentation clock, see
+   * frame_clock_t::get_clock_id().
+   */
+  struct frame_tick_t
+  {
+    /** Timestamp of the frame callback in milliseconds, or 0 for the first frame */
+    uint32_t callback_time = 0;
+
+    /** Predicted time at which the frame is shown */
+    std::chrono::nanoseconds presentation_time{0};
+
+    /** Time by which rendering should be finished */
+    std::chrono::nanoseconds deadline{0};
+
+    /** Duration of a refresh cycle, or 0 if unknown */
+    std::chrono::nanoseconds refresh{0};
+
+    /** Predicted refresh counter at presentation, or 0 if unknown */
+    uint64_t sequence = 0;
+
+    /** Whether the prediction is based on presentation feedback */
+    bool predicted = false;
+  };
+
+  /** \brief Frame clock shared by several surfaces
+   *
+   * Paces rendering of all surfaces of an application with a single
+   * frame callback on a driver surface, usually the main surface. Surfaces
+   * are registered with add_surface() and ask for a frame with schedule().
+   * On the next frame callback, each scheduled surface gets exactly one
+   * tick, so no surface renders more than once per refresh cycle.
+   * Subsurfaces are ticked before the driver surface, so that their
+   * synchronized state is applied by the commit of the driver surface.
+   *
+   * If a wp_presentation global is given, the feedback of each frame is
+   * used to predict the time of the next presentation and the refresh
+   * counter. Otherwise the refresh rate is estimated from the intervals of
+   * the frame callbacks.
+   *
+   * With set_render_time(), ticks are delayed until the render time before
+   * the predicted presentation, so frames are rendered as late as
+   * possible. The delay uses a timer whose file descriptor must be polled
+   * together with the display, see get_fd() and dispatch().
+   *
+   * \code
+   * // right after binding wp_presentation
+   * presentation.on_clock_id() = [&] (uint32_t id) { presentation_clock = static_cast<clockid_t>(id); };
+   *
+   * frame_clock_t clock(surface, presentation, presentation_clock);
+   * clock.add_surface(surface, [&] (const frame_tick_t &tick)
+   * {
+   *   draw(tick);
+   *   surface.commit();
+   *   clock.schedule(surface); // continuous animation
+   * });
+   * clock.schedule(surface);
+   * \endcode
+   *
+   * The driver surface must be mapped, since compositors only send frame
+   * callbacks for visible surfaces. If the driver surface is not scheduled
+   * during a tick, the clock commits it to request the next frame callback.
+   */
+  class frame_clock_t
+  {
+  private:
+    std::unique_ptr<detail::frame_clock_data_t> data;
+
+  public:
+    /** \brief Create a frame clock
+     *
+     * \param driver Surface whose frame callbacks drive the clock
+     * \param presentation Optional wp_presentation global. The clock_id
+     *        event is sent right after binding, so the clock should be
+     *        created before the next roundtrip. Otherwise
+     *        CLOCK_MONOTONIC is assumed. If the clock is created later,
+     *        record the clock_id event when binding the global and use
+     *        the constructor that takes the clock.
+     * \exception std::system_error if the timer cannot be created
+     */
+    frame_clock_t(surface_t driver, presentation_t presentation = presentation_t());
+
+    /** \brief Create a frame clock for a known presentation clock
+     *
+     * \param driver Surface whose frame callbacks drive the clock
+     * \param presentation wp_presentation global
+     * \param clock_id Clock announced by the clock_id event of \a presentation
+     * \exception std::system_error if the timer cannot be created
+     */
+    frame_clock_t(surface_t driver, presentation_t presentation, clockid_t clock_id);
+    ~frame_clock_t();
+    frame_clock_t(const frame_clock_t&) = delete;
+    frame_clock_t(frame_clock_t&&) noexcept;
+    frame_clock_t &operator=(const frame_clock_t&) = delete;
+    frame_clock_t &operator=(frame_clock_t&&) noexcept;
+
+    /** \brief Register a surface
+     *
+     * \param surface Surface to tick. The driver surface may be added too.
+     * \param render Function that renders and commits the surface
+     */
+    void add_surface(surface_t surface, std::function<void(const frame_tick_t&)> render);
+
+    /** \brief Unregister a surface
+     *
+     * May be called from a render function.
+     */
+    void remove_surface(const surface_t &surface);
+
+    /** \brief Request a tick for a surface
+     *
+     * If the clock is idle, the tick is delivered immediately. Otherwise
+     * the surface is ticked with the next frame. Scheduling a surface
+     * several times before the next frame results in a single tick.
+     *
+     * \exception std::invalid_argument if the surface is not registered
+     */
+    void schedule(const surface_t &surface);
+
+    /** \brief Request a tick for several surfaces
+     *
+     * Like schedule(const surface_t&), but an idle clock ticks all of the
+     * surfaces at once. This is useful for the first frame.
+     *
+     * \exception std::invalid_argument if a surface is not registered
+     */
+    void schedule(const std::vector<surface_t> &surfaces);
+
+    /** \brief Set the time needed to render a frame
+     *
+     * If non-zero and the refresh rate is known, ticks are delayed until
+     * the render time before the predicted presentation.
+     */
+    void set_render_time(std::chrono::nanoseconds time);
+
+    /** \brief File descriptor of the timer for delayed ticks
+     *
+     * When it becomes readable, dispatch() must be called.
+     */
+    int get_fd() const;
+
+    /** \brief Deliver a delayed tick, if it is due */
+    void dispatch();
+
+    /** \brief Clock used for the presentation timestamps */
+    clockid_t get_clock_id() const;
+
+    /** \brief Current estimate of the refresh cycle, or 0 if unknown */
+    std::chrono::nanoseconds get_refresh() const;
+  };
+}
+
+#endif
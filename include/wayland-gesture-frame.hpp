@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WAYLAND_GESTURE_FRAME_HPP
+#define WAYLAND_GESTURE_FRAME_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <wayland-client-protocol-unstable.hpp>
+
+namespace wayland
+{
+  namespace detail
+  {
+    struct gesture_aggregator_data_t;
+  }
+
+  /** \brief Type of a pointer gesture
+   */
+  enum class gesture_type : uint32_t
+  {
+    swipe = 0,
+    pinch = 1,
+    hold = 2
+  };
+
+  /** \brief Events of a pointer gesture
+   *
+   * Plain struct holding the events of one gesture since the last
+   * delivery. The deltas and the rotation of coalesced updates are summed
+   * up, the scale is the latest one.
+   */
+  struct gesture_frame_t
+  {
+    /** \brief Validity bits of the fields */
+    enum : uint32_t
+    {
+      has_begin = 1u << 0,
+      has_update = 1u << 1,
+      has_end = 1u << 2,
+      has_cancel = 1u << 3
+    };
+
+    uint32_t valid;
+    gesture_type type;
+    /** \brief Serial of the begin or end event */
+    uint32_t serial;
+    /** \brief Time of the last event */
+    uint32_t time;
+    uint32_t fingers;
+    double dx;
+    double dy;
+    /** \brief Scale relative to the begin of a pinch gesture */
+    double scale;
+    /** \brief Rotation of a pinch gesture in degrees */
+    double rotation;
+    /** \brief Number of coalesced update events */
+    uint32_t update_count;
+  };
+
+  /** \brief Coalesced events of zwp_pointer_gestures_v1
+   *
+   * Creates the swipe, pinch and, if supported, hold gesture objects of a
+   * pointer and passes their events to a single callback as a
+   * gesture_frame_t. Gestures have no frame events, so update events are
+   * accumulated until flush() is called, e.g. once after dispatching the
+   * display queue or before rendering. Begin and end events are delivered
+   * together with the pending updates of their gesture right away.
+   *
+   * \code
+   * gesture_aggregator_t gestures(pointer_gestures, pointer);
+   * gestures.on_frame() = [&] (const gesture_frame_t &frame)
+   * {
+   *   if(frame.type == gesture_type::pinch && (frame.valid & gesture_frame_t::has_update))
+   *     zoom(frame.scale);
+   * };
+   * while(display.dispatch() != -1)
+   *   gestures.flush();
+   * \endcode
+   */
+  class gesture_aggregator_t
+  {
+  private:
+    std::unique_ptr<detail::gesture_aggregator_data_t> data;
+
+  public:
+    /** \brief Aggregate the gestures of a pointer
+     *
+     * \param gestures zwp_pointer_gestures_v1 global
+     * \param pointer Pointer to get the gestures of
+     */
+    gesture_aggregator_t(zwp_pointer_gestures_v1_t gestures, pointer_t pointer);
+    ~gesture_aggregator_t();
+    gesture_aggregator_t(const gesture_aggregator_t&) = delete;
+    gesture_aggregator_t(gesture_aggregator_t&&) noexcept;
+    gesture_aggregator_t &operator=(const gesture_aggregator_t&) = delete;
+    gesture_aggregator_t &operator=(gesture_aggregator_t&&) noexcept;
+
+    /** \brief Called for every delivered gesture frame
+     */
+    std::function<void(const gesture_frame_t&)> &on_frame();
+
+    /** \brief Deliver accumulated update events
+     */
+    void flush();
+
+    /** \brief Surface of the current or last gesture
+     */
+    surface_t get_surface() const;
+  };
+}
+
+#endif
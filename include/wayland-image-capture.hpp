@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WAYLAND_IMAGE_CAPTURE_HPP
+#define WAYLAND_IMAGE_CAPTURE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <wayland-client-protocol.hpp>
+#include <wayland-client-protocol-staging.hpp>
+
+namespace wayland
+{
+  namespace detail
+  {
+    struct image_capture_data_t;
+  }
+
+  /** \brief Rectangle in buffer coordinates */
+  struct capture_rect_t
+  {
+    int32_t x;
+    int32_t y;
+    int32_t width;
+    int32_t height;
+  };
+
+  /** \brief Frame captured by an image_capture_session_t
+   *
+   * The pixel data holds the complete image. The damage lists the parts
+   * that changed since the previous frame in the queue, which is
+   * the whole image for the first frame and after a resize.
+   */
+  struct captured_frame_t
+  {
+    /** \brief Pixel data */
+    const uint8_t *data = nullptr;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t stride = 0;
+    shm_format format = shm_format::xrgb8888;
+    /** \brief Transform of the source, which is not applied to the pixels */
+    output_transform transform = output_transform::normal;
+    /** \brief Presentation time in CLOCK_MONOTONIC, or 0 if unknown */
+    std::chrono::nanoseconds presentation_time{0};
+    /** \brief Changed parts since the previous frame */
+    std::vector<capture_rect_t> damage;
+    /** \brief Number of the frame, counting dropped frames as well */
+    uint64_t sequence = 0;
+  };
+
+  /** \brief Continuous capture of an image capture source
+   *
+   * Captures an output or a toplevel with ext_image_copy_capture_v1 into a
+   * ring of shm buffers, which are allocated according to the buffer
+   * constraints of the session. The next capture is started as soon as a
+   * frame is ready, so the compositor can copy the next image while the
+   * previous one is read. Every shm buffer is only updated where it is
+   * out of date, and only the damaged parts of a frame are copied out into
+   * the frames handed to the consumer.
+   *
+   * Frames are passed to a consumer thread, e.g. an encoder, through a
+   * lock-free single-producer/single-consumer queue. The capture itself
+   * runs on the thread dispatching the display. If the queue is full, the
+   * newest frame is kept back until the consumer releases a frame, and
+   * older frames that were kept back are dropped. Their damage is added to
+   * the next frame. The file descriptor returned by get_fd() must be
+   * polled together with the display, so that a kept back frame is
+   * delivered even if the source does not change anymore.
+   *
+   * \code
+   * image_capture_session_t capture(manager, output_source_manager.create_source(output), shm);
+   * std::thread encoder([&] ()
+   * {
+   *   pollfd fd = { capture.get_frame_fd(), POLLIN, 0 };
+   *   while(poll(&fd, 1, -1) > 0)
+   *     while(const captured_frame_t *frame = capture.acquire_frame())
+   *     {
+   *       encode(*frame);
+   *       capture.release_frame();
+   *     }
+   * });
+   * \endcode
+   */
+  class image_capture_session_t
+  {
+  private:
+    std::unique_ptr<detail::image_capture_data_t> data;
+
+  public:
+    /** \brief Start capturing
+     *
+     * \param manager ext_image_copy_capture_manager_v1 global
+     * \param source Source to capture
+     * \param shm wl_shm global
+     * \param options Options of the session, e.g. painting cursors
+     * \param buffers Number of shm buffers in the ring, at least 2
+     * \param frames Number of frames in the queue to the consumer
+     * \exception std::invalid_argument if a global is missing or a count is too small
+     * \exception std::system_error if the event file descriptor cannot be created
+     */
+    image_capture_session_t(ext_image_copy_capture_manager_v1_t manager, ext_image_capture_source_v1_t source,
+                            shm_t shm, ext_image_copy_capture_manager_v1_options options = 0,
+                            unsigned int buffers = 2, unsigned int frames = 3);
+    ~image_capture_session_t();
+    image_capture_session_t(const image_capture_session_t&) = delete;
+    image_capture_session_t(image_capture_session_t&&) noexcept;
+    image_capture_session_t &operator=(const image_capture_session_t&) = delete;
+    image_capture_session_t &operator=(image_capture_session_t&&) noexcept;
+
+    /** \brief Called when the source is gone and no more frames will be captured */
+    std::function<void()> &on_stopped();
+
+    /** \brief Whether the session was stopped by the compositor */
+    bool is_stopped() const;
+
+    /** \brief Number of frames dropped because the queue was full */
+    uint64_t get_dropped() const;
+
+    /** \brief Oldest frame in the queue
+     *
+     * May only be called from a single consumer thread. The frame stays
+     * valid until release_frame() is called.
+     *
+     * \return The frame, or nullptr if the queue is empty
+     */
+    const captured_frame_t *acquire_frame();
+
+    /** \brief Give the oldest frame back to the capture
+     *
+     * May only be called from the consumer thread.
+     */
+    void release_frame();
+
+    /** \brief File descriptor that becomes readable when frames are queued
+     *
+     * It is reset by acquire_frame() once the queue is empty.
+     */
+    int get_frame_fd() const;
+
+    /** \brief File descriptor of the producer side
+     *
+     * Becomes readable when a slot in the queue was freed while a frame
+     * was kept back. Then dispatch() must be called on the thread
+     * dispatching the display.
+     */
+    int get_fd() const;
+
+    /** \brief Deliver a kept back frame into the queue */
+    void dispatch();
+  };
+}
+
+#endif
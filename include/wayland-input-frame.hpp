@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WAYLAND_INPUT_FRAME_HPP
+#define WAYLAND_INPUT_FRAME_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <wayland-client-protocol.hpp>
+
+namespace wayland
+{
+  namespace detail
+  {
+    struct pointer_aggregator_data_t;
+    struct touch_aggregator_data_t;
+  }
+
+  /** \brief Button event of a pointer frame
+   */
+  struct pointer_button_event_t
+  {
+    uint32_t serial;
+    uint32_t time;
+    uint32_t button;
+    pointer_button_state state;
+  };
+
+  /** \brief Axis events of a pointer frame
+   *
+   * Values of repeated axis events of the same frame are summed up.
+   */
+  struct pointer_axis_event_t
+  {
+    /** \brief Validity bits of the fields */
+    enum : uint32_t
+    {
+      has_value = 1u << 0,
+      has_discrete = 1u << 1,
+      has_value120 = 1u << 2,
+      has_relative_direction = 1u << 3,
+      has_stop = 1u << 4
+    };
+
+    uint32_t valid;
+    uint32_t time;
+    double value;
+    int32_t discrete;
+    int32_t value120;
+    pointer_axis_relative_direction relative_direction;
+  };
+
+  /** \brief Events of a wl_pointer frame
+   *
+   * Plain struct holding everything a wl_pointer sent between two frame
+   * events. Only fields whose bit is set in valid were sent, except for
+   * x and y, which always hold the current position of the pointer.
+   */
+  struct pointer_frame_t
+  {
+    /** \brief Maximum number of button events in one frame */
+    static const uint32_t max_buttons = 8;
+
+    /** \brief Validity bits of the fields */
+    enum : uint32_t
+    {
+      has_enter = 1u << 0,
+      has_leave = 1u << 1,
+      has_motion = 1u << 2,
+      has_button = 1u << 3,
+      has_axis = 1u << 4,
+      has_axis_source = 1u << 5
+    };
+
+    uint32_t valid;
+    /** \brief Time of the last event with a timestamp */
+    uint32_t time;
+    /** \brief Serial of the enter or leave event */
+    uint32_t serial;
+    /** \brief Surface-local position */
+    double x;
+    double y;
+    uint32_t button_count;
+    pointer_button_event_t buttons[max_buttons];
+    pointer_axis_source axis_source;
+    /** \brief Axis events, indexed by pointer_axis */
+    pointer_axis_event_t axes[2];
+  };
+
+  /** \brief Touch point of a touch frame
+   */
+  struct touch_point_t
+  {
+    /** \brief Validity bits of the fields */
+    enum : uint32_t
+    {
+      has_down = 1u << 0,
+      has_up = 1u << 1,
+      has_motion = 1u << 2,
+      has_shape = 1u << 3,
+      has_orientation = 1u << 4
+    };
+
+    uint32_t valid;
+    int32_t id;
+    /** \brief Serial of the down or up event */
+    uint32_t serial;
+    /** \brief Time of the last event of the point */
+    uint32_t time;
+    /** \brief Surface-local position, always the current one */
+    double x;
+    double y;
+    double major;
+    double minor;
+    double orientation;
+  };
+
+  /** \brief Events of a wl_touch frame
+   *
+   * Plain struct holding the touch points that changed between two frame
+   * events.
+   */
+  struct touch_frame_t
+  {
+    /** \brief Maximum number of touch points in one frame */
+    static const uint32_t max_points = 10;
+
+    /** \brief Validity bits of the fields */
+    enum : uint32_t
+    {
+      has_cancel = 1u << 0
+    };
+
+    uint32_t valid;
+    uint32_t point_count;
+    touch_point_t points[max_points];
+  };
+
+  /** \brief Frame-grouped events of a wl_pointer
+   *
+   * Takes over the event handlers of the pointer and accumulates all events
+   * up to the next frame event into a pointer_frame_t, which is passed to a
+   * single callback. Pointers older than version 5 have no frame events,
+   * so every event is a frame of its own.
+   *
+   * If a frame holds more than pointer_frame_t::max_buttons button events,
+   * it is split into several frames.
+   *
+   * \code
+   * pointer_aggregator_t aggregator(pointer);
+   * aggregator.on_frame() = [&] (const pointer_frame_t &frame)
+   * {
+   *   if(frame.valid & pointer_frame_t::has_motion)
+   *     hover(aggregator.get_focus(), frame.x, frame.y);
+   * };
+   * \endcode
+   */
+  class pointer_aggregator_t
+  {
+  private:
+    std::unique_ptr<detail::pointer_aggregator_data_t> data;
+
+  public:
+    /** \brief Aggregate the events of a pointer
+     *
+     * \param pointer Pointer whose event handlers are replaced
+     */
+    pointer_aggregator_t(pointer_t pointer);
+    ~pointer_aggregator_t();
+    pointer_aggregator_t(const pointer_aggregator_t&) = delete;
+    pointer_aggregator_t(pointer_aggregator_t&&) noexcept;
+    pointer_aggregator_t &operator=(const pointer_aggregator_t&) = delete;
+    pointer_aggregator_t &operator=(pointer_aggregator_t&&) noexcept;
+
+    /** \brief Called once per frame
+     */
+    std::function<void(const pointer_frame_t&)> &on_frame();
+
+    /** \brief Surface the pointer is on, or an empty surface
+     */
+    surface_t get_focus() const;
+
+    /** \brief Surface the pointer has left during the current frame
+     *
+     * Only valid in on_frame() if has_leave is set.
+     */
+    surface_t get_left() const;
+  };
+
+  /** \brief Frame-grouped events of a wl_touch
+   *
+   * Takes over the event handlers of the touch device and accumulates all
+   * events up to the next frame event into a touch_frame_t, which is passed
+   * to a single callback. If more than touch_frame_t::max_points points
+   * change within one frame, it is split into several frames.
+   */
+  class touch_aggregator_t
+  {
+  private:
+    std::unique_ptr<detail::touch_aggregator_data_t> data;
+
+  public:
+    /** \brief Aggregate the events of a touch device
+     *
+     * \param touch Touch device whose event handlers are replaced
+     */
+    touch_aggregator_t(touch_t touch);
+    ~touch_aggregator_t();
+    touch_aggregator_t(const touch_aggregator_t&) = delete;
+    touch_aggregator_t(touch_aggregator_t&&) noexcept;
+    touch_aggregator_t &operator=(const touch_aggregator_t&) = delete;
+    touch_aggregator_t &operator=(touch_aggregator_t&&) noexcept;
+
+    /** \brief Called once per frame
+     */
+    std::function<void(const touch_frame_t&)> &on_frame();
+
+    /** \brief Surface a touch point went down on
+     *
+     * Points that went up are forgotten after the on_frame() callback.
+     *
+     * \param id ID of the touch point
+     * \return The surface, or an empty surface for unknown points
+     */
+    surface_t get_surface(int32_t id) const;
+  };
+}
+
+#endif
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WAYLAND_INPUT_TIMELINE_HPP
+#define WAYLAND_INPUT_TIMELINE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <wayland-client-protocol-unstable.hpp>
+
+namespace wayland
+{
+  namespace detail
+  {
+    struct input_timeline_data_t;
+  }
+
+  /** \brief Type of an input sample
+   */
+  enum class input_sample_type : uint32_t
+  {
+    relative_motion = 0,
+    button = 1
+  };
+
+  /** \brief Timestamped input event of an input_timeline_t
+   *
+   * The deltas are the raw 24.8 fixed-point values sent by the compositor,
+   * see wl_fixed_to_double(), so summing them up is exact.
+   */
+  struct input_sample_t
+  {
+    input_sample_type type;
+    /** \brief Timestamp in nanoseconds */
+    uint64_t time;
+    /** \brief Accelerated motion, only for relative motion */
+    int32_t dx;
+    int32_t dy;
+    /** \brief Unaccelerated motion, only for relative motion */
+    int32_t dx_unaccel;
+    int32_t dy_unaccel;
+    /** \brief Button and its new state, only for button events */
+    uint32_t button;
+    pointer_button_state state;
+  };
+
+  /** \brief Lock-free timeline of pointer input
+   *
+   * Records the zwp_relative_pointer_v1 motion of a pointer into a ring
+   * buffer while the display is dispatched. A single other thread, e.g. a
+   * render thread, can read the samples without locking and integrate all
+   * motion since its last frame. Relative motion carries microsecond
+   * timestamps.
+   *
+   * If a zwp_input_timestamps_manager_v1 is given, button events of the
+   * pointer are recorded too, with the nanosecond timestamps of the
+   * input-timestamps protocol. Button events are taken from the pointer by
+   * wrapping its on_button() handler, which is still called. It is
+   * restored on destruction unless it was replaced in the meantime.
+   *
+   * If the ring is full, new samples are dropped. The motion of dropped
+   * samples is added to the next recorded sample, so integrated motion
+   * stays exact.
+   *
+   * \code
+   * input_timeline_t timeline(relative_pointer_manager, pointer, timestamps_manager);
+   * // render thread
+   * input_sample_t samples[64];
+   * std::size_t n;
+   * while((n = timeline.read(samples, 64)) > 0)
+   *   for(std::size_t c = 0; c < n; c++)
+   *     if(samples[c].type == input_sample_type::relative_motion)
+   *       yaw += wl_fixed_to_double(samples[c].dx_unaccel) * sensitivity;
+   * \endcode
+   *
+   * The timeline must be created and destroyed in the thread that
+   * dispatches the pointer events.
+   */
+  class input_timeline_t
+  {
+  private:
+    std::unique_ptr<detail::input_timeline_data_t> data;
+
+  public:
+    /** \brief Record the input of a pointer
+     *
+     * \param manager zwp_relative_pointer_manager_v1 global
+     * \param pointer Pointer to record
+     * \param timestamps Optional zwp_input_timestamps_manager_v1 global
+     * \param capacity Number of samples in the ring, rounded up to a
+     *        power of two
+     * \exception std::invalid_argument if the capacity is 0
+     */
+    input_timeline_t(zwp_relative_pointer_manager_v1_t manager, pointer_t pointer,
+                     zwp_input_timestamps_manager_v1_t timestamps = zwp_input_timestamps_manager_v1_t(),
+                     std::size_t capacity = 1024);
+    ~input_timeline_t();
+    input_timeline_t(const input_timeline_t&) = delete;
+    input_timeline_t(input_timeline_t&&) noexcept;
+    input_timeline_t &operator=(const input_timeline_t&) = delete;
+    input_timeline_t &operator=(input_timeline_t&&) noexcept;
+
+    /** \brief Take recorded samples, oldest first
+     *
+     * May only be called by one thread at a time.
+     *
+     * \param samples Array to copy the samples to
+     * \param count Size of the array
+     * \return Number of samples copied
+     */
+    std::size_t read(input_sample_t *samples, std::size_t count);
+
+    /** \brief Number of samples that can be read
+     */
+    std::size_t size() const;
+
+    /** \brief Number of samples dropped because the ring was full
+     */
+    uint64_t get_dropped() const;
+  };
+}
+
+#endif
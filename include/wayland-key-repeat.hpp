@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WAYLAND_KEY_REPEAT_HPP
+#define WAYLAND_KEY_REPEAT_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <wayland-client-protocol.hpp>
+
+namespace wayland
+{
+  namespace detail
+  {
+    struct key_repeat_data_t;
+  }
+
+  /** \brief Key repeat of a wl_keyboard
+   *
+   * Takes over the key, leave and repeat_info event handlers of a keyboard
+   * and synthesizes repeats of the last pressed key with the rate and delay
+   * sent by the compositor. Repeats are timed by a single timer whose file
+   * descriptor must be polled together with the display, see get_fd() and
+   * dispatch(). The timer is only armed while a repeating key is held, so
+   * an idle keyboard causes no wakeups.
+   *
+   * Repeats stop when the key is released, another key is pressed or the
+   * keyboard focus is lost. Each repeat carries the time at which it was
+   * due, in the time base of the key events, so repeats that are
+   * dispatched late keep their spacing.
+   *
+   * \code
+   * key_repeat_t repeat(keyboard);
+   * repeat.on_key() = [&] (uint32_t serial, uint32_t time, uint32_t key, keyboard_key_state state)
+   * {
+   *   if(state == keyboard_key_state::pressed)
+   *     type(key, time);
+   * };
+   * repeat.on_repeat() = [&] (uint32_t time, uint32_t key) { type(key, time); };
+   * repeat.on_filter() = [&] (uint32_t key) { return xkb_keymap_key_repeats(keymap, key + 8); };
+   * \endcode
+   */
+  class key_repeat_t
+  {
+  private:
+    std::unique_ptr<detail::key_repeat_data_t> data;
+
+  public:
+    /** \brief Repeat the keys of a keyboard
+     *
+     * Keyboards older than version 4 send no repeat info, so a rate of 25
+     * per second and a delay of 600 ms are used for them.
+     *
+     * \param keyboard Keyboard whose event handlers are replaced
+     * \exception std::system_error if the timer cannot be created
+     */
+    key_repeat_t(keyboard_t keyboard);
+    ~key_repeat_t();
+    key_repeat_t(const key_repeat_t&) = delete;
+    key_repeat_t(key_repeat_t&&) noexcept;
+    key_repeat_t &operator=(const key_repeat_t&) = delete;
+    key_repeat_t &operator=(key_repeat_t&&) noexcept;
+
+    /** \brief Called for every key event of the keyboard */
+    std::function<void(uint32_t, uint32_t, uint32_t, keyboard_key_state)> &on_key();
+
+    /** \brief Called for every leave event of the keyboard */
+    std::function<void(uint32_t, surface_t)> &on_leave();
+
+    /** \brief Called for every synthesized repeat with the time and the key */
+    std::function<void(uint32_t, uint32_t)> &on_repeat();
+
+    /** \brief Decides whether a key repeats
+     *
+     * If not set, all keys repeat.
+     */
+    std::function<bool(uint32_t)> &on_filter();
+
+    /** \brief Repeats per second, 0 if repeat is disabled */
+    int32_t get_rate() const;
+
+    /** \brief Delay before the first repeat in milliseconds */
+    int32_t get_delay() const;
+
+    /** \brief Stop repeating the held key */
+    void cancel();
+
+    /** \brief File descriptor of the repeat timer
+     *
+     * When it becomes readable, dispatch() must be called.
+     */
+    int get_fd() const;
+
+    /** \brief Deliver the repeats that are due */
+    void dispatch();
+  };
+}
+
+#endif
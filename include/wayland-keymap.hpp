@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WAYLAND_KEYMAP_HPP
+#define WAYLAND_KEYMAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <wayland-client-protocol.hpp>
+
+namespace wayland
+{
+  namespace detail
+  {
+    struct keymap_data_t;
+  }
+
+  /** \brief Immutable keymap of a wl_keyboard
+   *
+   * Holds the read-only mapping of the keymap sent with the
+   * wl_keyboard.keymap event together with the hash of its contents and an
+   * optional compiled representation, e.g. a struct xkb_keymap. Keymaps are
+   * obtained from the keymap_cache_t and shared between all keyboards that
+   * received identical contents.
+   */
+  class keymap_t
+  {
+  private:
+    std::unique_ptr<detail::keymap_data_t> data;
+
+    keymap_t();
+    friend class keymap_cache_t;
+
+  public:
+    ~keymap_t();
+    keymap_t(const keymap_t&) = delete;
+    keymap_t &operator=(const keymap_t&) = delete;
+
+    /** \brief Format of the keymap
+     */
+    keyboard_keymap_format get_format() const;
+
+    /** \brief Contents of the keymap
+     *
+     * For the xkb_v1 format this is a null-terminated string. The pointer
+     * stays valid as long as the keymap exists. It is a nullptr if the
+     * format is no_keymap.
+     */
+    const char *get_data() const;
+
+    /** \brief Size of the keymap in bytes, as sent by the compositor
+     */
+    std::size_t get_size() const;
+
+    /** \brief Hash of the contents
+     */
+    std::uint64_t get_hash() const;
+
+    /** \brief Compiled representation of the keymap
+     *
+     * \return The object returned by the compile function given to
+     * keymap_cache_t::get(), or a nullptr if there was none.
+     */
+    std::shared_ptr<const void> get_compiled() const;
+
+    /** \brief Compiled representation of the keymap, cast to its type
+     *
+     * \tparam T Type of the object returned by the compile function
+     */
+    template <typename T>
+    std::shared_ptr<const T> get_compiled() const
+    {
+      return std::static_pointer_cast<const T>(get_compiled());
+    }
+  };
+
+  /** \brief Process-wide cache of keymaps
+   *
+   * Keyboards of different seats, and keyboards that are re-created on every
+   * capability change, usually receive the very same keymap. The cache maps
+   * the file descriptor of a wl_keyboard.keymap event read-only, hashes its
+   * contents and hands out the keymap_t with identical contents if there
+   * already is one, so the keymap is only parsed once. A keymap is unloaded
+   * when the last reference to it is gone and it is not one of the most
+   * recently used keymaps, which are kept alive to survive keyboards being
+   * destroyed and created again.
+   *
+   * The cache is thread-safe.
+   *
+   * \code
+   * keyboard.on_keymap() = [&] (keyboard_keymap_format format, int fd, uint32_t size)
+   * {
+   *   keymap = keymap_cache_t::get(format, fd, size, [&] (const keymap_t &km)
+   *   {
+   *     return std::shared_ptr<const void>(
+   *       xkb_keymap_new_from_string(ctx, km.get_data(), XKB_KEYMAP_FORMAT_TEXT_V1,
+   *                                  XKB_KEYMAP_COMPILE_NO_FLAGS),
+   *       [] (const void *p) { xkb_keymap_unref(static_cast<xkb_keymap*>(const_cast<void*>(p))); });
+   *   });
+   * };
+   * \endcode
+   */
+  class keymap_cache_t
+  {
+  public:
+    /** \brief Function that compiles the contents of a new keymap
+     *
+     * Called once for every keymap that is not in the cache yet. All
+     * callers of get() must use equivalent compile functions, since the
+     * result is shared with every user of the keymap.
+     */
+    typedef std::function<std::shared_ptr<const void>(const keymap_t&)> compile_t;
+
+    /** \brief Get the keymap of a wl_keyboard.keymap event
+     *
+     * \param format Format of the keymap
+     * \param fd File descriptor of the keymap, which is closed
+     * \param size Size of the keymap
+     * \param compile Optional function to compile a new keymap
+     * \exception std::system_error if the keymap cannot be mapped
+     * \exception std::invalid_argument if the keymap is empty
+     */
+    static std::shared_ptr<const keymap_t> get(keyboard_keymap_format format, int fd, uint32_t size,
+                                               const compile_t &compile = compile_t());
+
+    /** \brief Drop the references the cache holds itself
+     *
+     * Keymaps that are still in use stay in the cache.
+     */
+    static void clear();
+  };
+}
+
+#endif
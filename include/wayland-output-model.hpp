@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WAYLAND_OUTPUT_MODEL_HPP
+#define WAYLAND_OUTPUT_MODEL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <wayland-client-protocol.hpp>
+#include <wayland-client-protocol-unstable.hpp>
+
+namespace wayland
+{
+  namespace detail
+  {
+    struct output_model_data_t;
+    struct output_snapshot_slot_t;
+  }
+
+  /** \brief State of an output in an output_snapshot_t
+   */
+  struct output_info_t
+  {
+    /** Object ID of the wl_output */
+    uint32_t id = 0;
+
+    /** Name and description, empty if not sent */
+    std::string name;
+    std::string description;
+    std::string make;
+    std::string model;
+
+    /** Position in the global compositor space */
+    int32_t x = 0;
+    int32_t y = 0;
+
+    /** Physical size in millimeters */
+    int32_t physical_width = 0;
+    int32_t physical_height = 0;
+
+    output_subpixel subpixel = output_subpixel::unknown;
+    output_transform transform{0};
+
+    /** Current mode in pixels */
+    int32_t width = 0;
+    int32_t height = 0;
+
+    /** Refresh rate of the current mode in mHz */
+    int32_t refresh = 0;
+
+    int32_t scale = 1;
+
+    /** Whether the logical geometry was sent by zxdg_output_v1 */
+    bool has_logical = false;
+
+    /** Logical geometry in the global compositor space */
+    int32_t logical_x = 0;
+    int32_t logical_y = 0;
+    int32_t logical_width = 0;
+    int32_t logical_height = 0;
+  };
+
+  /** \brief Immutable snapshot of all outputs
+   *
+   * Obtained from output_model_t::get_snapshot(). The snapshot is valid as
+   * long as the handle exists, which should only be briefly, e.g. for one
+   * frame. It must not outlive the output model.
+   */
+  class output_snapshot_t
+  {
+  private:
+    detail::output_snapshot_slot_t *slot = nullptr;
+
+    output_snapshot_t(detail::output_snapshot_slot_t *s);
+    friend class output_model_t;
+
+  public:
+    output_snapshot_t() = default;
+    ~output_snapshot_t();
+    output_snapshot_t(const output_snapshot_t&) = delete;
+    output_snapshot_t(output_snapshot_t &&other) noexcept;
+    output_snapshot_t &operator=(const output_snapshot_t&) = delete;
+    output_snapshot_t &operator=(output_snapshot_t &&other) noexcept;
+
+    /** \brief Outputs in the order they were added */
+    const std::vector<output_info_t> &outputs() const;
+
+    /** \brief Find an output by the object ID of its wl_output
+     *
+     * \return The output, or nullptr if it is not in the snapshot
+     */
+    const output_info_t *find(uint32_t id) const;
+
+    /** \brief Number of the snapshot, increased with every change */
+    uint64_t get_serial() const;
+
+    /** \brief Whether the handle refers to a snapshot */
+    explicit operator bool() const;
+  };
+
+  /** \brief Output topology shared with other threads
+   *
+   * Takes over the event handlers of wl_output objects and, if available,
+   * of their zxdg_output_v1 objects. The events of an output are collected
+   * until its done event. Then a new immutable snapshot of all outputs is
+   * published. Any thread can get the current snapshot with get_snapshot(),
+   * which never blocks or waits for the thread dispatching the outputs.
+   *
+   * A limited number of snapshots can be in use at the same time. If every
+   * older snapshot is still held when the outputs change, publishing is
+   * postponed. It is retried with the next change of the outputs and by
+   * flush(). More output events may never come, so the dispatching thread
+   * should call flush() regularly.
+   *
+   * \code
+   * output_model_t outputs(xdg_output_manager);
+   * registry.on_global() = [&] (uint32_t name, const std::string &interface, uint32_t version)
+   * {
+   *   if(interface == output_t::interface_name)
+   *   {
+   *     output_t output;
+   *     registry.bind(name, output, std::min(version, 4u));
+   *     outputs.add_output(output);
+   *   }
+   * };
+   * // in the event loop of the dispatching thread, which should wake up
+   * // regularly, e.g. with a poll() timeout
+   * outputs.flush();
+   *
+   * // render thread
+   * output_snapshot_t snapshot = outputs.get_snapshot();
+   * for(const output_info_t &output : snapshot.outputs())
+   *   use(output.logical_width, output.refresh);
+   * \endcode
+   */
+  class output_model_t
+  {
+  private:
+    std::unique_ptr<detail::output_model_data_t> data;
+
+  public:
+    /** \brief Create an empty output model
+     *
+     * \param xdg_output_manager Optional zxdg_output_manager_v1 global for
+     *        the logical geometry of the outputs
+     */
+    output_model_t(zxdg_output_manager_v1_t xdg_output_manager = zxdg_output_manager_v1_t());
+    ~output_model_t();
+    output_model_t(const output_model_t&) = delete;
+    output_model_t(output_model_t&&) noexcept;
+    output_model_t &operator=(const output_model_t&) = delete;
+    output_model_t &operator=(output_model_t&&) noexcept;
+
+    /** \brief Track an output
+     *
+     * The output appears in the snapshots after its first done event.
+     */
+    void add_output(output_t output);
+
+    /** \brief Stop tracking an output and publish a snapshot without it
+     */
+    void remove_output(const output_t &output);
+
+    /** \brief Publish a postponed snapshot
+     *
+     * Must be called by the thread dispatching the outputs.
+     *
+     * \return Whether the current snapshot is up to date, false if every
+     *         older snapshot is still held
+     */
+    bool flush();
+
+    /** \brief Get the current snapshot
+     *
+     * May be called from any thread and is wait-free.
+     */
+    output_snapshot_t get_snapshot() const;
+
+    /** \brief Called after a new snapshot was published
+     */
+    std::function<void()> &on_change();
+  };
+}
+
+#endif
@@ -0,0 +1,146 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WAYLAND_PRESENTATION_QUEUE_HPP
+#define WAYLAND_PRESENTATION_QUEUE_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <ctime>
+#include <functional>
+#include <memory>
+#include <wayland-client-protocol.hpp>
+#include <wayland-client-protocol-staging.hpp>
+#include <wayland-shm-pool.hpp>
+
+namespace wayland
+{
+  namespace detail
+  {
+    struct presentation_queue_data_t;
+  }
+
+  /** \brief Queue of pre-rendered frames with target times
+   *
+   * Presents buffers at given times, e.g. the frames of a video. If the
+   * compositor supports wp_commit_timing_v1, frames are committed right
+   * away with their target time, up to the depth of the queue, and the
+   * compositor applies them on time. With wp_fifo_v1, every commit also
+   * waits for the previous one to be presented, so no frame is skipped.
+   * The client only wakes up when a frame has been presented.
+   *
+   * Otherwise the queue falls back to frame callback pacing: frames are
+   * kept in the client, and after each frame callback the latest frame
+   * that is due is committed. Earlier due frames are dropped. A timer
+   * wakes the client when the next frame becomes due, so its file
+   * descriptor must be polled together with the display, see get_fd() and
+   * dispatch().
+   *
+   * Target times are given in the clock of the presentation timestamps,
+   * see frame_clock_t::get_clock_id().
+   *
+   * \code
+   * presentation_queue_t queue(surface, fifo_manager, commit_timing_manager);
+   * queue.on_ready() = [&] ()
+   * {
+   *   while(!queue.full() && decoder.has_frame())
+   *     queue.queue(decoder.next_buffer(), decoder.next_time());
+   * };
+   * \endcode
+   */
+  class presentation_queue_t
+  {
+  private:
+    std::unique_ptr<detail::presentation_queue_data_t> data;
+
+  public:
+    /** \brief Create a presentation queue
+     *
+     * \param surface Surface the frames are committed to
+     * \param fifo Optional wp_fifo_manager_v1 global
+     * \param timing Optional wp_commit_timing_manager_v1 global
+     * \param depth Maximum number of frames that are queued or not yet presented
+     * \param clock Clock of the target times
+     * \exception std::invalid_argument if the depth is 0
+     * \exception std::system_error if the timer cannot be created
+     */
+    presentation_queue_t(surface_t surface, fifo_manager_v1_t fifo = fifo_manager_v1_t(),
+                         commit_timing_manager_v1_t timing = commit_timing_manager_v1_t(),
+                         std::size_t depth = 3, clockid_t clock = CLOCK_MONOTONIC);
+    ~presentation_queue_t();
+    presentation_queue_t(const presentation_queue_t&) = delete;
+    presentation_queue_t(presentation_queue_t&&) noexcept;
+    presentation_queue_t &operator=(const presentation_queue_t&) = delete;
+    presentation_queue_t &operator=(presentation_queue_t&&) noexcept;
+
+    /** \brief Queue a frame
+     *
+     * The whole buffer is damaged. Frames should be queued in the order of
+     * their target times.
+     *
+     * \param buffer Buffer with the frame. It must not be reused until the
+     *        compositor released it, or until on_discard() is called.
+     * \param target Time at which the frame should be shown
+     * \return false if the queue is full
+     */
+    bool queue(buffer_t buffer, std::chrono::nanoseconds target);
+
+    /** \brief Queue a frame from a shm_buffer_pool_t
+     *
+     * Same as queue(buffer_t, std::chrono::nanoseconds), but dropped frames
+     * are given back to the pool.
+     */
+    bool queue(shm_pool_buffer_t buffer, std::chrono::nanoseconds target);
+
+    /** \brief Drop all frames that are not committed yet */
+    void flush();
+
+    /** \brief Whether no more frames can be queued */
+    bool full() const;
+
+    /** \brief Number of frames that are queued or not yet presented */
+    std::size_t size() const;
+
+    /** \brief Whether frames are committed ahead with target times */
+    bool is_timed() const;
+
+    /** \brief Called when the queue is no longer full */
+    std::function<void()> &on_ready();
+
+    /** \brief Called with the buffer of a frame that was dropped without being committed */
+    std::function<void(buffer_t)> &on_discard();
+
+    /** \brief File descriptor of the timer for frame callback pacing
+     *
+     * When it becomes readable, dispatch() must be called.
+     */
+    int get_fd() const;
+
+    /** \brief Commit the next frame, if it is due */
+    void dispatch();
+  };
+}
+
+#endif
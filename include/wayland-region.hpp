@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WAYLAND_REGION_HPP
+#define WAYLAND_REGION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace wayland
+{
+  /** \brief Axis aligned rectangle
+   *
+   * The rectangle covers [x1, x2) horizontally and [y1, y2) vertically.
+   * Rectangles with x2 <= x1 or y2 <= y1 are empty.
+   */
+  struct rect_t
+  {
+    int32_t x1;
+    int32_t y1;
+    int32_t x2;
+    int32_t y2;
+
+    /** \brief Create a rectangle from position and size, as used by the protocol */
+    static rect_t from_size(int32_t x, int32_t y, int32_t width, int32_t height);
+
+    int32_t width() const;
+    int32_t height() const;
+    bool empty() const;
+    bool contains(int32_t x, int32_t y) const;
+    bool intersects(const rect_t &r) const;
+
+    bool operator==(const rect_t &r) const;
+    bool operator!=(const rect_t &r) const;
+  };
+
+  /** \brief Set of rectangles with region algebra
+   *
+   * The rectangles are kept in y-x banded form: they do not overlap, are
+   * sorted by y and then by x, rectangles in the same horizontal band have
+   * the same height, touching rectangles in a band are merged, and equal
+   * bands that touch vertically are merged. This form is unique, so two
+   * sets covering the same area compare equal.
+   *
+   * Union, intersection and subtraction sweep over the bands of both
+   * operands and take time linear in the number of rectangles. Operations
+   * that touch every rectangle, like translate() and extents(), use SSE2 or
+   * NEON when available.
+   *
+   * The type is shared by the client and the server library. Clients can
+   * use it to build opaque and input regions and to merge damage, see
+   * region_cache_t and damage_accumulator_t. Compositors can use it to
+   * merge the damage of surfaces.
+   */
+  class rect_set_t
+  {
+  private:
+    std::vector<rect_t> rects;
+
+    enum class op_t { unite, intersect, subtract };
+    static rect_set_t combine(const rect_set_t &a, const rect_set_t &b, op_t op);
+
+  public:
+    using const_iterator = std::vector<rect_t>::const_iterator;
+
+    /** \brief Create an empty set */
+    rect_set_t() = default;
+
+    /** \brief Create a set covering a rectangle */
+    rect_set_t(const rect_t &rect);
+
+    /** \brief Create a set covering the union of rectangles
+     *
+     * The rectangles may overlap and do not have to be sorted.
+     */
+    explicit rect_set_t(const std::vector<rect_t> &rects);
+
+    bool empty() const;
+
+    /** \brief Number of rectangles in banded form */
+    std::size_t size() const;
+
+    const_iterator begin() const;
+    const_iterator end() const;
+
+    /** \brief Access the rectangles in banded form */
+    const std::vector<rect_t> &get_rects() const;
+
+    /** \brief Smallest rectangle containing the set
+     *
+     * \return The bounding rectangle, or an empty rectangle for an empty set
+     */
+    rect_t extents() const;
+
+    /** \brief Total area covered by the set */
+    uint64_t area() const;
+
+    bool contains(int32_t x, int32_t y) const;
+    bool intersects(const rect_t &rect) const;
+
+    void clear();
+
+    /** \brief Move all rectangles */
+    void translate(int32_t dx, int32_t dy);
+
+    /** \brief Reduce the number of rectangles
+     *
+     * Replaces the set by a superset with at most \a max_rects rectangles.
+     * Each band is first reduced to its extents, then the neighbouring
+     * bands whose merge adds the least area are merged until the limit is
+     * reached. This is meant for damage, where covering a bit more is
+     * cheaper than sending and processing many small rectangles.
+     *
+     * \param max_rects Maximum number of rectangles, at least 1
+     */
+    void simplify(std::size_t max_rects);
+
+    rect_set_t &operator|=(const rect_set_t &r);
+    rect_set_t &operator&=(const rect_set_t &r);
+    rect_set_t &operator-=(const rect_set_t &r);
+
+    rect_set_t operator|(const rect_set_t &r) const;
+    rect_set_t operator&(const rect_set_t &r) const;
+    rect_set_t operator-(const rect_set_t &r) const;
+
+    bool operator==(const rect_set_t &r) const;
+    bool operator!=(const rect_set_t &r) const;
+
+    /** \brief Hash of the rectangles, e.g. for caches */
+    std::size_t hash() const;
+  };
+}
+
+#endif
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WAYLAND_SERVER_DMABUF_HPP
+#define WAYLAND_SERVER_DMABUF_HPP
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+#include <wayland-server-protocol-extra.hpp>
+
+namespace wayland
+{
+  namespace server
+  {
+    /** \brief Entry of a linux-dmabuf format table
+     *
+     * The layout matches the table sent with
+     * zwp_linux_dmabuf_feedback_v1.format_table.
+     */
+    struct dmabuf_format_t
+    {
+      uint32_t format;
+      uint32_t padding;
+      uint64_t modifier;
+    };
+
+    /** \brief Shared linux-dmabuf v4 format table
+     *
+     * Builds the format/modifier table of the dmabuf feedback once, stores
+     * it in a sealed, immutable memfd and sends the same file to all
+     * feedback objects. Tranches refer to the table by index, which can be
+     * obtained with get_indices().
+     *
+     * \code
+     * dmabuf_format_table_t table({{DRM_FORMAT_XRGB8888, DRM_FORMAT_MOD_LINEAR},
+     *                              {DRM_FORMAT_ARGB8888, DRM_FORMAT_MOD_LINEAR}});
+     * // for every feedback object:
+     * table.send(feedback);
+     * feedback.main_device(dev);
+     * feedback.tranche_target_device(dev);
+     * feedback.tranche_formats(table.get_indices());
+     * feedback.tranche_flags(zwp_linux_dmabuf_feedback_v1_tranche_flags(0));
+     * feedback.tranche_done();
+     * feedback.done();
+     * \endcode
+     *
+     * Copies of this object share the same table.
+     */
+    class dmabuf_format_table_t
+    {
+    private:
+      struct data_t
+      {
+        int fd = -1;
+        std::vector<dmabuf_format_t> formats;
+        std::map<std::pair<uint32_t, uint64_t>, uint16_t> indices;
+        ~data_t();
+      };
+      std::shared_ptr<data_t> data;
+
+    public:
+      /** \brief Build a format table
+       *
+       * \param formats List of (format, modifier) pairs. Duplicates are
+       *                removed, the order is kept otherwise.
+       * \exception std::system_error if the memfd cannot be created or sealed
+       * \exception std::length_error if there are more than 65536 formats
+       */
+      dmabuf_format_table_t(const std::vector<std::pair<uint32_t, uint64_t>> &formats);
+
+      /** \brief Send the table to a feedback object
+       *
+       * Sends the format_table event. The file descriptor is duplicated by
+       * libwayland, so the table can be shared by any number of clients.
+       */
+      void send(zwp_linux_dmabuf_feedback_v1_t &feedback) const;
+
+      /** \brief Get the table index of a format
+       *
+       * \exception std::out_of_range if the format is not in the table
+       */
+      uint16_t get_index(uint32_t format, uint64_t modifier) const;
+
+      /** \brief Index array for the tranche_formats event
+       *
+       * \param formats Subset of the formats in the table
+       * \exception std::out_of_range if a format is not in the table
+       */
+      array_t get_indices(const std::vector<std::pair<uint32_t, uint64_t>> &formats) const;
+
+      /** \brief Index array containing all formats of the table */
+      array_t get_indices() const;
+
+      /** \brief Entries of the table */
+      const std::vector<dmabuf_format_t> &get_formats() const;
+
+      /** \brief Sealed memfd containing the table */
+      int get_fd() const;
+
+      /** \brief Size of the table in bytes */
+      uint32_t get_size() const;
+    };
+  }
+}
+
+#endif
@@ -27,10 +27,12 @@
 #define WAYLAND_SERVER_HPP
 
 #include <atomic>
+#include <cstddef>
 #include <functional>
 #include <list>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <wayland-server-core.h>
 #include <wayland-util.hpp>
@@ -84,6 +86,7 @@ namespace wayland
         std::function<bool(client_t, global_base_t)> filter_func;
         wayland::detail::any user_data;
         std::atomic<unsigned int> counter{1};
+        wayland::memory_resource_t *resource = nullptr;
       };
 
       wl_display *display = nullptr;
@@ -109,6 +112,17 @@ namespace wayland
        */
       display_t();
 
+      /** Create Wayland display object with a memory resource.
+       *
+       * \param resource Memory resource for the bookkeeping data of all
+       *                 clients and resources of this display. It must
+       *                 outlive the display.
+       *
+       * The memory resource can be overridden per client with
+       * client_t::set_memory_resource().
+       */
+      explicit display_t(wayland::memory_resource_t *resource);
+
       /** Destroy Wayland display object.
        *
        * This function emits the wl_display destroy signal, releases
@@ -164,6 +178,24 @@ namespace wayland
        */
       std::string add_socket_auto() const;
 
+      /** Initialize shm for this display
+       *
+       * Creates the wl_shm global, supporting the argb8888 and xrgb8888
+       * formats. Buffers created from it can be accessed with
+       * shm_buffer_t.
+       *
+       * \return 0 on success, -1 on failure
+       */
+      int init_shm() const;
+
+      /** Add an additional shm format
+       *
+       * \param format A value of shm_format
+       *
+       * Must be called before init_shm().
+       */
+      void add_shm_format(uint32_t format) const;
+
       /**  Add a socket with an existing fd to Wayland display for the clients to connect.
        *
        * \param sock_fd The existing socket file descriptor to be used
@@ -210,6 +242,20 @@ namespace wayland
        * new value.
        */
       uint32_t next_serial() const;
+
+      /** Get the memory resource of this display
+       *
+       * This is the new_delete_resource() unless a memory resource was given
+       * on construction.
+       */
+      wayland::memory_resource_t *get_memory_resource() const;
+
+      /** Get the allocation statistics of the display's memory resource
+       *
+       * Clients with their own memory resource are not included.
+       */
+      wayland::memory_stats_t get_memory_stats() const;
+
       std::function<void()> &on_destroy();
 
       /** Registers a listener for the client connection signal.
@@ -286,6 +332,10 @@ namespace wayland
 #endif
         std::function<void(resource_t&)> resource_created;
         detail::listener_t resource_created_listener;
+        // memory resource for the resources of the client
+        wayland::memory_resource_t *resource = nullptr;
+        // memory resource this data was allocated from
+        wayland::memory_resource_t *data_resource = nullptr;
       };
 
       wl_client *client = nullptr;
@@ -399,6 +449,29 @@ namespace wayland
        */
       int get_fd() const;
 
+      /** Set the memory resource for the resources of this client
+       *
+       * \param resource Memory resource for the bookkeeping data of all
+       *                 resources created for this client from now on. It
+       *                 must outlive the client. If nullptr, the memory
+       *                 resource of the display is used.
+       *
+       * This allows per-connection arenas and memory budgets. It should be
+       * called in display_t::on_client_created(), before the client creates
+       * any objects.
+       */
+      void set_memory_resource(wayland::memory_resource_t *resource);
+
+      /** Get the memory resource for the resources of this client */
+      wayland::memory_resource_t *get_memory_resource() const;
+
+      /** Get the allocation statistics of the client's memory resource
+       *
+       * If the client uses the memory resource of the display, the
+       * statistics include all clients sharing it.
+       */
+      wayland::memory_stats_t get_memory_stats() const;
+
       /** Add a callback to be called at the beginning of client destruction.
        *
        * The callback provided will be called when client destroy has begun,
@@ -495,6 +568,137 @@ namespace wayland
       std::function<void(resource_t&)> &on_resource_created();
     };
 
+    /** \brief Kinds of input events that hand out serials
+     *
+     * Several values can be combined to accept any of them in
+     * serial_tracker_t::validate().
+     */
+    struct serial_event_t : public wayland::detail::bitfield<8, -2>
+    {
+      serial_event_t(const wayland::detail::bitfield<8, -2> &b)
+        : wayland::detail::bitfield<8, -2>(b) {}
+      serial_event_t(const uint32_t value)
+        : wayland::detail::bitfield<8, -2>(value) {}
+      static const wayland::detail::bitfield<8, -2> pointer_enter;
+      static const wayland::detail::bitfield<8, -2> pointer_button;
+      static const wayland::detail::bitfield<8, -2> keyboard_enter;
+      static const wayland::detail::bitfield<8, -2> keyboard_key;
+      static const wayland::detail::bitfield<8, -2> touch_down;
+      static const wayland::detail::bitfield<8, -2> tablet_tool_down;
+      static const wayland::detail::bitfield<8, -2> configure;
+      static const wayland::detail::bitfield<8, -2> other;
+    };
+
+    /** \brief Record of a serial that was sent to a client
+     *
+     * The client and seat are only kept for identity comparisons and
+     * must not be dereferenced, as they may have been destroyed since.
+     */
+    struct serial_entry_t
+    {
+      uint32_t serial = 0;
+      uint32_t kind = 0;
+      uint32_t time = 0;
+      const wl_client *client = nullptr;
+      const wl_resource *seat = nullptr;
+    };
+
+    /** \brief Ring buffer of recently sent serials
+     *
+     * Requests like xdg_toplevel.move, wl_data_device.start_drag,
+     * wl_data_device.set_selection or xdg_popup.grab carry the serial of
+     * the input event that triggered them. A compositor has to check that
+     * this serial was actually sent to the requesting client on the right
+     * seat. This class remembers the serials handed out by a display
+     * together with their recipient.
+     *
+     * The ring is allocated once on construction. Recording and looking up
+     * a serial are O(1) and never allocate: the slot of a serial is its
+     * value modulo the (power of two) capacity, so a serial is remembered
+     * until the display has handed out \a capacity newer serials.
+     *
+     * Typical usage:
+     *
+     * \code
+     * serial_tracker_t serials(display);
+     * uint32_t serial = serials.next_serial(client, seat, serial_event_t::pointer_button, time);
+     * pointer.button(serial, time, button, state);
+     * // ...
+     * toplevel.on_move() = [&] (seat_t seat, uint32_t serial)
+     *   {
+     *     if(!serials.validate(serial, toplevel.get_client(), seat, serial_event_t::pointer_button | serial_event_t::touch_down))
+     *       return;
+     *     // ...
+     *   };
+     * \endcode
+     */
+    class serial_tracker_t
+    {
+    private:
+      display_t display;
+      std::vector<serial_entry_t> ring;
+      uint32_t mask = 0;
+
+    public:
+      /** \brief Create a serial tracker
+       *
+       * \param display Display whose serials are tracked
+       * \param capacity Number of slots, rounded up to a power of two
+       */
+      serial_tracker_t(const display_t &display, uint32_t capacity = 256);
+
+      /** \brief Get the next display serial and record it
+       *
+       * \param client Client the serial is sent to
+       * \param seat Seat resource of the event, may be empty
+       * \param kind Kind of the event carrying the serial
+       * \param time Timestamp of the event in milliseconds
+       * \return The new serial, as returned by display_t::next_serial()
+       */
+      uint32_t next_serial(const client_t &client, const resource_t &seat, const serial_event_t &kind, uint32_t time = 0);
+
+      /** \brief Record a serial that was obtained elsewhere
+       *
+       * \param serial The serial sent to the client
+       * \param client Client the serial is sent to
+       * \param seat Seat resource of the event, may be empty
+       * \param kind Kind of the event carrying the serial
+       * \param time Timestamp of the event in milliseconds
+       */
+      void record(uint32_t serial, const client_t &client, const resource_t &seat, const serial_event_t &kind, uint32_t time = 0);
+
+      /** \brief Look up a recorded serial
+       *
+       * \param serial The serial to look up
+       * \param entry Receives the record if the serial is known
+       * \return true if the serial is still in the ring
+       */
+      bool find(uint32_t serial, serial_entry_t &entry) const;
+
+      /** \brief Check a serial received in a request
+       *
+       * \param serial The serial sent by the client
+       * \param client The client that sent the request
+       * \param seat The seat from the request, may be empty to accept any seat
+       * \param kinds Accepted event kinds
+       * \return true if the serial was sent to this client on this seat for
+       *         one of the given event kinds
+       */
+      bool validate(uint32_t serial, const client_t &client, const resource_t &seat, const serial_event_t &kinds) const;
+
+      /** \brief Forget all serials sent to a client
+       *
+       * This is O(capacity) and should be called from client_t::on_destroy()
+       * if wl_client pointers may be reused while their serials are still
+       * in the ring.
+       */
+      void forget(const client_t &client);
+
+      /** \brief Number of slots in the ring
+       */
+      uint32_t capacity() const;
+    };
+
     class resource_t
     {
     protected:
@@ -517,16 +721,21 @@ namespace wayland
         detail::listener_t destroy_listener;
         wayland::detail::any user_data;
         std::atomic<unsigned int> counter{1};
+        wayland::memory_resource_t *resource = nullptr;
+        // user data and dispatcher belong to someone else, e.g. wl_shm buffers
+        bool foreign = false;
       };
 
       wl_resource *resource = nullptr;
       data_t *data = nullptr;
 
       static void destroy_func(wl_listener *listener, void *data);
+      static data_t *wl_resource_get_data(wl_resource *resource);
       static int c_dispatcher(const void *implementation, void *target,
                               uint32_t opcode, const wl_message *message,
                               wl_argument *args);
       static int dummy_dispatcher(int opcode, const std::vector<wayland::detail::any>& args, const std::shared_ptr<resource_t::events_base_t>& events);
+      bool has_events() const;
 
     protected:
       // Interface desctiption filled in by the each interface class
@@ -543,6 +752,15 @@ namespace wayland
       // Retrieve the perviously set user data
       std::shared_ptr<events_base_t> get_events() const;
 
+      // Allocate the event handler storage from the memory resource of the
+      // client and set the dispatcher, unless this was already done.
+      template <typename events_type>
+      void init_events(int(*dispatcher)(int, const std::vector<wayland::detail::any>&, const std::shared_ptr<resource_t::events_base_t>&))
+      {
+        if(!has_events())
+          set_events(std::allocate_shared<events_type>(wayland::detail::allocator_t<events_type>(data->resource)), dispatcher);
+      }
+
       void post_event_array(uint32_t opcode, const std::vector<wayland::detail::argument_t>& v) const;
       void queue_event_array(uint32_t opcode, const std::vector<wayland::detail::argument_t>& v) const;
 
@@ -642,6 +860,187 @@ namespace wayland
       std::function<void()> &on_destroy();
     };
 
+    /** \brief Read-only, strided view of pixels in shared memory
+     *
+     * \tparam T Pixel type, e.g. uint32_t for 32 bit formats
+     *
+     * The view does not own the memory. It stays valid as long as the
+     * shm_buffer_t it was obtained from holds a reference to the pool or
+     * the wl_buffer is alive.
+     */
+    template <typename T = uint8_t>
+    class shm_span_t
+    {
+    private:
+      const uint8_t *base = nullptr;
+      int32_t width = 0;
+      int32_t height = 0;
+      int32_t stride = 0;
+
+    public:
+      shm_span_t() = default;
+      shm_span_t(const void *data, int32_t width, int32_t height, int32_t stride)
+        : base(static_cast<const uint8_t*>(data)), width(width), height(height), stride(stride)
+      {
+      }
+
+      /** Pointer to the first pixel of row \a y */
+      const T *row(int32_t y) const
+      {
+        return reinterpret_cast<const T*>(base + static_cast<std::ptrdiff_t>(y) * stride);
+      }
+
+      /** Pixel at column \a x and row \a y */
+      const T &operator()(int32_t x, int32_t y) const
+      {
+        return row(y)[x];
+      }
+
+      const T *data() const
+      {
+        return reinterpret_cast<const T*>(base);
+      }
+
+      int32_t get_width() const
+      {
+        return width;
+      }
+
+      int32_t get_height() const
+      {
+        return height;
+      }
+
+      /** Distance between two rows in bytes */
+      int32_t get_stride() const
+      {
+        return stride;
+      }
+
+      /** Size of the pixel data in bytes */
+      std::size_t size_bytes() const
+      {
+        return static_cast<std::size_t>(stride) * static_cast<std::size_t>(height);
+      }
+
+      bool empty() const
+      {
+        return base == nullptr || width == 0 || height == 0;
+      }
+    };
+
+    /** \brief Access to the contents of a wl_shm buffer
+     *
+     * Wraps the wl_shm_buffer behind a wl_buffer resource that was created
+     * from the wl_shm global of display_t::init_shm(). The buffer memory is
+     * accessed in place, without copying:
+     *
+     * \code
+     * shm_buffer_t shm(buffer);
+     * if(shm && shm.get_format() == static_cast<uint32_t>(shm_format::argb8888))
+     *   {
+     *     shm_buffer_t::access_t access = shm.begin_access();
+     *     shm_span_t<uint32_t> pixels = shm.get_pixels<uint32_t>();
+     *     // read pixels(x, y)
+     *   }
+     * \endcode
+     *
+     * A client can truncate the underlying file at any time. Reads must
+     * therefore be wrapped in an access_t, which makes libwayland catch the
+     * SIGBUS and replace the mapping with zeros instead of crashing.
+     *
+     * After ref_pool() the shm_buffer_t keeps the pool and its mapping
+     * alive, even when the wl_buffer is released or destroyed. This allows
+     * to upload or blend the pixels later. Note that begin_access() needs
+     * the wl_buffer and must not be used after it has been destroyed.
+     */
+    class shm_buffer_t
+    {
+    private:
+      wl_shm_buffer *buffer = nullptr;
+      std::shared_ptr<wl_shm_pool> pool;
+      const void *data = nullptr;
+      uint32_t format = 0;
+      int32_t width = 0;
+      int32_t height = 0;
+      int32_t stride = 0;
+
+    public:
+      /** \brief RAII guard for reading the buffer memory
+       *
+       * Calls wl_shm_buffer_begin_access() on construction and
+       * wl_shm_buffer_end_access() on destruction. Guards can be nested,
+       * but must be destroyed in the thread that created them.
+       */
+      class access_t
+      {
+      private:
+        wl_shm_buffer *buffer = nullptr;
+
+      public:
+        access_t() = default;
+        explicit access_t(wl_shm_buffer *buffer);
+        access_t(const access_t&) = delete;
+        access_t(access_t&& a) noexcept;
+        access_t &operator=(const access_t&) = delete;
+        access_t &operator=(access_t&& a) noexcept;
+        ~access_t();
+      };
+
+      shm_buffer_t() = default;
+
+      /** \brief Get the shm buffer of a wl_buffer resource
+       *
+       * If the resource is no shm buffer, the resulting object is empty.
+       */
+      shm_buffer_t(const resource_t &buffer);
+
+      /** Check whether a wl_buffer resource is backed by shared memory */
+      static bool is_shm_buffer(const resource_t &buffer);
+
+      /** Check whether this object refers to a buffer */
+      operator bool() const;
+
+      /** Pixel format, compare with the values of shm_format */
+      uint32_t get_format() const;
+      int32_t get_width() const;
+      int32_t get_height() const;
+
+      /** Distance between two rows in bytes */
+      int32_t get_stride() const;
+
+      /** Size of the pixel data in bytes */
+      std::size_t get_size() const;
+
+      /** \brief Keep the pool mapping alive
+       *
+       * Takes a reference on the wl_shm_pool of the buffer. While it is
+       * held, the pool is neither unmapped nor remapped by
+       * wl_shm_pool.resize, so get_data() and get_pixels() stay valid after
+       * the wl_buffer has been released. The reference is dropped when the
+       * last copy of this object is destroyed.
+       */
+      void ref_pool();
+
+      /** Check whether this object holds a pool reference */
+      bool has_pool_ref() const;
+
+      /** Start reading the buffer memory */
+      access_t begin_access() const;
+
+      /** Pointer to the first byte of the pixel data */
+      const void *get_data() const;
+
+      /** Typed, strided view of the pixel data */
+      template <typename T = uint8_t>
+      shm_span_t<T> get_pixels() const
+      {
+        return shm_span_t<T>(get_data(), width, height, stride);
+      }
+
+      wl_shm_buffer *c_ptr() const;
+    };
+
     /** Global object base class */
     class global_base_t
     {
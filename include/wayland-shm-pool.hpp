@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WAYLAND_SHM_POOL_HPP
+#define WAYLAND_SHM_POOL_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <wayland-client-protocol.hpp>
+
+namespace wayland
+{
+  namespace detail
+  {
+    struct shm_pool_data_t;
+    struct shm_pool_record_t;
+  }
+
+  /** \brief Bytes per pixel of an shm format
+   *
+   * \return The number of bytes per pixel, or 0 for formats with
+   *         subsampling or multiple planes
+   */
+  unsigned int shm_format_bytes_per_pixel(shm_format format);
+
+  /** \brief Kind of memory backing a shm_buffer_pool_t */
+  enum class shm_pool_pages
+  {
+    /** Regular pages */
+    normal,
+    /** Regular memfd whose mapping is advised to use transparent huge pages */
+    transparent_huge,
+    /** memfd on hugetlbfs (MFD_HUGETLB), needs reserved huge pages */
+    huge
+  };
+
+  /** \brief Options for the memory of a shm_buffer_pool_t
+   *
+   * Large buffers, e.g. for 4K or 8K surfaces, cause a lot of TLB misses
+   * when they are mapped with 4 KiB pages, both in the client and in the
+   * compositor. Huge pages reduce this considerably.
+   */
+  struct shm_pool_options_t
+  {
+    /** \brief Requested kind of pages
+     *
+     * If huge pages cannot be used, the pool falls back to transparent
+     * huge pages and then to regular pages. The kind of pages that is
+     * actually used is reported by shm_buffer_pool_t::get_pages().
+     */
+    shm_pool_pages pages = shm_pool_pages::normal;
+
+    /** \brief Seal the memfd against shrinking
+     *
+     * Adds F_SEAL_SHRINK to the memfd. The pool only ever grows, and a
+     * compositor that sees the seal knows that accesses to the buffers
+     * cannot cause SIGBUS.
+     */
+    bool seal = true;
+  };
+
+  /** \brief Buffer handed out by shm_buffer_pool_t
+   *
+   * A handle to a buffer sub-allocated from a shm_buffer_pool_t. The pool
+   * reuses the buffer once the compositor has released it and all handles
+   * to it are gone.
+   */
+  class shm_pool_buffer_t
+  {
+  private:
+    std::shared_ptr<detail::shm_pool_data_t> pool;
+    std::shared_ptr<detail::shm_pool_record_t> record;
+
+    shm_pool_buffer_t(std::shared_ptr<detail::shm_pool_data_t> pool,
+                      std::shared_ptr<detail::shm_pool_record_t> record);
+    friend class shm_buffer_pool_t;
+
+  public:
+    shm_pool_buffer_t() = default;
+
+    /** \brief Check whether this handle refers to a buffer */
+    operator bool() const;
+
+    /** \brief The wl_buffer to attach to a surface
+     *
+     * The on_release() event is used by the pool and must not be
+     * overwritten.
+     */
+    buffer_t &get_buffer() const;
+
+    /** \brief Pointer to the first pixel
+     *
+     * The pointer changes when the pool grows, so it should not be kept
+     * across calls to shm_buffer_pool_t::acquire().
+     */
+    void *get_data() const;
+
+    int32_t get_width() const;
+    int32_t get_height() const;
+    int32_t get_stride() const;
+    shm_format get_format() const;
+
+    /** \brief Size of the pixel data in bytes */
+    std::size_t get_size() const;
+
+    /** \brief Check whether the buffer is acquired or used by the compositor */
+    bool is_busy() const;
+
+    /** \brief Give back an acquired buffer that was not attached
+     *
+     * Buffers that were attached to a surface become available again when
+     * the compositor sends wl_buffer.release. Buffers that were acquired
+     * but never attached must be returned with this function.
+     */
+    void discard();
+  };
+
+  /** \brief Pool of shm buffers
+   *
+   * Sub-allocates buffers from a single memfd-backed wl_shm_pool. Free
+   * space is managed with a free list. If no block fits, the file and the
+   * wl_shm_pool are grown, and the mapping is moved with mremap.
+   *
+   * acquire() hands out a buffer that is not in use by the compositor.
+   * Released buffers of the same size are reused directly. After a resize,
+   * released buffers whose memory block is large enough get a new wl_buffer
+   * at the same offset, so neither the file nor the mapping change. At most
+   * \a max_buffers buffers exist at a time, e.g. 2 for double buffering.
+   *
+   * \code
+   * shm_buffer_pool_t pool(shm, 2);
+   * // on every frame:
+   * shm_pool_buffer_t buffer = pool.acquire(width, height);
+   * if(!buffer)
+   *   return; // all buffers are busy, wait for the next frame
+   * draw(buffer.get_data(), buffer.get_stride());
+   * surface.attach(buffer.get_buffer(), 0, 0);
+   * surface.damage_buffer(0, 0, width, height);
+   * surface.commit();
+   * \endcode
+   *
+   * The pool is not thread safe. Its buffers must be dispatched on the
+   * queue of the thread using the pool.
+   *
+   * The size of the pool is always a multiple of the page size reported by
+   * get_page_size(). With huge pages, that is usually 2 MiB.
+   */
+  class shm_buffer_pool_t
+  {
+  private:
+    std::shared_ptr<detail::shm_pool_data_t> data;
+
+  public:
+    /** \brief Create a buffer pool
+     *
+     * \param shm The wl_shm global
+     * \param max_buffers Maximum number of buffers in the pool
+     * \param initial_size Initial size of the pool in bytes
+     * \param options Kind of memory used for the pool
+     * \exception std::system_error if the shared memory cannot be created
+     */
+    shm_buffer_pool_t(shm_t &shm, unsigned int max_buffers = 2, std::size_t initial_size = 0,
+                      const shm_pool_options_t &options = shm_pool_options_t());
+
+    /** \brief Get a buffer that is not in use
+     *
+     * \param width Width in pixels
+     * \param height Height in pixels
+     * \param format Pixel format
+     * \param stride Distance between two rows in bytes. If 0, the rows are
+     *               packed.
+     * \return A buffer, or an empty handle if all buffers are busy
+     * \exception std::invalid_argument if the dimensions or the format are
+     *            not supported
+     * \exception std::system_error if the pool cannot be grown, e.g. if
+     *            there are not enough reserved huge pages left
+     */
+    shm_pool_buffer_t acquire(int32_t width, int32_t height, shm_format format = shm_format::argb8888, int32_t stride = 0);
+
+    /** \brief Destroy all buffers that are not busy
+     *
+     * The memory stays mapped and is reused by later buffers.
+     */
+    void trim();
+
+    /** \brief Size of the pool in bytes */
+    std::size_t get_size() const;
+
+    /** \brief Kind of pages actually backing the pool */
+    shm_pool_pages get_pages() const;
+
+    /** \brief Granularity of the pool size in bytes */
+    std::size_t get_page_size() const;
+
+    /** \brief Check whether the memfd is sealed against shrinking */
+    bool is_sealed() const;
+
+    /** \brief Number of buffers in the pool */
+    unsigned int get_buffer_count() const;
+
+    /** \brief Number of buffers that are acquired or used by the compositor */
+    unsigned int get_busy_count() const;
+  };
+}
+
+#endif
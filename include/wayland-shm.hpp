@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WAYLAND_SHM_HPP
+#define WAYLAND_SHM_HPP
+
+#include <cstdint>
+
+namespace wayland
+{
+  /** \brief Instruction set used by the pixel kernels */
+  enum class shm_isa
+  {
+    scalar,
+    sse2,
+    avx2,
+    neon
+  };
+
+  /** \brief Pixel data in a wl_shm format
+   *
+   * Describes a buffer in shared memory, e.g. the data of a
+   * shm_pool_buffer_t on the client side or of a server::shm_buffer_t in a
+   * compositor. A part of a buffer can be described by pointing \a data to
+   * the first pixel of the part and keeping the stride.
+   */
+  struct shm_image_t
+  {
+    /** Pointer to the first pixel */
+    void *data;
+    int32_t width;
+    int32_t height;
+    /** Distance between two rows in bytes */
+    int32_t stride;
+    /** Value of wl_shm.format, e.g. static_cast<uint32_t>(shm_format::argb8888) */
+    uint32_t format;
+  };
+
+  /** \brief Check whether the pixel functions support a format
+   *
+   * All packed RGB formats of wl_shm.format with 8 to 64 bits per pixel
+   * are supported, i.e. the 332, 565, 888, 4444, 1555, 8888, 2101010 and
+   * 16161616 families. YUV, indexed, single channel and floating point
+   * formats are not.
+   */
+  bool shm_format_supported(uint32_t format);
+
+  /** \brief Check whether a supported format has an alpha channel */
+  bool shm_format_has_alpha(uint32_t format);
+
+  /** \brief Instruction set currently used by the kernels
+   *
+   * On first use, the best instruction set supported by the CPU is chosen:
+   * AVX2 or SSE2 on x86, NEON on AArch64.
+   */
+  shm_isa shm_get_isa();
+
+  /** \brief Check whether the CPU supports an instruction set */
+  bool shm_isa_supported(shm_isa isa);
+
+  /** \brief Force an instruction set, e.g. for testing and benchmarks
+   *
+   * \return false if the instruction set is not supported by the CPU
+   */
+  bool shm_set_isa(shm_isa isa);
+
+  /** \brief Fill a rectangle with a color
+   *
+   * The rectangle is clipped to the image.
+   *
+   * \param dst Image to fill
+   * \param x,y,width,height Rectangle to fill
+   * \param color Color as an argb8888 pixel, converted to the format of the
+   *              image
+   * \exception std::invalid_argument if the format is not supported
+   */
+  void shm_fill_rect(const shm_image_t &dst, int32_t x, int32_t y, int32_t width, int32_t height, uint32_t color);
+
+  /** \brief Copy a rectangle between images, converting the format
+   *
+   * The rectangle is clipped to both images. If the formats are equal, the
+   * rows are copied with memmove, so source and destination may overlap.
+   * Otherwise, they must not overlap. Conversions between the 8888
+   * formats, and between them and the 565 formats, use SIMD kernels. All
+   * other conversions go through 16 bits per channel, so no precision is
+   * lost between 10 bit formats.
+   *
+   * \exception std::invalid_argument if a format is not supported
+   */
+  void shm_blit(const shm_image_t &dst, int32_t dst_x, int32_t dst_y,
+                const shm_image_t &src, int32_t src_x, int32_t src_y,
+                int32_t width, int32_t height);
+
+  /** \brief Convert a whole image
+   *
+   * Same as shm_blit() for the common size of both images.
+   */
+  void shm_convert(const shm_image_t &dst, const shm_image_t &src);
+
+  /** \brief Multiply the color channels by alpha
+   *
+   * wl_shm buffers are expected to be premultiplied. Images without alpha
+   * channel are left unchanged.
+   *
+   * \exception std::invalid_argument if the format is not supported
+   */
+  void shm_premultiply(const shm_image_t &image);
+
+  /** \brief Divide the color channels by alpha
+   *
+   * Pixels with an alpha of 0 become fully transparent black. Images
+   * without alpha channel are left unchanged.
+   *
+   * \exception std::invalid_argument if the format is not supported
+   */
+  void shm_unpremultiply(const shm_image_t &image);
+}
+
+#endif
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WAYLAND_SOLID_SURFACE_HPP
+#define WAYLAND_SOLID_SURFACE_HPP
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <wayland-client-protocol.hpp>
+#include <wayland-client-protocol-extra.hpp>
+#include <wayland-client-protocol-staging.hpp>
+#include <wayland-shm-pool.hpp>
+
+namespace wayland
+{
+  /** \brief Cache of single pixel buffers
+   *
+   * Hands out one buffer per colour, which can be attached to any number
+   * of surfaces and scaled to any size with a viewport. The buffers are
+   * created with wp_single_pixel_buffer_manager_v1, which needs no memory
+   * at all. If the compositor does not support it, 1x1 shm buffers are used
+   * instead.
+   *
+   * Colours are given as non-premultiplied ARGB, e.g. 0x80000000 for a
+   * half transparent black.
+   */
+  class solid_buffer_cache_t
+  {
+  private:
+    struct entry_t
+    {
+      buffer_t buffer;
+      shm_pool_buffer_t shm_buffer;
+    };
+
+    single_pixel_buffer_manager_v1_t manager;
+    std::unique_ptr<shm_buffer_pool_t> pool;
+    std::map<uint32_t, entry_t> buffers;
+
+  public:
+    /** \brief Create a buffer cache
+     *
+     * \param manager Optional wp_single_pixel_buffer_manager_v1 global
+     * \param shm wl_shm global for the fallback, may be empty if the
+     *        manager is given
+     * \exception std::invalid_argument if neither global is given
+     */
+    solid_buffer_cache_t(single_pixel_buffer_manager_v1_t manager, shm_t shm = shm_t());
+
+    /** \brief Get the buffer of a colour
+     *
+     * The buffer is created on first use and kept until clear() is called.
+     */
+    buffer_t get(uint32_t color);
+
+    /** \brief Destroy all buffers
+     *
+     * The buffers must not be attached to any surface anymore.
+     */
+    void clear();
+
+    /** \brief Number of cached colours */
+    std::size_t size() const;
+  };
+
+  /** \brief Surface showing a solid colour
+   *
+   * Attaches a buffer of a solid_buffer_cache_t and scales it with a
+   * viewport, so that a surface of any size costs no pixel memory.
+   * Useful for backgrounds, letterboxing, dim overlays and placeholders.
+   *
+   * \code
+   * solid_buffer_cache_t cache(single_pixel_buffer_manager, shm);
+   * solid_surface_t background(surface, viewporter, cache);
+   * background.set(0xff202020, width, height);
+   * surface.commit();
+   * \endcode
+   */
+  class solid_surface_t
+  {
+  private:
+    surface_t surface;
+    viewport_t viewport;
+    solid_buffer_cache_t *cache = nullptr;
+    buffer_t buffer;
+    int32_t width = 0;
+    int32_t height = 0;
+
+  public:
+    /** \brief Create a solid colour surface
+     *
+     * \param surface Surface to fill. Its buffer scale must be 1.
+     * \param viewporter wp_viewporter global
+     * \param cache Cache of the buffers, which must outlive the surface
+     * \exception std::invalid_argument if the viewporter is empty
+     */
+    solid_surface_t(surface_t surface, viewporter_t viewporter, solid_buffer_cache_t &cache);
+
+    /** \brief Set colour and size
+     *
+     * Only changed state is sent. The surface must be committed afterwards.
+     *
+     * \param color Non-premultiplied ARGB colour
+     * \param width Width in surface coordinates
+     * \param height Height in surface coordinates
+     * \exception std::invalid_argument if the size is not positive
+     */
+    void set(uint32_t color, int32_t width, int32_t height);
+
+    /** \brief The filled surface */
+    surface_t get_surface() const;
+  };
+}
+
+#endif
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WAYLAND_SURFACE_SCALE_HPP
+#define WAYLAND_SURFACE_SCALE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <wayland-client-protocol.hpp>
+#include <wayland-client-protocol-extra.hpp>
+#include <wayland-client-protocol-staging.hpp>
+#include <wayland-shm-pool.hpp>
+
+namespace wayland
+{
+  namespace detail
+  {
+    struct surface_scale_data_t;
+  }
+
+  /** \brief Buffer size of a surface at fractional scales
+   *
+   * Computes the size of the buffers of a surface from its logical size
+   * and the scale preferred by the compositor. With wp_fractional_scale_v1
+   * and wp_viewporter, buffers are rendered at exactly the preferred scale,
+   * e.g. 1.5, and the viewport maps them to the logical size. Without
+   * wp_fractional_scale_v1, the integer scale given with
+   * set_integer_scale() is used, e.g. from wl_surface.preferred_buffer_scale.
+   * Without wp_viewporter, the integer scale is rounded up and set as the
+   * buffer scale of the surface.
+   *
+   * on_buffer_size() is called only when the buffer size in pixels
+   * actually changes, which is the time to reallocate buffers:
+   *
+   * \code
+   * surface_scale_t scale(surface, viewporter, fractional_scale_manager);
+   * scale.on_buffer_size() = [&] (int32_t width, int32_t height)
+   * {
+   *   egl_window.resize(width, height);
+   * };
+   * // in the configure handler:
+   * scale.set_logical_size(width, height);
+   * // for every frame:
+   * scale.apply();
+   * draw();
+   * surface.commit();
+   * \endcode
+   *
+   * With shm buffers, acquire_buffer() gets a buffer of the right size from
+   * a shm_buffer_pool_t.
+   */
+  class surface_scale_t
+  {
+  private:
+    std::unique_ptr<detail::surface_scale_data_t> data;
+
+  public:
+    /** \brief Create a scaling helper for a surface
+     *
+     * \param surface Surface whose buffers are scaled
+     * \param viewporter Optional wp_viewporter global
+     * \param manager Optional wp_fractional_scale_manager_v1 global. It is
+     *        only used together with a viewporter.
+     */
+    surface_scale_t(surface_t surface, viewporter_t viewporter = viewporter_t(),
+                    fractional_scale_manager_v1_t manager = fractional_scale_manager_v1_t());
+    ~surface_scale_t();
+    surface_scale_t(const surface_scale_t&) = delete;
+    surface_scale_t(surface_scale_t&&) noexcept;
+    surface_scale_t &operator=(const surface_scale_t&) = delete;
+    surface_scale_t &operator=(surface_scale_t&&) noexcept;
+
+    /** \brief Set the size of the surface in surface coordinates
+     *
+     * \exception std::invalid_argument if the size is negative
+     */
+    void set_logical_size(int32_t width, int32_t height);
+
+    /** \brief Set the integer scale
+     *
+     * Used as long as the compositor did not send a fractional scale.
+     *
+     * \exception std::invalid_argument if the scale is not positive
+     */
+    void set_integer_scale(int32_t scale);
+
+    /** \brief Called with the new buffer size when it changes */
+    std::function<void(int32_t, int32_t)> &on_buffer_size();
+
+    /** \brief Set the viewport or buffer scale for the next commit
+     *
+     * Must be called before a buffer of the current buffer size is
+     * committed. Only changed state is sent.
+     */
+    void apply();
+
+    /** \brief Get a buffer of the current buffer size from a pool
+     *
+     * \return A buffer, or an empty handle if all buffers are busy
+     */
+    shm_pool_buffer_t acquire_buffer(shm_buffer_pool_t &pool, shm_format format = shm_format::argb8888);
+
+    /** \brief Current scale */
+    double get_scale() const;
+
+    /** \brief Whether the scale is exact rather than rounded up to an integer */
+    bool is_fractional() const;
+
+    int32_t get_logical_width() const;
+    int32_t get_logical_height() const;
+    int32_t get_buffer_width() const;
+    int32_t get_buffer_height() const;
+  };
+}
+
+#endif
@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WAYLAND_TABLET_FRAME_HPP
+#define WAYLAND_TABLET_FRAME_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <wayland-client-protocol-extra.hpp>
+
+namespace wayland
+{
+  namespace detail
+  {
+    struct tablet_tool_aggregator_data_t;
+  }
+
+  /** \brief Button event of a tablet tool frame
+   */
+  struct tablet_tool_button_event_t
+  {
+    uint32_t serial;
+    uint32_t button;
+    zwp_tablet_tool_v2_button_state state;
+  };
+
+  /** \brief Events of a zwp_tablet_tool_v2 frame
+   *
+   * Plain struct holding everything a tablet tool sent up to a frame event.
+   * The bits in valid tell which events were sent. The axis fields always
+   * hold the current state of the tool, except for the wheel, whose
+   * movement within the frame is summed up.
+   */
+  struct tablet_tool_frame_t
+  {
+    /** \brief Maximum number of button events in one frame */
+    static const uint32_t max_buttons = 4;
+
+    /** \brief Validity bits of the fields */
+    enum : uint32_t
+    {
+      has_proximity_in = 1u << 0,
+      has_proximity_out = 1u << 1,
+      has_down = 1u << 2,
+      has_up = 1u << 3,
+      has_motion = 1u << 4,
+      has_pressure = 1u << 5,
+      has_distance = 1u << 6,
+      has_tilt = 1u << 7,
+      has_rotation = 1u << 8,
+      has_slider = 1u << 9,
+      has_wheel = 1u << 10,
+      has_button = 1u << 11
+    };
+
+    uint32_t valid;
+    /** \brief Timestamp of the frame */
+    uint32_t time;
+    /** \brief Serial of the proximity_in or down event */
+    uint32_t serial;
+    /** \brief Surface-local position */
+    double x;
+    double y;
+    uint32_t pressure;
+    uint32_t distance;
+    double tilt_x;
+    double tilt_y;
+    double rotation;
+    int32_t slider;
+    double wheel;
+    int32_t wheel_clicks;
+    uint32_t button_count;
+    tablet_tool_button_event_t buttons[max_buttons];
+  };
+
+  /** \brief Frame-grouped events of a zwp_tablet_tool_v2
+   *
+   * Takes over the proximity, axis and button event handlers of the tool
+   * and passes all events up to the next frame event to a single callback
+   * as a tablet_tool_frame_t. The handlers describing the tool, e.g.
+   * on_type() or on_capability(), are left alone. If a frame holds more
+   * than tablet_tool_frame_t::max_buttons button events, it is split.
+   */
+  class tablet_tool_aggregator_t
+  {
+  private:
+    std::unique_ptr<detail::tablet_tool_aggregator_data_t> data;
+
+  public:
+    /** \brief Aggregate the events of a tablet tool
+     *
+     * \param tool Tablet tool whose event handlers are replaced
+     */
+    tablet_tool_aggregator_t(zwp_tablet_tool_v2_t tool);
+    ~tablet_tool_aggregator_t();
+    tablet_tool_aggregator_t(const tablet_tool_aggregator_t&) = delete;
+    tablet_tool_aggregator_t(tablet_tool_aggregator_t&&) noexcept;
+    tablet_tool_aggregator_t &operator=(const tablet_tool_aggregator_t&) = delete;
+    tablet_tool_aggregator_t &operator=(tablet_tool_aggregator_t&&) noexcept;
+
+    /** \brief Called once per frame
+     */
+    std::function<void(const tablet_tool_frame_t&)> &on_frame();
+
+    /** \brief Surface the tool is in proximity of, or an empty surface
+     *
+     * During on_frame() with has_proximity_out set, this is still the
+     * surface the tool has left.
+     */
+    surface_t get_focus() const;
+
+    /** \brief Tablet the tool is in proximity of, or an empty tablet
+     */
+    zwp_tablet_v2_t get_tablet() const;
+  };
+}
+
+#endif
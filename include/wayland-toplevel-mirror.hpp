@@ -0,0 +1,226 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WAYLAND_TOPLEVEL_MIRROR_HPP
+#define WAYLAND_TOPLEVEL_MIRROR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include <wayland-client-protocol.hpp>
+#include <wayland-client-protocol-staging.hpp>
+
+namespace wayland
+{
+  namespace detail
+  {
+    struct toplevel_mirror_data_t;
+    struct workspace_mirror_data_t;
+  }
+
+  /** \brief Modified fields of an entry of a mirror */
+  struct mirror_change_t
+  {
+    uint32_t key;
+    /** Bit mask of the modified fields */
+    uint32_t fields;
+  };
+
+  /** \brief Changes of a mirror table since the last change set
+   *
+   * Entries are identified by their key. An entry that was added and
+   * modified is only listed as added, and an entry that was added and
+   * removed again is not listed at all.
+   */
+  struct mirror_changes_t
+  {
+    std::vector<uint32_t> added;
+    std::vector<uint32_t> removed;
+    std::vector<mirror_change_t> modified;
+
+    /** \brief Whether there are no changes */
+    bool empty() const;
+  };
+
+  /** \brief Flat mirror of ext_foreign_toplevel_list_v1
+   *
+   * Keeps the toplevels in a table with one array per field, so a list can
+   * be drawn by walking the arrays. The events of a toplevel are applied
+   * with its done event, and rows are only added on the first one. Removed
+   * rows are replaced by the last row, so the arrays stay dense, and rows
+   * are identified by a key that stays the same for the lifetime of a
+   * toplevel.
+   *
+   * The list has no event that ends a batch of changes to several
+   * toplevels. Changes are therefore collected until flush() is called,
+   * e.g. once after dispatching the display, which passes them to
+   * on_changes() as a single change set.
+   *
+   * \code
+   * toplevel_mirror_t toplevels(foreign_toplevel_list);
+   * toplevels.on_changes() = [&] (const mirror_changes_t &changes)
+   * {
+   *   for(const mirror_change_t &change : changes.modified)
+   *     if(change.fields & toplevel_mirror_t::field_title)
+   *       redraw_title(toplevels.find(change.key));
+   * };
+   * while(display.dispatch() != -1)
+   *   toplevels.flush();
+   * \endcode
+   */
+  class toplevel_mirror_t
+  {
+  private:
+    std::unique_ptr<detail::toplevel_mirror_data_t> data;
+
+  public:
+    /** \brief Fields of a toplevel */
+    enum : uint32_t
+    {
+      field_title = 1u << 0,
+      field_app_id = 1u << 1,
+      field_identifier = 1u << 2
+    };
+
+    /** \brief Value of find() for unknown keys */
+    static const std::size_t npos = static_cast<std::size_t>(-1);
+
+    /** \brief Mirror the toplevels of a list
+     *
+     * \param list ext_foreign_toplevel_list_v1 global
+     */
+    toplevel_mirror_t(ext_foreign_toplevel_list_v1_t list);
+    ~toplevel_mirror_t();
+    toplevel_mirror_t(const toplevel_mirror_t&) = delete;
+    toplevel_mirror_t(toplevel_mirror_t&&) noexcept;
+    toplevel_mirror_t &operator=(const toplevel_mirror_t&) = delete;
+    toplevel_mirror_t &operator=(toplevel_mirror_t&&) noexcept;
+
+    /** \brief Number of rows */
+    std::size_t size() const;
+
+    /** \brief Row of a key, or npos */
+    std::size_t find(uint32_t key) const;
+
+    /** \brief Columns of the table, indexed by row */
+    const std::vector<uint32_t> &keys() const;
+    const std::vector<ext_foreign_toplevel_handle_v1_t> &handles() const;
+    const std::vector<std::string> &titles() const;
+    const std::vector<std::string> &app_ids() const;
+    const std::vector<std::string> &identifiers() const;
+
+    /** \brief Pass the changes collected so far to on_changes() */
+    void flush();
+
+    /** \brief Called by flush() if there are changes */
+    std::function<void(const mirror_changes_t&)> &on_changes();
+  };
+
+  /** \brief Flat mirror of ext_workspace_manager_v1
+   *
+   * Keeps the workspaces and the workspace groups in tables with one array
+   * per field, like toplevel_mirror_t. Changes are applied with the done
+   * event of the manager, which then calls on_changes() with the change
+   * sets of both tables.
+   */
+  class workspace_mirror_t
+  {
+  private:
+    std::unique_ptr<detail::workspace_mirror_data_t> data;
+
+  public:
+    /** \brief Fields of a workspace */
+    enum : uint32_t
+    {
+      field_id = 1u << 0,
+      field_name = 1u << 1,
+      field_coordinates = 1u << 2,
+      field_state = 1u << 3,
+      field_capabilities = 1u << 4,
+      field_group = 1u << 5
+    };
+
+    /** \brief Fields of a workspace group */
+    enum : uint32_t
+    {
+      group_field_capabilities = 1u << 0,
+      group_field_outputs = 1u << 1
+    };
+
+    /** \brief Value of find() for unknown keys */
+    static const std::size_t npos = static_cast<std::size_t>(-1);
+
+    /** \brief Mirror the workspaces of a manager
+     *
+     * \param manager ext_workspace_manager_v1 global
+     */
+    workspace_mirror_t(ext_workspace_manager_v1_t manager);
+    ~workspace_mirror_t();
+    workspace_mirror_t(const workspace_mirror_t&) = delete;
+    workspace_mirror_t(workspace_mirror_t&&) noexcept;
+    workspace_mirror_t &operator=(const workspace_mirror_t&) = delete;
+    workspace_mirror_t &operator=(workspace_mirror_t&&) noexcept;
+
+    /** \brief Number of workspace rows */
+    std::size_t size() const;
+
+    /** \brief Workspace row of a key, or npos */
+    std::size_t find(uint32_t key) const;
+
+    /** \brief Workspace columns, indexed by row */
+    const std::vector<uint32_t> &keys() const;
+    const std::vector<ext_workspace_handle_v1_t> &handles() const;
+    const std::vector<std::string> &ids() const;
+    const std::vector<std::string> &names() const;
+    const std::vector<std::vector<uint32_t>> &coordinates() const;
+    /** ext_workspace_handle_v1_state bits */
+    const std::vector<uint32_t> &states() const;
+    /** ext_workspace_handle_v1_workspace_capabilities bits */
+    const std::vector<uint32_t> &capabilities() const;
+    /** Key of the group of each workspace, 0 if it has none */
+    const std::vector<uint32_t> &groups() const;
+
+    /** \brief Number of group rows */
+    std::size_t group_count() const;
+
+    /** \brief Group row of a key, or npos */
+    std::size_t find_group(uint32_t key) const;
+
+    /** \brief Group columns, indexed by group row */
+    const std::vector<uint32_t> &group_keys() const;
+    const std::vector<ext_workspace_group_handle_v1_t> &group_handles() const;
+    /** ext_workspace_group_handle_v1_group_capabilities bits */
+    const std::vector<uint32_t> &group_capabilities() const;
+    const std::vector<std::vector<output_t>> &group_outputs() const;
+
+    /** \brief Called after a done event with the workspace and group changes */
+    std::function<void(const mirror_changes_t&, const mirror_changes_t&)> &on_changes();
+  };
+}
+
+#endif
@@ -27,7 +27,10 @@
 #define WAYLAND_UTIL_HPP
 
 #include <algorithm>
+#include <atomic>
+#include <cstddef>
 #include <memory>
+#include <new>
 #include <stdexcept>
 #include <string>
 #include <typeinfo>
@@ -52,8 +55,142 @@ namespace wayland
     class resource_t;
   }
 
+  /** \brief Allocation statistics of a memory resource
+   */
+  struct memory_stats_t
+  {
+    /** Number of allocations */
+    std::size_t allocations = 0;
+    /** Number of deallocations */
+    std::size_t deallocations = 0;
+    /** Bytes currently allocated */
+    std::size_t bytes_in_use = 0;
+    /** Maximum of bytes_in_use */
+    std::size_t peak_bytes_in_use = 0;
+  };
+
+  /** \brief Source of memory for per-object bookkeeping
+   *
+   * This mirrors std::pmr::memory_resource, which is not available in
+   * C++11. A display_t can be constructed with a memory resource. The
+   * bookkeeping data and event handler storage of all objects of this
+   * connection are then allocated from it instead of the global operator
+   * new. This allows to use arenas and memory budgets per connection.
+   *
+   * Derived classes implement do_allocate() and do_deallocate(). The
+   * public interface counts all allocations, see get_stats(). The memory
+   * resource must outlive the display and all objects created with it.
+   * It must be thread safe if the objects are used from several threads.
+   */
+  class memory_resource_t
+  {
+  private:
+    std::atomic<std::size_t> allocations{0};
+    std::atomic<std::size_t> deallocations{0};
+    std::atomic<std::size_t> bytes_in_use{0};
+    std::atomic<std::size_t> peak_bytes_in_use{0};
+
+  protected:
+    virtual void *do_allocate(std::size_t bytes, std::size_t alignment) = 0;
+    virtual void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) = 0;
+
+  public:
+    memory_resource_t() = default;
+    memory_resource_t(const memory_resource_t&) = delete;
+    memory_resource_t &operator=(const memory_resource_t&) = delete;
+    virtual ~memory_resource_t() = default;
+
+    /** \brief Allocate memory
+     *
+     * \exception std::bad_alloc or any other exception of do_allocate()
+     */
+    void *allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t));
+
+    /** \brief Release memory obtained from allocate() */
+    void deallocate(void *p, std::size_t bytes, std::size_t alignment = alignof(std::max_align_t));
+
+    /** \brief Get the allocation statistics */
+    memory_stats_t get_stats() const;
+  };
+
+  /** \brief Memory resource using the global operator new and delete
+   *
+   * This is used if no other memory resource is given.
+   */
+  memory_resource_t *new_delete_resource();
+
   namespace detail
   {
+    /** \brief Standard allocator drawing from a memory_resource_t */
+    template <typename T>
+    class allocator_t
+    {
+    private:
+      memory_resource_t *resource;
+
+      template <typename U> friend class allocator_t;
+
+    public:
+      using value_type = T;
+
+      allocator_t(memory_resource_t *resource)
+        : resource(resource ? resource : new_delete_resource())
+      {
+      }
+
+      template <typename U>
+      allocator_t(const allocator_t<U> &a)
+        : resource(a.resource)
+      {
+      }
+
+      T *allocate(std::size_t n)
+      {
+        return static_cast<T*>(resource->allocate(n * sizeof(T), alignof(T)));
+      }
+
+      void deallocate(T *p, std::size_t n)
+      {
+        resource->deallocate(p, n * sizeof(T), alignof(T));
+      }
+
+      template <typename U>
+      bool operator==(const allocator_t<U> &a) const
+      {
+        return resource == a.resource;
+      }
+
+      template <typename U>
+      bool operator!=(const allocator_t<U> &a) const
+      {
+        return resource != a.resource;
+      }
+    };
+
+    /** \brief Construct an object in memory from a memory_resource_t */
+    template <typename T, typename... Args>
+    T *create(memory_resource_t *resource, Args&&... args)
+    {
+      void *p = resource->allocate(sizeof(T), alignof(T));
+      try
+      {
+        return new(p) T(std::forward<Args>(args)...);
+      }
+      catch(...)
+      {
+        resource->deallocate(p, sizeof(T), alignof(T));
+        throw;
+      }
+    }
+
+    /** \brief Destroy an object created with create() */
+    template <typename T>
+    void destroy(memory_resource_t *resource, T *object)
+    {
+      object->~T();
+      resource->deallocate(object, sizeof(T), alignof(T));
+    }
+
     /** \brief Check the return value of a C function and throw exception on
      *         failure
      *
@@ -499,6 +636,15 @@ namespace wayland
     array_t &operator=(const array_t &arr);
     array_t &operator=(array_t &&arr) noexcept;
 
+    /** \brief Raw contents of the array
+     *
+     * The pointer stays valid until the array is modified or destroyed.
+     */
+    const void *data() const;
+
+    /** \brief Size of the array in bytes */
+    std::size_t size() const;
+
     template <typename T> array_t &operator=(const std::vector<T> &v)
     {
       wl_array_release(&a);
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef WAYLAND_XDG_WINDOW_HPP
+#define WAYLAND_XDG_WINDOW_HPP
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <wayland-client-protocol.hpp>
+#include <wayland-client-protocol-extra.hpp>
+#include <wayland-frame-clock.hpp>
+
+namespace wayland
+{
+  namespace detail
+  {
+    struct xdg_window_data_t;
+  }
+
+  /** \brief Configured state of an xdg_toplevel
+   */
+  struct xdg_window_state_t
+  {
+    /** Suggested size, 0 if the client decides */
+    int32_t width = 0;
+    int32_t height = 0;
+
+    /** States of the toplevel */
+    std::vector<xdg_toplevel_state> states;
+
+    /** Bounds of the toplevel, 0 if unknown */
+    int32_t bounds_width = 0;
+    int32_t bounds_height = 0;
+
+    /** Capabilities of the window manager */
+    std::vector<xdg_toplevel_wm_capabilities> capabilities;
+
+    /** Serial of the configure sequence */
+    uint32_t serial = 0;
+
+    /** \brief Whether the toplevel is in a state */
+    bool has_state(xdg_toplevel_state state) const;
+
+    /** \brief Whether the window manager has a capability */
+    bool has_capability(xdg_toplevel_wm_capabilities capability) const;
+  };
+
+  /** \brief xdg_toplevel with coalesced configures
+   *
+   * Creates the xdg_surface and xdg_toplevel of a surface and renders it
+   * with a frame_clock_t. Configure sequences are recorded instead of being
+   * handled right away. On the next tick of the frame clock, only the
+   * latest configure is acknowledged, on_configure() is called once with
+   * the merged state, and on_render() draws and commits the surface. During
+   * an interactive resize, buffers are therefore reallocated at most once
+   * per frame, no matter how many configures the compositor sends. Like
+   * any tick, the first one after the clock was idle happens right away.
+   *
+   * \code
+   * xdg_window_t window(xdg_wm_base, surface, clock);
+   * window.get_toplevel().set_title("Window");
+   * window.on_configure() = [&] (const xdg_window_state_t &state)
+   * {
+   *   if(state.width && state.height)
+   *     create_buffers(state.width, state.height);
+   * };
+   * window.on_render() = [&] (const frame_tick_t &tick)
+   * {
+   *   draw(tick);
+   *   surface.commit();
+   * };
+   * surface.commit();
+   * \endcode
+   *
+   * The surface must be committed once without a buffer after creating the
+   * window, so that the compositor sends the first configure.
+   */
+  class xdg_window_t
+  {
+  private:
+    std::unique_ptr<detail::xdg_window_data_t> data;
+
+  public:
+    /** \brief Create a toplevel window
+     *
+     * \param wm_base xdg_wm_base global
+     * \param surface Surface of the window
+     * \param clock Frame clock to render the surface with. It must outlive
+     *        the window.
+     */
+    xdg_window_t(xdg_wm_base_t wm_base, surface_t surface, frame_clock_t &clock);
+    ~xdg_window_t();
+    xdg_window_t(const xdg_window_t&) = delete;
+    xdg_window_t(xdg_window_t&&) noexcept;
+    xdg_window_t &operator=(const xdg_window_t&) = delete;
+    xdg_window_t &operator=(xdg_window_t&&) noexcept;
+
+    /** \brief The xdg_surface of the window */
+    xdg_surface_t get_xdg_surface() const;
+
+    /** \brief The xdg_toplevel of the window */
+    xdg_toplevel_t get_toplevel() const;
+
+    /** \brief The state of the last acknowledged configure */
+    const xdg_window_state_t &get_state() const;
+
+    /** \brief Whether a configure is waiting for the next tick */
+    bool is_configure_pending() const;
+
+    /** \brief Request a redraw with the next tick */
+    void schedule();
+
+    /** \brief Called on a tick after a new configure was acknowledged
+     *
+     * Called before on_render() with the merged state of all configures
+     * received since the previous tick.
+     */
+    std::function<void(const xdg_window_state_t&)> &on_configure();
+
+    /** \brief Called on every tick to render and commit the surface
+     *
+     * If not set, the surface is only committed.
+     */
+    std::function<void(const frame_tick_t&)> &on_render();
+
+    /** \brief Called when the compositor asks to close the window */
+    std::function<void()> &on_close();
+  };
+}
+
+#endif
@@ -618,7 +618,7 @@ struct interface_t : public element_t
     std::stringstream set_events;
     set_events << "  if(proxy_has_object() && get_wrapper_type() == wrapper_type::standard)" << std::endl
                << "    {" << std::endl
-               << "      set_events(std::shared_ptr<detail::events_base_t>(new events_t), dispatcher);" << std::endl;
+               << "      init_events<events_t>(dispatcher);" << std::endl;
     if(destroy_opcode != -1)
       set_events << "      set_destroy_opcode(" << destroy_opcode << "U);" << std::endl;
     set_events << "    }" << std::endl;
@@ -708,13 +708,13 @@ struct interface_t : public element_t
     ss << name << "_t::" << name << "_t(const client_t& client, uint32_t id, int version)" << std::endl
        << "  : resource_t(client, &server::detail::" << name << "_interface, id, version)" << std::endl
        << "{" << std::endl
-       << "  set_events(std::shared_ptr<resource_t::events_base_t>(new events_t), dispatcher);" << std::endl
+       << "  init_events<events_t>(dispatcher);" << std::endl
        << "}" << std::endl
        << std::endl
        << name << "_t::" << name << "_t(const resource_t &resource)" << std::endl
        << "  : resource_t(resource)" << std::endl
        << "{" << std::endl
-       << "  set_events(std::shared_ptr<resource_t::events_base_t>(new events_t), dispatcher);" << std::endl
+       << "  init_events<events_t>(dispatcher);" << std::endl
        << "}" << std::endl
        << std::endl
        << "const std::string " << name << "_t::interface_name = \"" << orig_name << "\";" << std::endl
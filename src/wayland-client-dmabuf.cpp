@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <wayland-client-dmabuf.hpp>
+
+using namespace wayland;
+using namespace wayland::detail;
+
+namespace
+{
+  using table_key_t = std::tuple<dev_t, ino_t, uint32_t>;
+}
+
+struct dmabuf_format_table_t::mapping_t
+{
+  const dmabuf_format_t *formats = nullptr;
+  uint32_t size = 0;
+
+  ~mapping_t()
+  {
+    if(formats)
+      munmap(const_cast<dmabuf_format_t*>(formats), size);
+  }
+};
+
+//-----------------------------------------------------------------------------
+
+dmabuf_tranche_formats_t::dmabuf_tranche_formats_t(const dmabuf_format_t *table, std::size_t table_size,
+                                                   const uint16_t *indices, std::size_t count)
+  : table(table), table_size(table_size), indices(indices), count(count)
+{
+}
+
+dmabuf_tranche_formats_t::iterator dmabuf_tranche_formats_t::begin() const
+{
+  return iterator(table, indices);
+}
+
+dmabuf_tranche_formats_t::iterator dmabuf_tranche_formats_t::end() const
+{
+  return iterator(table, indices + count);
+}
+
+std::size_t dmabuf_tranche_formats_t::size() const
+{
+  return count;
+}
+
+bool dmabuf_tranche_formats_t::empty() const
+{
+  return count == 0;
+}
+
+const dmabuf_format_t &dmabuf_tranche_formats_t::at(std::size_t n) const
+{
+  if(n >= count || indices[n] >= table_size)
+    throw std::out_of_range("dmabuf tranche index out of range.");
+  return table[indices[n]];
+}
+
+const dmabuf_format_t &dmabuf_tranche_formats_t::operator[](std::size_t n) const
+{
+  return table[indices[n]];
+}
+
+//-----------------------------------------------------------------------------
+
+dmabuf_format_table_t dmabuf_format_table_t::load(int fd, uint32_t size)
+{
+  static std::mutex mutex;
+  static std::map<table_key_t, std::weak_ptr<const mapping_t>> cache;
+
+  struct fd_closer_t
+  {
+    int fd;
+    ~fd_closer_t()
+    {
+      close(fd);
+    }
+  } closer{fd};
+
+  if(size % sizeof(dmabuf_format_t) != 0)
+    throw std::invalid_argument("Invalid dmabuf format table size.");
+
+  struct stat st;
+  check_return_value(fstat(fd, &st), "fstat");
+  table_key_t key(st.st_dev, st.st_ino, size);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  dmabuf_format_table_t table;
+  auto it = cache.find(key);
+  if(it != cache.end())
+  {
+    table.mapping = it->second.lock();
+    if(table.mapping)
+      return table;
+  }
+
+  auto mapping = std::make_shared<mapping_t>();
+  if(size > 0)
+  {
+    void *ptr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(ptr == MAP_FAILED)
+      check_return_value(-1, "mmap");
+    mapping->formats = static_cast<const dmabuf_format_t*>(ptr);
+    mapping->size = size;
+  }
+  table.mapping = mapping;
+
+  // Drop the entries of tables that are no longer used
+  for(auto i = cache.begin(); i != cache.end();)
+  {
+    if(i->second.expired())
+      i = cache.erase(i);
+    else
+      ++i;
+  }
+  cache[key] = table.mapping;
+  return table;
+}
+
+dmabuf_format_table_t::operator bool() const
+{
+  return static_cast<bool>(mapping);
+}
+
+dmabuf_tranche_formats_t dmabuf_format_table_t::resolve(const array_t &indices) const
+{
+  if(indices.size() % sizeof(uint16_t) != 0)
+    throw std::invalid_argument("Invalid dmabuf tranche index array size.");
+  const auto *idx = static_cast<const uint16_t*>(indices.data());
+  std::size_t count = indices.size() / sizeof(uint16_t);
+  for(std::size_t c = 0; c < count; c++)
+    if(idx[c] >= size())
+      throw std::out_of_range("dmabuf tranche index out of range.");
+  return dmabuf_tranche_formats_t(data(), size(), idx, count);
+}
+
+const dmabuf_format_t *dmabuf_format_table_t::data() const
+{
+  return mapping ? mapping->formats : nullptr;
+}
+
+std::size_t dmabuf_format_table_t::size() const
+{
+  return mapping ? mapping->size / sizeof(dmabuf_format_t) : 0;
+}
+
+const dmabuf_format_t &dmabuf_format_table_t::operator[](std::size_t n) const
+{
+  return data()[n];
+}
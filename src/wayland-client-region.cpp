@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <limits>
+#include <wayland-client-region.hpp>
+
+using namespace wayland;
+
+region_cache_t::region_cache_t(compositor_t compositor, std::size_t capacity)
+  : compositor(std::move(compositor)), capacity(std::max<std::size_t>(capacity, 1))
+{
+}
+
+region_t region_cache_t::get(const rect_set_t &rects)
+{
+  std::size_t hash = rects.hash();
+  for(auto &entry : entries)
+    if(entry.hash == hash && entry.rects == rects)
+    {
+      entry.last_use = ++use_counter;
+      return entry.region;
+    }
+
+  region_t region = compositor.create_region();
+  for(const auto &rect : rects)
+    region.add(rect.x1, rect.y1, rect.width(), rect.height());
+
+  if(entries.size() >= capacity)
+  {
+    auto lru = std::min_element(entries.begin(), entries.end(),
+                                [] (const entry_t &a, const entry_t &b) { return a.last_use < b.last_use; });
+    entries.erase(lru);
+  }
+  entries.push_back({ hash, rects, region, ++use_counter });
+  return region;
+}
+
+void region_cache_t::set_opaque_region(surface_t &surface, const rect_set_t &rects)
+{
+  surface.set_opaque_region(rects.empty() ? region_t() : get(rects));
+}
+
+void region_cache_t::set_input_region(surface_t &surface, const rect_set_t &rects)
+{
+  surface.set_input_region(get(rects));
+}
+
+void region_cache_t::clear()
+{
+  entries.clear();
+}
+
+std::size_t region_cache_t::size() const
+{
+  return entries.size();
+}
+
+//-----------------------------------------------------------------------------
+
+damage_accumulator_t::damage_accumulator_t(surface_t surface, std::size_t max_rects)
+  : surface(std::move(surface)), max_rects(std::max<std::size_t>(max_rects, 1))
+{
+}
+
+void damage_accumulator_t::merge()
+{
+  if(pending.empty())
+    return;
+  if(!bounds.empty())
+    for(auto &rect : pending)
+      rect = { std::max(rect.x1, bounds.x1), std::max(rect.y1, bounds.y1),
+               std::min(rect.x2, bounds.x2), std::min(rect.y2, bounds.y2) };
+  // build the new damage in one go, which is much cheaper than adding one by one
+  if(!damage.empty())
+    pending.insert(pending.end(), damage.begin(), damage.end());
+  damage = rect_set_t(pending);
+  pending.clear();
+}
+
+void damage_accumulator_t::add(const rect_t &rect)
+{
+  if(!rect.empty())
+    pending.push_back(rect);
+}
+
+void damage_accumulator_t::add(int32_t x, int32_t y, int32_t width, int32_t height)
+{
+  add(rect_t::from_size(x, y, width, height));
+}
+
+void damage_accumulator_t::add(const rect_set_t &rects)
+{
+  pending.insert(pending.end(), rects.begin(), rects.end());
+}
+
+void damage_accumulator_t::add_all()
+{
+  pending.clear();
+  if(bounds.empty())
+  {
+    const int32_t max = std::numeric_limits<int32_t>::max();
+    damage = rect_set_t(rect_t{ 0, 0, max, max });
+  }
+  else
+    damage = rect_set_t(bounds);
+}
+
+void damage_accumulator_t::set_buffer_size(int32_t width, int32_t height)
+{
+  merge();
+  bounds = { 0, 0, width, height };
+  damage &= rect_set_t(bounds);
+}
+
+void damage_accumulator_t::set_buffer_scale(int32_t s)
+{
+  scale = std::max(s, 1);
+}
+
+const rect_set_t &damage_accumulator_t::get_damage()
+{
+  merge();
+  return damage;
+}
+
+bool damage_accumulator_t::empty() const
+{
+  return pending.empty() && damage.empty();
+}
+
+void damage_accumulator_t::clear()
+{
+  pending.clear();
+  damage.clear();
+}
+
+std::size_t damage_accumulator_t::flush()
+{
+  merge();
+  damage.simplify(max_rects);
+  bool buffer_damage = surface.can_damage_buffer();
+  for(const auto &rect : damage)
+  {
+    if(buffer_damage)
+      surface.damage_buffer(rect.x1, rect.y1, rect.width(), rect.height());
+    else
+    {
+      // round outwards to surface coordinates
+      int32_t x1 = rect.x1 / scale;
+      int32_t y1 = rect.y1 / scale;
+      int32_t x2 = rect.x2 / scale + (rect.x2 % scale ? 1 : 0);
+      int32_t y2 = rect.y2 / scale + (rect.y2 % scale ? 1 : 0);
+      surface.damage(x1, y1, x2 - x1, y2 - y1);
+    }
+  }
+  std::size_t count = damage.size();
+  damage.clear();
+  return count;
+}
+
+void damage_accumulator_t::commit()
+{
+  flush();
+  surface.commit();
+}
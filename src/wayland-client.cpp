@@ -23,12 +23,15 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
 #include <cstdarg>
 #include <cstdio>
 #include <cerrno>
 
+#include <cstdint>
 #include <iostream>
 #include <limits>
+#include <mutex>
 #include <system_error>
 #include <wayland-client.hpp>
 #include <wayland-client-protocol.hpp>
@@ -84,8 +87,136 @@ struct wayland::detail::proxy_data_t
   std::atomic<unsigned int> counter{1};
   event_queue_t queue;
   proxy_t wrapped_proxy;
+  memory_resource_t *resource{nullptr};
+  // lifetime group membership
+  wl_proxy *proxy{nullptr};
+  proxy_group_data_t *group{nullptr};
+  proxy_data_t *group_prev{nullptr};
+  proxy_data_t *group_next{nullptr};
+  bool destroyed{false};
 };
 
+// arena and member list of a proxy_group_t
+struct wayland::detail::proxy_group_data_t : public memory_resource_t
+{
+  std::mutex mutex;
+  wl_display *display{nullptr};
+  memory_resource_t *upstream{nullptr};
+  std::size_t chunk_size{0};
+  std::vector<std::pair<void*, std::size_t>> chunks;
+  char *current{nullptr};
+  std::size_t remaining{0};
+  std::size_t live{0};
+  std::size_t attached{0};
+  bool released{false};
+  proxy_data_t *first{nullptr};
+  proxy_data_t *last{nullptr};
+
+  ~proxy_group_data_t() override
+  {
+    for(auto &chunk : chunks)
+      upstream->deallocate(chunk.first, chunk.second);
+  }
+
+  void attach(proxy_data_t *d, wl_proxy *p)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    d->proxy = p;
+    d->group = this;
+    d->group_prev = last;
+    if(last)
+      last->group_next = d;
+    else
+      first = d;
+    last = d;
+    attached++;
+  }
+
+  // caller must hold the mutex
+  void destroy_proxy(proxy_data_t *d)
+  {
+    if(d->destroyed)
+      return;
+    if(d->has_destroy_opcode)
+      wl_proxy_marshal(d->proxy, d->destroy_opcode);
+    wl_proxy_destroy(d->proxy);
+    d->destroyed = true;
+    attached--;
+  }
+
+  void release_proxy(proxy_data_t *d)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    destroy_proxy(d);
+    if(d->group_prev)
+      d->group_prev->group_next = d->group_next;
+    else
+      first = d->group_next;
+    if(d->group_next)
+      d->group_next->group_prev = d->group_prev;
+    else
+      last = d->group_prev;
+  }
+
+  void release()
+  {
+    mutex.lock();
+    released = true;
+    bool unused = live == 0;
+    mutex.unlock();
+    if(unused)
+      delete this;
+  }
+
+protected:
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto pos = reinterpret_cast<std::uintptr_t>(current);
+    std::size_t padding = (alignment - pos % alignment) % alignment;
+    if(!current || padding + bytes > remaining)
+    {
+      std::size_t size = std::max(chunk_size, bytes + alignment);
+      current = static_cast<char*>(upstream->allocate(size));
+      chunks.emplace_back(current, size);
+      remaining = size;
+      pos = reinterpret_cast<std::uintptr_t>(current);
+      padding = (alignment - pos % alignment) % alignment;
+    }
+    void *p = current + padding;
+    current += padding + bytes;
+    remaining -= padding + bytes;
+    live++;
+    return p;
+  }
+
+  void do_deallocate(void * /*p*/, std::size_t /*bytes*/, std::size_t /*alignment*/) override
+  {
+    mutex.lock();
+    live--;
+    bool unused = released && live == 0;
+    mutex.unlock();
+    if(unused)
+      delete this;
+  }
+};
+
+namespace
+{
+  // group of the innermost proxy_group_t::scope_t of this thread
+  thread_local proxy_group_data_t *g_current_group = nullptr;
+
+  // Memory resource for proxies created from a proxy outside of a group
+  // scope. The arena of a group never reuses memory, so children that are
+  // not attached to it, like frame callbacks, use its upstream resource.
+  memory_resource_t *child_resource(const proxy_data_t *d)
+  {
+    if(!d)
+      return new_delete_resource();
+    return d->group ? d->group->upstream : d->resource;
+  }
+}
+
 void wayland::set_log_handler(log_handler handler)
 {
   g_log_handler = std::move(handler);
@@ -161,7 +292,8 @@ int proxy_t::c_dispatcher(const void *implementation, void *target, uint32_t opc
       {
         auto *proxy = reinterpret_cast<wl_proxy*>(args[c].o);
         wl_proxy_set_user_data(proxy, nullptr); // Wayland leaves the user data uninitialized
-        a = proxy_t(proxy);
+        auto *target_data = static_cast<proxy_data_t*>(wl_proxy_get_user_data(reinterpret_cast<wl_proxy*>(target)));
+        a = proxy_t(proxy, wrapper_type::standard, event_queue_t(), child_resource(target_data));
       }
       else
         a = proxy_t();
@@ -205,7 +337,13 @@ proxy_t proxy_t::marshal_single(uint32_t opcode, const wl_interface *interface,
       throw std::runtime_error("wl_proxy_marshal_array_constructor");
     wl_proxy_set_user_data(p, nullptr); // Wayland leaves the user data uninitialized
     // libwayland-client inherits the queue, so we need to, too
-    return proxy_t(p, wrapper_type::standard, data ? data->queue : wayland::event_queue_t());
+    if(g_current_group)
+    {
+      proxy_t result(p, wrapper_type::standard, data ? data->queue : wayland::event_queue_t(), g_current_group);
+      g_current_group->attach(result.data, p);
+      return result;
+    }
+    return proxy_t(p, wrapper_type::standard, data ? data->queue : wayland::event_queue_t(), child_resource(data));
   }
   wl_proxy_marshal_array(proxy, opcode, v.data());
   return proxy_t();
@@ -245,6 +383,11 @@ void proxy_t::set_events(std::shared_ptr<events_base_t> events,
   }
 }
 
+bool proxy_t::has_events() const
+{
+  return data && data->events;
+}
+
 std::shared_ptr<events_base_t> proxy_t::get_events()
 {
   if(data)
@@ -253,6 +396,11 @@ std::shared_ptr<events_base_t> proxy_t::get_events()
 }
 
 proxy_t::proxy_t(wl_proxy *p, wrapper_type t, event_queue_t const &queue)
+  : proxy_t(p, t, queue, nullptr)
+{
+}
+
+proxy_t::proxy_t(wl_proxy *p, wrapper_type t, event_queue_t const &queue, memory_resource_t *resource)
   : proxy(p), type(t)
 {
   if(type != wrapper_type::foreign && p != nullptr)
@@ -265,7 +413,10 @@ proxy_t::proxy_t(wl_proxy *p, wrapper_type t, event_queue_t const &queue)
 
     if(!data)
     {
-      data = new proxy_data_t;
+      if(!resource)
+        resource = new_delete_resource();
+      data = detail::create<proxy_data_t>(resource);
+      data->resource = resource;
       data->queue = queue;
       wl_proxy_set_user_data(c_ptr(), data);
     }
@@ -275,7 +426,7 @@ proxy_t::proxy_t(wl_proxy *p, wrapper_type t, event_queue_t const &queue)
 }
 
 proxy_t::proxy_t(const proxy_t &wrapped_proxy, construct_proxy_wrapper_tag /*unused*/)
-  : proxy_t(static_cast<wl_proxy*> (wl_proxy_create_wrapper(wrapped_proxy.c_ptr())), wrapper_type::proxy_wrapper, wrapped_proxy.data->queue)
+  : proxy_t(static_cast<wl_proxy*> (wl_proxy_create_wrapper(wrapped_proxy.c_ptr())), wrapper_type::proxy_wrapper, wrapped_proxy.data->queue, child_resource(wrapped_proxy.data))
 {
   if(!data || data->wrapped_proxy)
     throw std::runtime_error("Error wrapping proxy.");
@@ -342,7 +493,9 @@ void proxy_t::proxy_release()
   {
     if(--data->counter == 0)
     {
-      if(proxy)
+      if(data->group)
+        data->group->release_proxy(data);
+      else if(proxy)
       {
         switch(type)
         {
@@ -362,7 +515,7 @@ void proxy_t::proxy_release()
         }
       }
 
-      delete data;
+      detail::destroy(data->resource, data);
     }
   }
 
@@ -386,6 +539,13 @@ uint32_t proxy_t::get_version() const
   return wl_proxy_get_version(c_ptr());
 }
 
+memory_resource_t *proxy_t::get_memory_resource() const
+{
+  if(data)
+    return data->resource;
+  return new_delete_resource();
+}
+
 void proxy_t::set_queue(event_queue_t queue)
 {
   wl_proxy_set_queue(c_ptr(), queue ? queue.c_ptr() : nullptr);
@@ -397,12 +557,14 @@ wl_proxy *proxy_t::c_ptr() const
 {
   if(!proxy)
     throw std::invalid_argument("proxy is NULL");
+  if(data && data->destroyed)
+    throw std::invalid_argument("proxy was destroyed by its group");
   return proxy;
 }
 
 bool proxy_t::proxy_has_object() const
 {
-  return proxy;
+  return proxy && !(data && data->destroyed);
 }
 
 proxy_t::operator bool() const
@@ -470,6 +632,14 @@ display_t::display_t(int fd)
   set_interface(&display_interface);
 }
 
+display_t::display_t(int fd, memory_resource_t *resource)
+  : proxy_t(reinterpret_cast<wl_proxy*>(wl_display_connect_to_fd(fd)), proxy_t::wrapper_type::display, event_queue_t(), resource)
+{
+  if(!proxy_has_object())
+    throw std::runtime_error("Could not connect to Wayland display server via file-descriptor");
+  set_interface(&display_interface);
+}
+
 display_t::display_t(const std::string& name)
   : proxy_t(reinterpret_cast<wl_proxy*>(wl_display_connect(name.empty() ? nullptr : name.c_str())), proxy_t::wrapper_type::display)
 {
@@ -478,6 +648,14 @@ display_t::display_t(const std::string& name)
   set_interface(&display_interface);
 }
 
+display_t::display_t(const std::string& name, memory_resource_t *resource)
+  : proxy_t(reinterpret_cast<wl_proxy*>(wl_display_connect(name.empty() ? nullptr : name.c_str())), proxy_t::wrapper_type::display, event_queue_t(), resource)
+{
+  if(!proxy_has_object())
+    throw std::runtime_error("Could not connect to Wayland display server via name");
+  set_interface(&display_interface);
+}
+
 display_t::display_t(wl_display* display)
   : proxy_t(reinterpret_cast<wl_proxy*> (display), proxy_t::wrapper_type::foreign)
 {
@@ -505,6 +683,11 @@ event_queue_t display_t::create_queue() const
   return queue;
 }
 
+memory_stats_t display_t::get_memory_stats() const
+{
+  return get_memory_resource()->get_stats();
+}
+
 int display_t::get_fd() const
 {
   return wl_display_get_fd(*this);
@@ -605,3 +788,77 @@ display_t display_t::proxy_create_wrapper()
 {
   return display_t{*this, construct_proxy_wrapper_tag()};
 }
+
+proxy_group_t::scope_t::scope_t(proxy_group_t &group)
+  : previous(g_current_group)
+{
+  g_current_group = group.data;
+}
+
+proxy_group_t::scope_t::~scope_t()
+{
+  g_current_group = previous;
+}
+
+proxy_group_t::proxy_group_t(display_t &display, std::size_t chunk_size)
+  : data(new proxy_group_data_t)
+{
+  data->display = display;
+  data->upstream = display.get_memory_resource();
+  data->chunk_size = chunk_size;
+}
+
+proxy_group_t::proxy_group_t(proxy_group_t &&g) noexcept
+{
+  operator=(std::move(g));
+}
+
+proxy_group_t &proxy_group_t::operator=(proxy_group_t &&g) noexcept
+{
+  std::swap(data, g.data);
+  return *this;
+}
+
+proxy_group_t::~proxy_group_t()
+{
+  if(data)
+  {
+    try
+    {
+      destroy();
+    }
+    catch(...)
+    {
+    }
+    data->release();
+  }
+}
+
+void proxy_group_t::destroy()
+{
+  if(!data)
+    return;
+  std::lock_guard<std::mutex> lock(data->mutex);
+  if(data->attached == 0)
+    return;
+  for(proxy_data_t *d = data->last; d; d = d->group_prev)
+    data->destroy_proxy(d);
+  // Sending the requests later is fine, so only fail on real errors
+  if(wl_display_flush(data->display) < 0 && errno != EAGAIN)
+    throw std::system_error(errno, std::generic_category(), "wl_display_flush");
+}
+
+std::size_t proxy_group_t::size() const
+{
+  if(!data)
+    return 0;
+  std::lock_guard<std::mutex> lock(data->mutex);
+  return data->attached;
+}
+
+memory_stats_t proxy_group_t::get_memory_stats() const
+{
+  if(!data)
+    return memory_stats_t();
+  return data->get_stats();
+}
@@ -0,0 +1,346 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <list>
+#include <stdexcept>
+#include <unordered_map>
+#include <unistd.h>
+#include <wayland-color-cache.hpp>
+
+using namespace wayland;
+using namespace wayland::detail;
+
+namespace
+{
+  // serializes the fields that are set, so equal descriptions give equal
+  // words regardless of the unused fields
+  std::size_t params_words(const image_description_params_t &p, uint32_t (&w)[32])
+  {
+    std::size_t n = 0;
+    w[n++] = p.valid;
+    if(p.valid & image_description_params_t::has_tf_named)
+      w[n++] = static_cast<uint32_t>(p.tf_named);
+    if(p.valid & image_description_params_t::has_tf_power)
+      w[n++] = p.tf_power;
+    if(p.valid & image_description_params_t::has_primaries_named)
+      w[n++] = static_cast<uint32_t>(p.primaries_named);
+    if(p.valid & image_description_params_t::has_primaries)
+      for(int32_t c : p.primaries)
+        w[n++] = static_cast<uint32_t>(c);
+    if(p.valid & image_description_params_t::has_luminances)
+    {
+      w[n++] = p.min_lum;
+      w[n++] = p.max_lum;
+      w[n++] = p.reference_lum;
+    }
+    if(p.valid & image_description_params_t::has_mastering_primaries)
+      for(int32_t c : p.mastering_primaries)
+        w[n++] = static_cast<uint32_t>(c);
+    if(p.valid & image_description_params_t::has_mastering_luminance)
+    {
+      w[n++] = p.mastering_min_lum;
+      w[n++] = p.mastering_max_lum;
+    }
+    if(p.valid & image_description_params_t::has_max_cll)
+      w[n++] = p.max_cll;
+    if(p.valid & image_description_params_t::has_max_fall)
+      w[n++] = p.max_fall;
+    return n;
+  }
+
+  struct params_hash_t
+  {
+    std::size_t operator()(const image_description_params_t &p) const
+    {
+      uint32_t w[32];
+      std::size_t n = params_words(p, w);
+      std::uint64_t h = 0;
+      for(std::size_t c = 0; c < n; c++)
+      {
+        h = (h ^ w[c]) * 0x9e3779b97f4a7c15ULL;
+        h ^= h >> 29;
+      }
+      return static_cast<std::size_t>(h);
+    }
+  };
+
+  std::string read_icc(int fd, uint32_t offset, uint32_t length)
+  {
+    if(length == 0)
+      throw std::invalid_argument("ICC profile is empty.");
+    std::string icc(length, '\0');
+    std::size_t done = 0;
+    while(done < length)
+    {
+      ssize_t r = pread(fd, &icc[done], length - done, static_cast<off_t>(offset) + done);
+      if(r < 0 && errno == EINTR)
+        continue;
+      check_return_value(static_cast<int>(r), "pread");
+      if(r == 0)
+        throw std::invalid_argument("ICC profile exceeds the file.");
+      done += r;
+    }
+    return icc;
+  }
+}
+
+bool image_description_params_t::operator==(const image_description_params_t &other) const
+{
+  uint32_t a[32];
+  uint32_t b[32];
+  std::size_t n = params_words(*this, a);
+  return n == params_words(other, b) && std::memcmp(a, b, n * sizeof(uint32_t)) == 0;
+}
+
+bool image_description_params_t::operator!=(const image_description_params_t &other) const
+{
+  return !(*this == other);
+}
+
+struct wayland::detail::image_description_cache_data_t
+{
+  struct entry_t
+  {
+    image_description_v1_t description;
+    image_description_status status = image_description_status::pending;
+    bool is_icc = false;
+    image_description_params_t params = image_description_params_t();
+    std::string icc;
+  };
+  using entries_t = std::list<entry_t>;
+
+  color_manager_v1_t manager;
+  std::size_t capacity = 0;
+  // most recently used first
+  entries_t entries;
+  std::unordered_map<image_description_params_t, entries_t::iterator, params_hash_t> by_params;
+  // keyed by the hash of the profile, so profiles are only stored once
+  std::unordered_multimap<std::size_t, entries_t::iterator> by_icc;
+  std::function<void()> ready_handler;
+  std::function<void(image_description_v1_cause, std::string)> failed_handler;
+
+  static void release(entry_t &entry)
+  {
+    if(entry.description)
+    {
+      entry.description.on_ready() = nullptr;
+      entry.description.on_failed() = nullptr;
+    }
+  }
+
+  ~image_description_cache_data_t()
+  {
+    for(auto &entry : entries)
+      release(entry);
+  }
+
+  void touch(entries_t::iterator it)
+  {
+    entries.splice(entries.begin(), entries, it);
+  }
+
+  void evict()
+  {
+    while(entries.size() > capacity)
+    {
+      entry_t &entry = entries.back();
+      release(entry);
+      if(entry.is_icc)
+      {
+        auto range = by_icc.equal_range(std::hash<std::string>()(entry.icc));
+        for(auto it = range.first; it != range.second; ++it)
+          if(&*it->second == &entry)
+          {
+            by_icc.erase(it);
+            break;
+          }
+      }
+      else
+        by_params.erase(entry.params);
+      entries.pop_back();
+    }
+  }
+
+  entries_t::iterator insert(image_description_v1_t description)
+  {
+    entries.emplace_front();
+    entry_t *e = &entries.front();
+    e->description = std::move(description);
+    // the entry is released before it leaves the list
+    image_description_cache_data_t *d = this;
+    e->description.on_ready() = [d, e] (uint32_t)
+    {
+      e->status = image_description_status::ready;
+      if(d->ready_handler)
+        d->ready_handler();
+    };
+    e->description.on_failed() = [d, e] (image_description_v1_cause cause, const std::string &msg)
+    {
+      e->status = image_description_status::failed;
+      if(d->failed_handler)
+        d->failed_handler(cause, msg);
+    };
+    return entries.begin();
+  }
+
+  entries_t::iterator lookup(const image_description_params_t &params)
+  {
+    auto it = by_params.find(params);
+    if(it != by_params.end())
+    {
+      touch(it->second);
+      return it->second;
+    }
+
+    image_description_creator_params_v1_t creator = manager.create_parametric_creator();
+    if(params.valid & image_description_params_t::has_tf_named)
+      creator.set_tf_named(params.tf_named);
+    if(params.valid & image_description_params_t::has_tf_power)
+      creator.set_tf_power(params.tf_power);
+    if(params.valid & image_description_params_t::has_primaries_named)
+      creator.set_primaries_named(params.primaries_named);
+    if(params.valid & image_description_params_t::has_primaries)
+    {
+      const int32_t *c = params.primaries;
+      creator.set_primaries(c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7]);
+    }
+    if(params.valid & image_description_params_t::has_luminances)
+      creator.set_luminances(params.min_lum, params.max_lum, params.reference_lum);
+    if(params.valid & image_description_params_t::has_mastering_primaries)
+    {
+      const int32_t *c = params.mastering_primaries;
+      creator.set_mastering_display_primaries(c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7]);
+    }
+    if(params.valid & image_description_params_t::has_mastering_luminance)
+      creator.set_mastering_luminance(params.mastering_min_lum, params.mastering_max_lum);
+    if(params.valid & image_description_params_t::has_max_cll)
+      creator.set_max_cll(params.max_cll);
+    if(params.valid & image_description_params_t::has_max_fall)
+      creator.set_max_fall(params.max_fall);
+
+    // create destroys the creator
+    entries_t::iterator e = insert(creator.create());
+    e->params = params;
+    by_params.emplace(params, e);
+    evict();
+    return e;
+  }
+
+  entries_t::iterator lookup_icc(int fd, uint32_t offset, uint32_t length)
+  {
+    std::string icc = read_icc(fd, offset, length);
+    std::size_t hash = std::hash<std::string>()(icc);
+    auto range = by_icc.equal_range(hash);
+    for(auto it = range.first; it != range.second; ++it)
+      if(it->second->icc == icc)
+      {
+        touch(it->second);
+        return it->second;
+      }
+
+    image_description_creator_icc_v1_t creator = manager.create_icc_creator();
+    creator.set_icc_file(fd, offset, length);
+    entries_t::iterator e = insert(creator.create());
+    e->is_icc = true;
+    e->icc = std::move(icc);
+    by_icc.emplace(hash, e);
+    evict();
+    return e;
+  }
+
+  static image_description_v1_t usable(const entry_t &entry)
+  {
+    if(entry.status == image_description_status::ready)
+      return entry.description;
+    return image_description_v1_t();
+  }
+};
+
+image_description_cache_t::image_description_cache_t(color_manager_v1_t manager, std::size_t capacity)
+  : data(new image_description_cache_data_t)
+{
+  if(capacity == 0)
+    throw std::invalid_argument("Image description cache capacity must not be zero.");
+  data->manager = std::move(manager);
+  data->capacity = capacity;
+}
+
+image_description_cache_t::~image_description_cache_t() = default;
+image_description_cache_t::image_description_cache_t(image_description_cache_t&&) noexcept = default;
+image_description_cache_t &image_description_cache_t::operator=(image_description_cache_t&&) noexcept = default;
+
+image_description_v1_t image_description_cache_t::get(const image_description_params_t &params)
+{
+  return image_description_cache_data_t::usable(*data->lookup(params));
+}
+
+image_description_v1_t image_description_cache_t::get_icc(int fd, uint32_t offset, uint32_t length)
+{
+  return image_description_cache_data_t::usable(*data->lookup_icc(fd, offset, length));
+}
+
+void image_description_cache_t::prefetch(const image_description_params_t &params)
+{
+  data->lookup(params);
+}
+
+void image_description_cache_t::prefetch_icc(int fd, uint32_t offset, uint32_t length)
+{
+  data->lookup_icc(fd, offset, length);
+}
+
+image_description_status image_description_cache_t::get_status(const image_description_params_t &params) const
+{
+  auto it = data->by_params.find(params);
+  if(it == data->by_params.end())
+    return image_description_status::none;
+  return it->second->status;
+}
+
+std::size_t image_description_cache_t::size() const
+{
+  return data->entries.size();
+}
+
+void image_description_cache_t::clear()
+{
+  for(auto &entry : data->entries)
+    image_description_cache_data_t::release(entry);
+  data->by_params.clear();
+  data->by_icc.clear();
+  data->entries.clear();
+}
+
+std::function<void()> &image_description_cache_t::on_ready()
+{
+  return data->ready_handler;
+}
+
+std::function<void(image_description_v1_cause, std::string)> &image_description_cache_t::on_failed()
+{
+  return data->failed_handler;
+}
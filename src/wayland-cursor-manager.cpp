@@ -0,0 +1,374 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <tuple>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <wayland-cursor-manager.hpp>
+
+using namespace wayland;
+using namespace wayland::detail;
+
+namespace
+{
+  typedef std::tuple<wl_shm*, std::string, int, bool> theme_key_t;
+
+  std::mutex theme_cache_mutex;
+  std::map<theme_key_t, std::weak_ptr<wl_cursor_theme>> theme_cache;
+
+  // CSS cursor names in the order of wp_cursor_shape_device_v1.shape,
+  // starting at 1
+  const char *const shape_names[] =
+  {
+    "default", "context-menu", "help", "pointer", "progress", "wait", "cell",
+    "crosshair", "text", "vertical-text", "alias", "copy", "move", "no-drop",
+    "not-allowed", "grab", "grabbing", "e-resize", "n-resize", "ne-resize",
+    "nw-resize", "s-resize", "se-resize", "sw-resize", "w-resize", "ew-resize",
+    "ns-resize", "nesw-resize", "nwse-resize", "col-resize", "row-resize",
+    "all-scroll", "zoom-in", "zoom-out", "dnd-ask", "all-resize"
+  };
+
+  // shapes added in version 2
+  const uint32_t first_v2_shape = static_cast<uint32_t>(cursor_shape_device_v1_shape::dnd_ask);
+
+  // traditional X cursor names of CSS cursors
+  const char *const legacy_names[][2] =
+  {
+    { "default", "left_ptr" },
+    { "pointer", "hand2" },
+    { "text", "xterm" },
+    { "wait", "watch" },
+    { "progress", "left_ptr_watch" },
+    { "help", "question_arrow" },
+    { "crosshair", "cross" },
+    { "move", "fleur" },
+    { "grab", "hand1" },
+    { "not-allowed", "crossed_circle" },
+    { "e-resize", "right_side" },
+    { "n-resize", "top_side" },
+    { "ne-resize", "top_right_corner" },
+    { "nw-resize", "top_left_corner" },
+    { "s-resize", "bottom_side" },
+    { "se-resize", "bottom_right_corner" },
+    { "sw-resize", "bottom_left_corner" },
+    { "w-resize", "left_side" },
+    { "ew-resize", "sb_h_double_arrow" },
+    { "ns-resize", "sb_v_double_arrow" }
+  };
+
+  uint32_t shape_for(const std::string &name)
+  {
+    for(uint32_t n = 0; n < sizeof(shape_names) / sizeof(shape_names[0]); n++)
+      if(name == shape_names[n])
+        return n + 1;
+    for(const auto &legacy : legacy_names)
+      if(name == legacy[1])
+        return shape_for(legacy[0]);
+    return 0;
+  }
+
+  const char *legacy_name(const std::string &name)
+  {
+    for(const auto &legacy : legacy_names)
+      if(name == legacy[0])
+        return legacy[1];
+    return nullptr;
+  }
+}
+
+cursor_theme_t cursor_theme_cache_t::get(const std::string &name, int size, const shm_t &shm, bool native)
+{
+  theme_key_t key(reinterpret_cast<wl_shm*>(shm.c_ptr()), name, size, native);
+  std::lock_guard<std::mutex> lock(theme_cache_mutex);
+
+  // forget unloaded themes
+  for(auto it = theme_cache.begin(); it != theme_cache.end(); )
+    if(it->second.expired())
+      it = theme_cache.erase(it);
+    else
+      ++it;
+
+  auto it = theme_cache.find(key);
+  if(it != theme_cache.end())
+  {
+    // the last user may just have released it
+    std::shared_ptr<wl_cursor_theme> theme = it->second.lock();
+    if(theme)
+      return cursor_theme_t(theme);
+  }
+
+  cursor_theme_t theme(name, size, shm, native);
+  theme_cache[key] = theme.ref_ptr();
+  return theme;
+}
+
+struct wayland::detail::cursor_manager_data_t
+{
+  pointer_t pointer;
+  compositor_t compositor;
+  shm_t shm;
+  cursor_shape_device_v1_t shape_device;
+  std::string theme_name;
+  int size = 24;
+  int32_t scale = 1;
+
+  // loaded on demand
+  cursor_theme_t theme;
+  std::map<std::string, cursor_t> cursors;
+  surface_t surface;
+
+  std::string name = "default";
+  bool hidden = false;
+  bool entered = false;
+  uint32_t serial = 0;
+
+  // animation
+  cursor_t cursor;
+  std::chrono::steady_clock::time_point start;
+  int timer_fd = -1;
+
+  ~cursor_manager_data_t()
+  {
+    if(timer_fd >= 0)
+      close(timer_fd);
+  }
+
+  uint32_t shape() const
+  {
+    if(!shape_device)
+      return 0;
+    uint32_t shape = shape_for(name);
+    if(shape >= first_v2_shape && shape_device.get_version() < 2)
+      return 0;
+    return shape;
+  }
+
+  cursor_t lookup(const std::string &cursor_name)
+  {
+    auto it = cursors.find(cursor_name);
+    if(it != cursors.end())
+      return it->second;
+
+    if(!theme)
+      theme = cursor_theme_cache_t::get(theme_name, size * scale, shm, true);
+    cursor_t result;
+    try
+    {
+      result = theme.get_cursor(cursor_name);
+    }
+    catch(std::runtime_error &)
+    {
+      const char *legacy = legacy_name(cursor_name);
+      if(legacy)
+        result = lookup(legacy);
+    }
+    // failed lookups are cached too
+    cursors[cursor_name] = result;
+    return result;
+  }
+
+  void arm(uint32_t delay)
+  {
+    itimerspec spec = {};
+    spec.it_value.tv_sec = delay / 1000;
+    spec.it_value.tv_nsec = static_cast<long>(delay % 1000) * 1000000;
+    check_return_value(timerfd_settime(timer_fd, 0, &spec, nullptr), "timerfd_settime");
+  }
+
+  void show_image(unsigned int n)
+  {
+    cursor_image_t image = cursor.image(n);
+    // the buffer size must be a multiple of the scale
+    int32_t buffer_scale = image.width() % scale == 0 && image.height() % scale == 0 ? scale : 1;
+    surface.attach(image.get_buffer(), 0, 0);
+    if(surface.can_set_buffer_scale())
+      surface.set_buffer_scale(buffer_scale);
+    else
+      buffer_scale = 1;
+    if(surface.can_damage_buffer())
+      surface.damage_buffer(0, 0, image.width(), image.height());
+    else
+      surface.damage(0, 0, image.width() / buffer_scale, image.height() / buffer_scale);
+    surface.commit();
+    pointer.set_cursor(serial, surface, image.hotspot_x() / buffer_scale, image.hotspot_y() / buffer_scale);
+  }
+
+  void update()
+  {
+    arm(0);
+    cursor = cursor_t();
+    if(!entered)
+      return;
+    if(hidden)
+    {
+      pointer.set_cursor(serial, surface_t(), 0, 0);
+      return;
+    }
+
+    uint32_t s = shape();
+    if(s)
+    {
+      shape_device.set_shape(serial, static_cast<cursor_shape_device_v1_shape>(s));
+      return;
+    }
+
+    cursor = lookup(name);
+    if(!cursor)
+      cursor = lookup("default");
+    if(!cursor)
+    {
+      pointer.set_cursor(serial, surface_t(), 0, 0);
+      return;
+    }
+    if(!surface)
+      surface = compositor.create_surface();
+    start = std::chrono::steady_clock::now();
+    show_image(0);
+    if(cursor.image_count() > 1 && cursor.image(0).delay() > 0)
+      arm(cursor.image(0).delay());
+  }
+
+  void advance()
+  {
+    if(!cursor)
+      return;
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    auto time = static_cast<uint32_t>(elapsed);
+    int n = cursor.frame(time);
+    show_image(n);
+
+    // time until the next frame
+    uint32_t total = 0;
+    for(unsigned int i = 0; i < cursor.image_count(); i++)
+      total += cursor.image(i).delay();
+    if(total == 0)
+      return;
+    uint32_t t = time % total;
+    uint32_t end = 0;
+    for(unsigned int i = 0; i < cursor.image_count(); i++)
+    {
+      end += cursor.image(i).delay();
+      if(t < end)
+        break;
+    }
+    arm(end - t);
+  }
+};
+
+cursor_manager_t::cursor_manager_t(pointer_t pointer, compositor_t compositor, shm_t shm,
+                                   cursor_shape_manager_v1_t shape_manager, std::string theme, int size)
+  : data(new cursor_manager_data_t)
+{
+  data->pointer = std::move(pointer);
+  data->compositor = std::move(compositor);
+  data->shm = std::move(shm);
+  if(shape_manager)
+    data->shape_device = shape_manager.get_pointer(data->pointer);
+
+  const char *env_theme = std::getenv("XCURSOR_THEME");
+  data->theme_name = theme.empty() && env_theme ? env_theme : std::move(theme);
+  const char *env_size = std::getenv("XCURSOR_SIZE");
+  if(size <= 0 && env_size)
+    size = std::atoi(env_size);
+  data->size = size > 0 ? size : 24;
+
+  data->timer_fd = check_return_value(timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK), "timerfd_create");
+}
+
+cursor_manager_t::~cursor_manager_t() = default;
+
+cursor_manager_t::cursor_manager_t(cursor_manager_t&&) noexcept = default;
+
+cursor_manager_t &cursor_manager_t::operator=(cursor_manager_t&&) noexcept = default;
+
+void cursor_manager_t::enter(uint32_t serial)
+{
+  data->serial = serial;
+  data->entered = true;
+  data->update();
+}
+
+void cursor_manager_t::leave()
+{
+  // stops the animation, the enter serial must not be used any more
+  data->entered = false;
+  data->update();
+}
+
+void cursor_manager_t::set_cursor(const std::string &name)
+{
+  if(name == data->name && !data->hidden)
+    return;
+  data->name = name;
+  data->hidden = false;
+  data->update();
+}
+
+void cursor_manager_t::hide()
+{
+  if(data->hidden)
+    return;
+  data->hidden = true;
+  data->update();
+}
+
+void cursor_manager_t::set_scale(int32_t scale)
+{
+  if(scale < 1)
+    throw std::invalid_argument("Cursor scale must be positive.");
+  if(scale == data->scale)
+    return;
+  data->scale = scale;
+  data->theme = cursor_theme_t();
+  data->cursors.clear();
+  if(!data->hidden && !data->shape())
+    data->update();
+}
+
+bool cursor_manager_t::uses_shape() const
+{
+  return data->shape() != 0;
+}
+
+int cursor_manager_t::get_fd() const
+{
+  return data->timer_fd;
+}
+
+void cursor_manager_t::dispatch()
+{
+  uint64_t expirations = 0;
+  if(read(data->timer_fd, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN)
+    check_return_value(-1, "read");
+  if(expirations > 0)
+    data->advance();
+}
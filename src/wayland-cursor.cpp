@@ -23,27 +23,404 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <set>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <wayland-cursor.hpp>
+#include <wayland-shm-pool.hpp>
 
 using namespace wayland;
 
-cursor_theme_t::cursor_theme_t(const std::string& name, int size, const shm_t& shm)
-  : detail::refcounted_wrapper<wl_cursor_theme>({wl_cursor_theme_load(name.empty() ? nullptr : name.c_str(),
-        size, reinterpret_cast<wl_shm*>(shm.c_ptr())),
-      wl_cursor_theme_destroy})
+// Native Xcursor loader, used if requested when loading a theme
+//
+// Cursor files are mapped and indexed when a cursor is first requested.
+// Only the images of the nominal size closest to the size of the theme are
+// used, and their pixels are copied into the shm pool of the theme when
+// their buffer is first requested. The structures start with the public
+// libwayland-cursor structures, so that the wrappers can use them in the
+// same way. Themes without any cursor directory are loaded with
+// libwayland-cursor, which provides built-in fallback cursors.
+
+namespace
 {
-  if(!c_ptr())
+  const uint32_t xcursor_magic = 0x72756358; // "Xcur"
+  const uint32_t xcursor_image_type = 0xfffd0002;
+  const uint32_t xcursor_file_header_size = 16;
+  const uint32_t xcursor_toc_entry_size = 12;
+  const uint32_t xcursor_image_header_size = 36;
+  const uint32_t xcursor_max_image_size = 0x7fff;
+  const unsigned int xcursor_max_inherit_depth = 16;
+
+  struct xcursor_mapping_t
+  {
+    const uint8_t *data = nullptr;
+    std::size_t size = 0;
+
+    ~xcursor_mapping_t()
+    {
+      if(data)
+        munmap(const_cast<uint8_t*>(data), size);
+    }
+
+    uint32_t read(std::size_t offset) const
+    {
+      uint32_t value = 0;
+      std::memcpy(&value, data + offset, sizeof(value));
+      return value;
+    }
+  };
+
+  struct xcursor_image_t
+  {
+    wl_cursor_image image; // must be first
+    const uint8_t *pixels = nullptr;
+    shm_pool_buffer_t buffer;
+  };
+
+  struct xcursor_t
+  {
+    wl_cursor cursor; // must be first
+    std::string name;
+    std::vector<std::unique_ptr<xcursor_image_t>> images;
+    std::vector<wl_cursor_image*> image_ptrs;
+    std::shared_ptr<xcursor_mapping_t> mapping;
+  };
+
+  struct xcursor_theme_t
+  {
+    int size;
+    // cursor directories of the theme and the themes it inherits from
+    std::vector<std::string> dirs;
+    shm_buffer_pool_t pool;
+    std::mutex mutex;
+    // missing cursors are stored as nullptr
+    std::map<std::string, std::unique_ptr<xcursor_t>> cursors;
+
+    xcursor_theme_t(shm_t shm, int size, std::vector<std::string> dirs)
+      : size(size), dirs(std::move(dirs)), pool(shm, std::numeric_limits<unsigned int>::max())
+    {
+    }
+  };
+
+  // Identifies themes of the native loader by the type of their deleter.
+  struct xcursor_theme_deleter_t
+  {
+    void operator()(wl_cursor_theme *theme) const
+    {
+      delete reinterpret_cast<xcursor_theme_t*>(theme);
+    }
+  };
+
+  xcursor_theme_t *native_theme(const std::shared_ptr<wl_cursor_theme> &theme)
+  {
+    if(!std::get_deleter<xcursor_theme_deleter_t>(theme))
+      return nullptr;
+    return reinterpret_cast<xcursor_theme_t*>(theme.get());
+  }
+
+  std::vector<std::string> split(const std::string &str, const char *separators)
+  {
+    std::vector<std::string> result;
+    std::string::size_type start = 0;
+    while(start < str.size())
+    {
+      std::string::size_type end = str.find_first_of(separators, start);
+      if(end == std::string::npos)
+        end = str.size();
+      if(end > start)
+        result.push_back(str.substr(start, end - start));
+      start = end + 1;
+    }
+    return result;
+  }
+
+  bool is_directory(const std::string &path)
+  {
+    struct stat st = {};
+    return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+  }
+
+  // same default as libXcursor and libwayland-cursor
+  std::vector<std::string> search_path()
+  {
+    std::string home = std::getenv("HOME") ? std::getenv("HOME") : "";
+    std::string path;
+    if(std::getenv("XCURSOR_PATH"))
+      path = std::getenv("XCURSOR_PATH");
+    else
+    {
+      const char *data_home = std::getenv("XDG_DATA_HOME");
+      if(data_home && *data_home)
+        path = std::string(data_home) + "/icons:";
+      else if(!home.empty())
+        path = home + "/.local/share/icons:";
+      path += "~/.icons:/usr/share/icons:/usr/share/pixmaps:~/.cursors:/usr/share/cursors/xorg-x11:/usr/X11R6/lib/X11/icons";
+    }
+
+    std::vector<std::string> dirs;
+    for(auto &dir : split(path, ":"))
+    {
+      if(dir[0] == '~')
+      {
+        if(home.empty())
+          continue;
+        dir = home + dir.substr(1);
+      }
+      dirs.push_back(dir);
+    }
+    return dirs;
+  }
+
+  std::vector<std::string> inherited_themes(const std::vector<std::string> &path, const std::string &theme)
+  {
+    for(const auto &dir : path)
+    {
+      std::ifstream index(dir + "/" + theme + "/index.theme");
+      if(!index)
+        continue;
+      std::string line;
+      while(std::getline(index, line))
+      {
+        if(line.compare(0, 8, "Inherits") != 0)
+          continue;
+        std::string::size_type eq = line.find('=', 8);
+        if(eq != std::string::npos && line.find_first_not_of(" \t", 8) == eq)
+          return split(line.substr(eq + 1), ",; \t\r");
+      }
+      return {};
+    }
+    return {};
+  }
+
+  void add_theme_dirs(const std::vector<std::string> &path, const std::string &theme, unsigned int depth,
+                      std::set<std::string> &visited, std::vector<std::string> &dirs)
+  {
+    if(depth > xcursor_max_inherit_depth || !visited.insert(theme).second)
+      return;
+    for(const auto &dir : path)
+    {
+      std::string cursors = dir + "/" + theme + "/cursors";
+      if(is_directory(cursors))
+        dirs.push_back(cursors);
+    }
+    for(const auto &parent : inherited_themes(path, theme))
+      add_theme_dirs(path, parent, depth + 1, visited, dirs);
+  }
+
+  std::shared_ptr<wl_cursor_theme> load_native_theme(const std::string &name, int size, const shm_t &shm)
+  {
+    std::vector<std::string> path = search_path();
+    std::vector<std::string> dirs;
+    std::set<std::string> visited;
+    add_theme_dirs(path, name.empty() ? "default" : name, 0, visited, dirs);
+    // like libXcursor, fall back to the default theme
+    add_theme_dirs(path, "default", 0, visited, dirs);
+    if(dirs.empty())
+      return nullptr;
+    return std::shared_ptr<wl_cursor_theme>(reinterpret_cast<wl_cursor_theme*>(new xcursor_theme_t(shm, size, dirs)),
+                                            xcursor_theme_deleter_t());
+  }
+
+  std::shared_ptr<xcursor_mapping_t> map_file(const std::string &path)
+  {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+      return nullptr;
+    auto mapping = std::make_shared<xcursor_mapping_t>();
+    struct stat st = {};
+    if(fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size >= xcursor_file_header_size)
+    {
+      void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if(data != MAP_FAILED)
+      {
+        mapping->data = static_cast<const uint8_t*>(data);
+        mapping->size = st.st_size;
+      }
+    }
+    close(fd);
+    return mapping->data ? mapping : nullptr;
+  }
+
+  // Indexes a cursor file and reads the image headers of the best size.
+  std::unique_ptr<xcursor_t> load_cursor(const std::string &path, const std::string &name, int size)
+  {
+    std::shared_ptr<xcursor_mapping_t> file = map_file(path);
+    if(!file || file->read(0) != xcursor_magic)
+      return nullptr;
+    uint32_t header_size = file->read(4);
+    uint32_t ntoc = file->read(12);
+    if(header_size < xcursor_file_header_size || header_size > file->size
+       || ntoc > (file->size - header_size) / xcursor_toc_entry_size)
+      return nullptr;
+
+    // nominal size closest to the requested one
+    uint32_t best = 0;
+    auto distance = [size] (uint32_t s) { return std::abs(static_cast<int64_t>(s) - size); };
+    for(uint32_t n = 0; n < ntoc; n++)
+    {
+      std::size_t entry = header_size + n * xcursor_toc_entry_size;
+      uint32_t subtype = file->read(entry + 4);
+      if(file->read(entry) == xcursor_image_type && (!best || distance(subtype) < distance(best)))
+        best = subtype;
+    }
+
+    std::unique_ptr<xcursor_t> cursor(new xcursor_t);
+    for(uint32_t n = 0; n < ntoc; n++)
+    {
+      std::size_t entry = header_size + n * xcursor_toc_entry_size;
+      if(file->read(entry) != xcursor_image_type || file->read(entry + 4) != best)
+        continue;
+      std::size_t position = file->read(entry + 8);
+      if(position > file->size || file->size - position < xcursor_image_header_size
+         || file->read(position) != xcursor_image_header_size
+         || file->read(position + 4) != xcursor_image_type)
+        return nullptr;
+      std::unique_ptr<xcursor_image_t> image(new xcursor_image_t);
+      image->image.width = file->read(position + 16);
+      image->image.height = file->read(position + 20);
+      image->image.hotspot_x = file->read(position + 24);
+      image->image.hotspot_y = file->read(position + 28);
+      image->image.delay = file->read(position + 32);
+      if(image->image.width == 0 || image->image.width > xcursor_max_image_size
+         || image->image.height == 0 || image->image.height > xcursor_max_image_size
+         || image->image.hotspot_x > image->image.width || image->image.hotspot_y > image->image.height
+         || (file->size - position - xcursor_image_header_size) / 4 / image->image.width < image->image.height)
+        return nullptr;
+      image->pixels = file->data + position + xcursor_image_header_size;
+      cursor->image_ptrs.push_back(&image->image);
+      cursor->images.push_back(std::move(image));
+    }
+    if(cursor->images.empty())
+      return nullptr;
+
+    cursor->name = name;
+    cursor->mapping = file;
+    cursor->cursor.image_count = static_cast<unsigned int>(cursor->images.size());
+    cursor->cursor.images = cursor->image_ptrs.data();
+    cursor->cursor.name = &cursor->name[0];
+    return cursor;
+  }
+
+  wl_cursor *native_get_cursor(xcursor_theme_t &theme, const std::string &name)
+  {
+    std::lock_guard<std::mutex> lock(theme.mutex);
+    auto it = theme.cursors.find(name);
+    if(it == theme.cursors.end())
+    {
+      std::unique_ptr<xcursor_t> cursor;
+      if(name.find('/') == std::string::npos)
+        for(const auto &dir : theme.dirs)
+          if((cursor = load_cursor(dir + "/" + name, name, theme.size)))
+            break;
+      it = theme.cursors.insert(std::make_pair(name, std::move(cursor))).first;
+    }
+    return it->second ? &it->second->cursor : nullptr;
+  }
+
+  buffer_t native_get_buffer(xcursor_theme_t &theme, wl_cursor_image *image)
+  {
+    std::lock_guard<std::mutex> lock(theme.mutex);
+    auto *xcursor_image = reinterpret_cast<xcursor_image_t*>(image);
+    if(!xcursor_image->buffer)
+    {
+      // Xcursor pixels are premultiplied ARGB in little endian, just like argb8888
+      auto width = static_cast<int32_t>(image->width);
+      auto height = static_cast<int32_t>(image->height);
+      shm_pool_buffer_t buffer = theme.pool.acquire(width, height, shm_format::argb8888);
+      auto *dst = static_cast<uint8_t*>(buffer.get_data());
+      for(int32_t y = 0; y < height; y++)
+        std::memcpy(dst + static_cast<std::size_t>(y) * buffer.get_stride(),
+                    xcursor_image->pixels + static_cast<std::size_t>(y) * width * 4, width * 4);
+      xcursor_image->buffer = buffer;
+    }
+    return xcursor_image->buffer.get_buffer();
+  }
+
+  int native_frame(const wl_cursor *cursor, uint32_t time)
+  {
+    uint32_t total = 0;
+    for(unsigned int i = 0; i < cursor->image_count; i++)
+      total += cursor->images[i]->delay;
+    if(total == 0)
+      return 0;
+    time %= total;
+    for(unsigned int i = 0; i < cursor->image_count; i++)
+    {
+      if(time < cursor->images[i]->delay)
+        return static_cast<int>(i);
+      time -= cursor->images[i]->delay;
+    }
+    return 0;
+  }
+
+  using theme_wrapper_t = detail::refcounted_wrapper<wl_cursor_theme>;
+  using cursor_wrapper_t = detail::basic_wrapper<wl_cursor>;
+  using image_wrapper_t = detail::basic_wrapper<wl_cursor_image>;
+
+  void check_not_native(const std::shared_ptr<wl_cursor_theme> &theme)
+  {
+    if(native_theme(theme))
+      throw std::runtime_error("Natively loaded cursor themes have no libwayland-cursor objects.");
+  }
+
+  std::shared_ptr<wl_cursor_theme> load_theme(const std::string &name, int size, const shm_t &shm, bool native)
+  {
+    std::shared_ptr<wl_cursor_theme> theme = native ? load_native_theme(name, size, shm) : nullptr;
+    if(theme)
+      return theme;
+    wl_cursor_theme *fallback = wl_cursor_theme_load(name.empty() ? nullptr : name.c_str(), size,
+                                                     reinterpret_cast<wl_shm*>(shm.c_ptr()));
+    if(!fallback)
+      return nullptr;
+    return std::shared_ptr<wl_cursor_theme>(fallback, wl_cursor_theme_destroy);
+  }
+}
+
+cursor_theme_t::cursor_theme_t(const std::string& name, int size, const shm_t& shm, bool native)
+  : detail::refcounted_wrapper<wl_cursor_theme>(load_theme(name, size, shm, native))
+{
+  if(!has_object())
     throw std::runtime_error("wl_cursor_theme_load failed.");
 }
 
+cursor_theme_t::cursor_theme_t(std::shared_ptr<wl_cursor_theme> theme)
+  : detail::refcounted_wrapper<wl_cursor_theme>(std::move(theme))
+{
+}
+
 cursor_t cursor_theme_t::get_cursor(const std::string& name) const
 {
-  wl_cursor *cursor = wl_cursor_theme_get_cursor(c_ptr(), name.c_str());
+  xcursor_theme_t *native = native_theme(ref_ptr());
+  wl_cursor *cursor = native ? native_get_cursor(*native, name) : wl_cursor_theme_get_cursor(theme_wrapper_t::c_ptr(), name.c_str());
   if(!cursor)
     throw std::runtime_error("wl_cursor_theme_cursor failed.");
   return cursor_t(cursor, ref_ptr());
 }
 
+bool cursor_theme_t::is_native() const
+{
+  return native_theme(ref_ptr()) != nullptr;
+}
+
+wl_cursor_theme *cursor_theme_t::c_ptr() const
+{
+  check_not_native(ref_ptr());
+  return theme_wrapper_t::c_ptr();
+}
+
+cursor_theme_t::operator wl_cursor_theme*() const
+{
+  return c_ptr();
+}
 
 cursor_t::cursor_t(wl_cursor *c, std::shared_ptr<wl_cursor_theme> t)
   : detail::basic_wrapper<wl_cursor>(c), cursor_theme(std::move(t))
@@ -52,26 +429,38 @@ cursor_t::cursor_t(wl_cursor *c, std::shared_ptr<wl_cursor_theme> t)
 
 unsigned int cursor_t::image_count() const
 {
-  return c_ptr()->image_count;
+  return cursor_wrapper_t::c_ptr()->image_count;
 }
 
 std::string cursor_t::name() const
 {
-  return c_ptr()->name;
+  return cursor_wrapper_t::c_ptr()->name;
 }
 
 cursor_image_t cursor_t::image(unsigned int n) const
 {
   if(n >= image_count())
     throw std::runtime_error("n >= image count");
-  return cursor_image_t(c_ptr()->images[n], cursor_theme);
+  return cursor_image_t(cursor_wrapper_t::c_ptr()->images[n], cursor_theme);
 }
 
 int cursor_t::frame(uint32_t time) const
 {
-  return wl_cursor_frame(c_ptr(), time);
+  if(native_theme(cursor_theme))
+    return native_frame(cursor_wrapper_t::c_ptr(), time);
+  return wl_cursor_frame(cursor_wrapper_t::c_ptr(), time);
 }
 
+wl_cursor *cursor_t::c_ptr() const
+{
+  check_not_native(cursor_theme);
+  return cursor_wrapper_t::c_ptr();
+}
+
+cursor_t::operator wl_cursor*() const
+{
+  return c_ptr();
+}
 
 cursor_image_t::cursor_image_t(wl_cursor_image *image, std::shared_ptr<wl_cursor_theme> t)
   : detail::basic_wrapper<wl_cursor_image>(image), cursor_theme(std::move(t))
@@ -80,32 +469,46 @@ cursor_image_t::cursor_image_t(wl_cursor_image *image, std::shared_ptr<wl_cursor
 
 uint32_t cursor_image_t::width() const
 {
-  return c_ptr()->width;
+  return image_wrapper_t::c_ptr()->width;
 }
 
 uint32_t cursor_image_t::height() const
 {
-  return c_ptr()->height;
+  return image_wrapper_t::c_ptr()->height;
 }
 
 uint32_t cursor_image_t::hotspot_x() const
 {
-  return c_ptr()->hotspot_x;
+  return image_wrapper_t::c_ptr()->hotspot_x;
 }
 
 uint32_t cursor_image_t::hotspot_y() const
 {
-  return c_ptr()->hotspot_y;
+  return image_wrapper_t::c_ptr()->hotspot_y;
 }
 
 uint32_t cursor_image_t::delay() const
 {
-  return c_ptr()->delay;
+  return image_wrapper_t::c_ptr()->delay;
 }
 
 buffer_t cursor_image_t::get_buffer() const
 {
-  wl_buffer *buffer = wl_cursor_image_get_buffer(c_ptr());
+  xcursor_theme_t *native = native_theme(cursor_theme);
+  if(native)
+    return native_get_buffer(*native, image_wrapper_t::c_ptr());
+  wl_buffer *buffer = wl_cursor_image_get_buffer(image_wrapper_t::c_ptr());
   // buffer will be destroyed when cursor_theme is destroyed
   return buffer_t(buffer, proxy_t::wrapper_type::foreign);
 }
+
+wl_cursor_image *cursor_image_t::c_ptr() const
+{
+  check_not_native(cursor_theme);
+  return image_wrapper_t::c_ptr();
+}
+
+cursor_image_t::operator wl_cursor_image*() const
+{
+  return c_ptr();
+}
@@ -0,0 +1,498 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <map>
+#include <pthread.h>
+#include <stdexcept>
+#include <sys/epoll.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <wayland-data-transfer.hpp>
+#include <wayland-util.hpp>
+
+using namespace wayland;
+using namespace wayland::detail;
+
+namespace
+{
+  // bytes moved per system call
+  const std::size_t chunk_size = 1 << 20;
+  // bytes moved per transfer and dispatch, so that one fast transfer
+  // does not starve the others
+  const std::size_t dispatch_budget = 16 << 20;
+  const std::size_t read_size = 64 << 10;
+
+  enum class transfer_kind
+  {
+    receive_memory,
+    receive_file,
+    send_memory,
+    send_file
+  };
+
+  struct transfer_t
+  {
+    transfer_kind kind = transfer_kind::receive_memory;
+    // pipe from or to the other client
+    int fd = -1;
+    // destination or source file
+    int file = -1;
+    std::string data;
+    std::size_t limit = SIZE_MAX;
+    off_t offset = 0;
+    bool use_splice = true;
+    bool use_sendfile = true;
+    transfer_progress_t progress;
+    std::chrono::steady_clock::time_point start;
+    data_transfer_t::done_t done;
+  };
+
+  // Writing to a pipe without reader raises SIGPIPE, which would kill
+  // the application. Block it while writing and discard it afterwards.
+  class sigpipe_guard_t
+  {
+  private:
+    sigset_t old_mask;
+    bool was_pending = false;
+
+    static bool pending()
+    {
+      sigset_t set;
+      sigemptyset(&set);
+      sigpending(&set);
+      return sigismember(&set, SIGPIPE) == 1;
+    }
+
+  public:
+    sigpipe_guard_t()
+    {
+      was_pending = pending();
+      sigset_t set;
+      sigemptyset(&set);
+      sigaddset(&set, SIGPIPE);
+      pthread_sigmask(SIG_BLOCK, &set, &old_mask);
+    }
+
+    ~sigpipe_guard_t()
+    {
+      if(!was_pending && pending())
+      {
+        sigset_t set;
+        sigemptyset(&set);
+        sigaddset(&set, SIGPIPE);
+        timespec zero = { 0, 0 };
+        while(sigtimedwait(&set, nullptr, &zero) < 0 && errno == EINTR)
+          ;
+      }
+      pthread_sigmask(SIG_SETMASK, &old_mask, nullptr);
+    }
+
+    sigpipe_guard_t(const sigpipe_guard_t&) = delete;
+    sigpipe_guard_t &operator=(const sigpipe_guard_t&) = delete;
+  };
+
+  void set_nonblocking(int fd)
+  {
+    int flags = check_return_value(fcntl(fd, F_GETFL), "fcntl");
+    check_return_value(fcntl(fd, F_SETFL, flags | O_NONBLOCK), "fcntl");
+  }
+
+  bool is_pipe(int fd)
+  {
+    struct stat st{};
+    return fstat(fd, &st) == 0 && S_ISFIFO(st.st_mode);
+  }
+
+  // Result of moving a chunk: bytes moved, 0 at the end of the data, or -1
+  // with errno set.
+  ssize_t write_all(int fd, const char *buffer, std::size_t size)
+  {
+    std::size_t written = 0;
+    while(written < size)
+    {
+      ssize_t r = write(fd, buffer + written, size - written);
+      if(r < 0 && errno == EINTR)
+        continue;
+      if(r < 0)
+        return -1;
+      written += static_cast<std::size_t>(r);
+    }
+    return static_cast<ssize_t>(written);
+  }
+
+  // receive: read end of the pipe -> memory or file
+  ssize_t receive_chunk(transfer_t &t)
+  {
+    if(t.kind == transfer_kind::receive_memory)
+    {
+      std::size_t old_size = t.data.size();
+      t.data.resize(old_size + read_size);
+      ssize_t r = read(t.fd, &t.data[old_size], read_size);
+      t.data.resize(old_size + static_cast<std::size_t>(std::max<ssize_t>(r, 0)));
+      if(r > 0 && t.data.size() > t.limit)
+      {
+        errno = EFBIG;
+        return -1;
+      }
+      return r;
+    }
+
+    if(t.use_splice)
+    {
+      ssize_t r = splice(t.fd, nullptr, t.file, nullptr, chunk_size, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+      if(r >= 0 || errno != EINVAL)
+        return r;
+      t.use_splice = false;
+    }
+    char buffer[read_size];
+    ssize_t r = read(t.fd, buffer, sizeof(buffer));
+    if(r <= 0)
+      return r;
+    return write_all(t.file, buffer, static_cast<std::size_t>(r));
+  }
+
+  // send: memory or file -> pipe to the other client
+  ssize_t send_chunk(transfer_t &t)
+  {
+    std::size_t rest = t.progress.total - t.progress.bytes;
+    if(rest == 0)
+      return 0;
+    std::size_t size = std::min(rest, chunk_size);
+
+    if(t.kind == transfer_kind::send_memory)
+      return write(t.fd, t.data.data() + t.progress.bytes, size);
+
+    if(t.use_splice)
+    {
+      ssize_t r = splice(t.file, &t.offset, t.fd, nullptr, size, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+      if(r >= 0 || errno != EINVAL)
+        return r;
+      t.use_splice = false;
+    }
+    if(t.use_sendfile)
+    {
+      ssize_t r = sendfile(t.fd, t.file, &t.offset, size);
+      if(r >= 0 || errno != EINVAL)
+        return r;
+      t.use_sendfile = false;
+    }
+    char buffer[read_size];
+    ssize_t r = pread(t.file, buffer, std::min(size, sizeof(buffer)), t.offset);
+    if(r <= 0)
+      return r;
+    ssize_t w = write(t.fd, buffer, static_cast<std::size_t>(r));
+    if(w > 0)
+      t.offset += w;
+    return w;
+  }
+}
+
+struct wayland::detail::data_transfer_data_t
+{
+  int epoll_fd = -1;
+  uint32_t next_id = 1;
+  std::map<uint32_t, std::unique_ptr<transfer_t>> transfers;
+  std::function<void(uint32_t, const transfer_progress_t&)> on_progress;
+
+  ~data_transfer_data_t()
+  {
+    for(auto &t : transfers)
+      close_fds(*t.second);
+    if(epoll_fd >= 0)
+      close(epoll_fd);
+  }
+
+  static void close_fds(transfer_t &t)
+  {
+    if(t.fd >= 0)
+      close(t.fd);
+    if(t.file >= 0)
+      close(t.file);
+    t.fd = -1;
+    t.file = -1;
+  }
+
+  static transfer_progress_t progress(const transfer_t &t)
+  {
+    transfer_progress_t p = t.progress;
+    p.elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t.start);
+    return p;
+  }
+
+  uint32_t add(std::unique_ptr<transfer_t> t, uint32_t events)
+  {
+    t->start = std::chrono::steady_clock::now();
+    uint32_t id = next_id++;
+    if(next_id == 0)
+      next_id = 1;
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.u32 = id;
+    if(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, t->fd, &ev) < 0)
+    {
+      close_fds(*t);
+      check_return_value(-1, "epoll_ctl");
+    }
+    transfers[id] = std::move(t);
+    return id;
+  }
+
+  void finish(uint32_t id, transfer_status status, int error)
+  {
+    auto it = transfers.find(id);
+    if(it == transfers.end())
+      return;
+    std::unique_ptr<transfer_t> t = std::move(it->second);
+    transfers.erase(it);
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, t->fd, nullptr);
+    close_fds(*t);
+
+    // the engine may be used again from the callback
+    if(t->done)
+    {
+      transfer_result_t result;
+      result.status = status;
+      result.error = error;
+      result.progress = progress(*t);
+      result.data = std::move(t->data);
+      if(t->kind != transfer_kind::receive_memory)
+        result.data.clear();
+      t->done(std::move(result));
+    }
+  }
+
+  // Move data until the pipe blocks or the budget is used up. Returns
+  // true if the transfer is finished.
+  bool step(transfer_t &t, int &error)
+  {
+    bool receive = t.kind == transfer_kind::receive_memory || t.kind == transfer_kind::receive_file;
+    sigpipe_guard_t guard;
+    std::size_t moved = 0;
+    while(moved < dispatch_budget)
+    {
+      ssize_t r = receive ? receive_chunk(t) : send_chunk(t);
+      if(r < 0)
+      {
+        if(errno == EINTR)
+          continue;
+        if(errno == EAGAIN)
+          return false;
+        error = errno;
+        return true;
+      }
+      if(r == 0)
+        return true;
+      moved += static_cast<std::size_t>(r);
+      t.progress.bytes += static_cast<std::size_t>(r);
+    }
+    return false;
+  }
+};
+
+double transfer_progress_t::rate() const
+{
+  double seconds = std::chrono::duration<double>(elapsed).count();
+  return seconds > 0 ? static_cast<double>(bytes) / seconds : 0;
+}
+
+data_transfer_t::data_transfer_t()
+  : data(new data_transfer_data_t)
+{
+  data->epoll_fd = check_return_value(epoll_create1(EPOLL_CLOEXEC), "epoll_create1");
+}
+
+data_transfer_t::~data_transfer_t() = default;
+
+data_transfer_t::data_transfer_t(data_transfer_t&&) noexcept = default;
+
+data_transfer_t &data_transfer_t::operator=(data_transfer_t&&) noexcept = default;
+
+namespace
+{
+  std::unique_ptr<transfer_t> receive_pipe(const std::function<void(int)> &request)
+  {
+    int fds[2];
+    check_return_value(pipe2(fds, O_CLOEXEC), "pipe2");
+    std::unique_ptr<transfer_t> t(new transfer_t);
+    t->fd = fds[0];
+    try
+    {
+      // Only the read end is non-blocking. Status flags are shared with
+      // the other client, which may expect a blocking pipe.
+      set_nonblocking(fds[0]);
+      // larger pipes need fewer wakeups, but the size is limited for users
+      fcntl(fds[0], F_SETPIPE_SZ, static_cast<int>(chunk_size));
+      request(fds[1]);
+    }
+    catch(...)
+    {
+      close(fds[0]);
+      close(fds[1]);
+      throw;
+    }
+    close(fds[1]);
+    return t;
+  }
+}
+
+uint32_t data_transfer_t::receive(const std::function<void(int)> &request, done_t done, std::size_t limit)
+{
+  std::unique_ptr<transfer_t> t = receive_pipe(request);
+  t->kind = transfer_kind::receive_memory;
+  t->limit = limit;
+  t->done = std::move(done);
+  return data->add(std::move(t), EPOLLIN);
+}
+
+uint32_t data_transfer_t::receive(const std::function<void(int)> &request, int fd, done_t done)
+{
+  int file = check_return_value(fcntl(fd, F_DUPFD_CLOEXEC, 0), "fcntl");
+  std::unique_ptr<transfer_t> t;
+  try
+  {
+    t = receive_pipe(request);
+  }
+  catch(...)
+  {
+    close(file);
+    throw;
+  }
+  t->kind = transfer_kind::receive_file;
+  t->file = file;
+  t->done = std::move(done);
+  return data->add(std::move(t), EPOLLIN);
+}
+
+uint32_t data_transfer_t::send(int fd, std::string buffer, done_t done)
+{
+  std::unique_ptr<transfer_t> t(new transfer_t);
+  t->kind = transfer_kind::send_memory;
+  t->fd = fd;
+  t->progress.total = buffer.size();
+  t->data = std::move(buffer);
+  t->done = std::move(done);
+  try
+  {
+    set_nonblocking(fd);
+  }
+  catch(...)
+  {
+    data_transfer_data_t::close_fds(*t);
+    throw;
+  }
+  return data->add(std::move(t), EPOLLOUT);
+}
+
+uint32_t data_transfer_t::send_file(int fd, int file, done_t done)
+{
+  std::unique_ptr<transfer_t> t(new transfer_t);
+  t->kind = transfer_kind::send_file;
+  t->fd = fd;
+  t->done = std::move(done);
+  try
+  {
+    t->file = check_return_value(fcntl(file, F_DUPFD_CLOEXEC, 0), "fcntl");
+    struct stat st{};
+    check_return_value(fstat(t->file, &st), "fstat");
+    t->progress.total = static_cast<std::size_t>(st.st_size);
+    t->use_splice = is_pipe(fd);
+    set_nonblocking(fd);
+  }
+  catch(...)
+  {
+    data_transfer_data_t::close_fds(*t);
+    throw;
+  }
+  return data->add(std::move(t), EPOLLOUT);
+}
+
+void data_transfer_t::cancel(uint32_t id)
+{
+  data->finish(id, transfer_status::cancelled, 0);
+}
+
+void data_transfer_t::cancel_all()
+{
+  while(!data->transfers.empty())
+    data->finish(data->transfers.begin()->first, transfer_status::cancelled, 0);
+}
+
+transfer_progress_t data_transfer_t::get_progress(uint32_t id) const
+{
+  auto it = data->transfers.find(id);
+  if(it == data->transfers.end())
+    throw std::invalid_argument("Unknown data transfer.");
+  return data_transfer_data_t::progress(*it->second);
+}
+
+std::size_t data_transfer_t::size() const
+{
+  return data->transfers.size();
+}
+
+std::function<void(uint32_t, const transfer_progress_t&)> &data_transfer_t::on_progress()
+{
+  return data->on_progress;
+}
+
+int data_transfer_t::get_fd() const
+{
+  return data->epoll_fd;
+}
+
+void data_transfer_t::dispatch()
+{
+  epoll_event events[32];
+  int count = epoll_wait(data->epoll_fd, events, 32, 0);
+  if(count < 0 && errno != EINTR)
+    check_return_value(count, "epoll_wait");
+
+  for(int c = 0; c < count; c++)
+  {
+    uint32_t id = events[c].data.u32;
+    // may have been finished by a callback
+    auto it = data->transfers.find(id);
+    if(it == data->transfers.end())
+      continue;
+    transfer_t &t = *it->second;
+
+    std::size_t before = t.progress.bytes;
+    int error = 0;
+    bool finished = data->step(t, error);
+    if(t.progress.bytes != before && data->on_progress)
+    {
+      data->on_progress(id, data_transfer_data_t::progress(t));
+      if(!data->transfers.count(id))
+        continue;
+    }
+    if(finished)
+      data->finish(id, error ? transfer_status::failed : transfer_status::done, error);
+  }
+}
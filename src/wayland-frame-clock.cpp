@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <list>
+#include <stdexcept>
+#include <vector>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <wayland-frame-clock.hpp>
+
+using namespace wayland;
+using namespace wayland::detail;
+
+namespace
+{
+  // callback intervals above this are pauses, not refresh cycles
+  const std::chrono::nanoseconds max_refresh = std::chrono::milliseconds(250);
+
+  struct frame_clock_entry_t
+  {
+    surface_t surface;
+    std::function<void(const frame_tick_t&)> render;
+    bool scheduled = false;
+  };
+}
+
+struct wayland::detail::frame_clock_data_t
+{
+  surface_t driver;
+  presentation_t presentation;
+  clockid_t clock_id = CLOCK_MONOTONIC;
+  int timer_fd = -1;
+
+  std::vector<std::shared_ptr<frame_clock_entry_t>> entries;
+  callback_t frame_callback;
+  std::list<presentation_feedback_t> feedbacks;
+  bool in_tick = false;
+  bool timer_armed = false;
+  frame_tick_t delayed_tick;
+  std::chrono::nanoseconds render_time{0};
+
+  // last presentation feedback
+  std::chrono::nanoseconds last_presentation{0};
+  std::chrono::nanoseconds presentation_refresh{0};
+  uint64_t last_sequence = 0;
+
+  // refresh estimated from frame callbacks
+  std::chrono::nanoseconds last_callback{0};
+  std::chrono::nanoseconds callback_refresh{0};
+
+  ~frame_clock_data_t()
+  {
+    if(presentation)
+      presentation.on_clock_id() = nullptr;
+    if(timer_fd >= 0)
+      close(timer_fd);
+  }
+
+  std::chrono::nanoseconds now() const
+  {
+    timespec ts{};
+    clock_gettime(clock_id, &ts);
+    return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+  }
+
+  std::chrono::nanoseconds refresh() const
+  {
+    return presentation_refresh.count() ? presentation_refresh : callback_refresh;
+  }
+
+  bool has_scheduled() const
+  {
+    for(const auto &entry : entries)
+      if(entry->scheduled)
+        return true;
+    return false;
+  }
+
+  frame_tick_t predict(uint32_t callback_time)
+  {
+    frame_tick_t tick;
+    tick.callback_time = callback_time;
+    tick.refresh = refresh();
+    std::chrono::nanoseconds time = now();
+
+    if(last_presentation.count() && presentation_refresh.count())
+    {
+      // first refresh after the render time, counted from the last presentation
+      auto cycles = (time + render_time - last_presentation).count() / presentation_refresh.count() + 1;
+      tick.presentation_time = last_presentation + cycles * presentation_refresh;
+      if(last_sequence)
+        tick.sequence = last_sequence + static_cast<uint64_t>(cycles);
+      tick.predicted = true;
+    }
+    else
+      tick.presentation_time = time + tick.refresh;
+
+    tick.deadline = std::max(time, tick.presentation_time - render_time);
+    return tick;
+  }
+
+  void request_frame()
+  {
+    frame_callback = driver.frame();
+    frame_callback.on_done() = [this] (uint32_t time) { frame_done(time); };
+
+    if(presentation)
+    {
+      auto it = feedbacks.insert(feedbacks.end(), presentation.feedback(driver));
+      // The dispatcher holds a reference to the proxy, so it may be erased
+      // from its own event handler.
+      it->on_presented() = [this, it] (uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec,
+                                       uint32_t refresh, uint32_t seq_hi, uint32_t seq_lo,
+                                       presentation_feedback_kind /*flags*/)
+      {
+        auto seconds = (static_cast<uint64_t>(tv_sec_hi) << 32) | tv_sec_lo;
+        std::chrono::nanoseconds time = std::chrono::seconds(seconds) + std::chrono::nanoseconds(tv_nsec);
+        if(time > last_presentation)
+        {
+          last_presentation = time;
+          presentation_refresh = std::chrono::nanoseconds(refresh);
+          last_sequence = (static_cast<uint64_t>(seq_hi) << 32) | seq_lo;
+        }
+        feedbacks.erase(it);
+      };
+      it->on_discarded() = [this, it] () { feedbacks.erase(it); };
+    }
+  }
+
+  void frame_done(uint32_t callback_time)
+  {
+    frame_callback = callback_t();
+
+    std::chrono::nanoseconds time = now();
+    if(last_callback.count() && time - last_callback < max_refresh)
+    {
+      auto interval = time - last_callback;
+      callback_refresh = callback_refresh.count() ? (callback_refresh * 7 + interval) / 8 : interval;
+    }
+    last_callback = time;
+
+    if(!has_scheduled())
+    {
+      // idle until the next schedule()
+      last_callback = std::chrono::nanoseconds(0);
+      return;
+    }
+
+    frame_tick_t next = predict(callback_time);
+    if(render_time.count() && next.refresh.count() && next.deadline > time)
+    {
+      auto delay = next.deadline - time;
+      itimerspec spec{};
+      spec.it_value.tv_sec = static_cast<time_t>(std::chrono::duration_cast<std::chrono::seconds>(delay).count());
+      spec.it_value.tv_nsec = static_cast<long>((delay % std::chrono::seconds(1)).count());
+      check_return_value(timerfd_settime(timer_fd, 0, &spec, nullptr), "timerfd_settime");
+      delayed_tick = next;
+      timer_armed = true;
+    }
+    else
+      tick(next);
+  }
+
+  void tick(const frame_tick_t &frame)
+  {
+    std::vector<std::shared_ptr<frame_clock_entry_t>> due;
+    std::shared_ptr<frame_clock_entry_t> driver_entry;
+    for(auto &entry : entries)
+      if(entry->scheduled)
+      {
+        entry->scheduled = false;
+        if(entry->surface == driver)
+          driver_entry = entry;
+        else
+          due.push_back(entry);
+      }
+    if(due.empty() && !driver_entry)
+      return;
+
+    in_tick = true;
+    request_frame();
+    try
+    {
+      // subsurfaces first, so that the driver commit applies their state
+      for(auto &entry : due)
+        entry->render(frame);
+      if(driver_entry)
+        driver_entry->render(frame);
+      else
+        driver.commit();
+    }
+    catch(...)
+    {
+      in_tick = false;
+      throw;
+    }
+    in_tick = false;
+  }
+};
+
+frame_clock_t::frame_clock_t(surface_t driver, presentation_t presentation)
+  : frame_clock_t(std::move(driver), std::move(presentation), CLOCK_MONOTONIC)
+{
+}
+
+frame_clock_t::frame_clock_t(surface_t driver, presentation_t presentation, clockid_t clock_id)
+  : data(new frame_clock_data_t)
+{
+  data->driver = std::move(driver);
+  data->presentation = std::move(presentation);
+  data->clock_id = clock_id;
+  data->timer_fd = check_return_value(timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK), "timerfd_create");
+  if(data->presentation)
+  {
+    frame_clock_data_t *d = data.get();
+    data->presentation.on_clock_id() = [d] (uint32_t clock_id) { d->clock_id = static_cast<clockid_t>(clock_id); };
+  }
+}
+
+frame_clock_t::~frame_clock_t() = default;
+
+frame_clock_t::frame_clock_t(frame_clock_t&&) noexcept = default;
+
+frame_clock_t &frame_clock_t::operator=(frame_clock_t&&) noexcept = default;
+
+void frame_clock_t::add_surface(surface_t surface, std::function<void(const frame_tick_t&)> render)
+{
+  auto entry = std::make_shared<frame_clock_entry_t>();
+  entry->surface = std::move(surface);
+  entry->render = std::move(render);
+  data->entries.push_back(entry);
+}
+
+void frame_clock_t::remove_surface(const surface_t &surface)
+{
+  auto &entries = data->entries;
+  entries.erase(std::remove_if(entries.begin(), entries.end(),
+                               [&surface] (const std::shared_ptr<frame_clock_entry_t> &entry) { return entry->surface == surface; }),
+                entries.end());
+}
+
+void frame_clock_t::schedule(const surface_t &surface)
+{
+  schedule(std::vector<surface_t>{surface});
+}
+
+void frame_clock_t::schedule(const std::vector<surface_t> &surfaces)
+{
+  for(const auto &surface : surfaces)
+  {
+    auto it = std::find_if(data->entries.begin(), data->entries.end(),
+                           [&surface] (const std::shared_ptr<frame_clock_entry_t> &entry) { return entry->surface == surface; });
+    if(it == data->entries.end())
+      throw std::invalid_argument("Surface is not registered with the frame clock.");
+    (*it)->scheduled = true;
+  }
+
+  // an idle clock ticks right away
+  if(!data->in_tick && !data->frame_callback && !data->timer_armed)
+    data->tick(data->predict(0));
+}
+
+void frame_clock_t::set_render_time(std::chrono::nanoseconds time)
+{
+  data->render_time = std::max(time, std::chrono::nanoseconds(0));
+}
+
+int frame_clock_t::get_fd() const
+{
+  return data->timer_fd;
+}
+
+void frame_clock_t::dispatch()
+{
+  uint64_t expirations = 0;
+  if(read(data->timer_fd, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN)
+    check_return_value(-1, "read");
+  if(data->timer_armed && expirations > 0)
+  {
+    data->timer_armed = false;
+    data->tick(data->delayed_tick);
+  }
+}
+
+clockid_t frame_clock_t::get_clock_id() const
+{
+  return data->clock_id;
+}
+
+std::chrono::nanoseconds frame_clock_t::get_refresh() const
+{
+  return data->refresh();
+}
@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <wayland-gesture-frame.hpp>
+
+using namespace wayland;
+using namespace wayland::detail;
+
+struct wayland::detail::gesture_aggregator_data_t
+{
+  zwp_pointer_gesture_swipe_v1_t swipe;
+  zwp_pointer_gesture_pinch_v1_t pinch;
+  zwp_pointer_gesture_hold_v1_t hold;
+  std::function<void(const gesture_frame_t&)> frame_handler;
+  gesture_frame_t frame = gesture_frame_t();
+  surface_t surface;
+
+  void deliver()
+  {
+    if(frame.valid && frame_handler)
+      frame_handler(frame);
+    // the finger count and the scale carry over to further updates
+    gesture_frame_t next = gesture_frame_t();
+    next.type = frame.type;
+    next.fingers = frame.fingers;
+    next.scale = frame.scale;
+    frame = next;
+  }
+
+  void begin(gesture_type type, uint32_t serial, uint32_t time, surface_t s, uint32_t fingers)
+  {
+    deliver();
+    frame.valid = gesture_frame_t::has_begin;
+    frame.type = type;
+    frame.serial = serial;
+    frame.time = time;
+    frame.fingers = fingers;
+    frame.scale = 1.0;
+    surface = std::move(s);
+  }
+
+  void update(uint32_t time, double dx, double dy)
+  {
+    frame.valid |= gesture_frame_t::has_update;
+    frame.time = time;
+    frame.dx += dx;
+    frame.dy += dy;
+    frame.update_count++;
+  }
+
+  void end(uint32_t serial, uint32_t time, int32_t cancelled)
+  {
+    frame.valid |= gesture_frame_t::has_end;
+    if(cancelled)
+      frame.valid |= gesture_frame_t::has_cancel;
+    frame.serial = serial;
+    frame.time = time;
+    deliver();
+  }
+};
+
+gesture_aggregator_t::gesture_aggregator_t(zwp_pointer_gestures_v1_t gestures, pointer_t pointer)
+  : data(new gesture_aggregator_data_t)
+{
+  gesture_aggregator_data_t *d = data.get();
+
+  d->swipe = gestures.get_swipe_gesture(pointer);
+  d->swipe.on_begin() = [d] (uint32_t serial, uint32_t time, surface_t surface, uint32_t fingers)
+  {
+    d->begin(gesture_type::swipe, serial, time, std::move(surface), fingers);
+  };
+  d->swipe.on_update() = [d] (uint32_t time, double dx, double dy) { d->update(time, dx, dy); };
+  d->swipe.on_end() = [d] (uint32_t serial, uint32_t time, int32_t cancelled) { d->end(serial, time, cancelled); };
+
+  d->pinch = gestures.get_pinch_gesture(pointer);
+  d->pinch.on_begin() = [d] (uint32_t serial, uint32_t time, surface_t surface, uint32_t fingers)
+  {
+    d->begin(gesture_type::pinch, serial, time, std::move(surface), fingers);
+  };
+  d->pinch.on_update() = [d] (uint32_t time, double dx, double dy, double scale, double rotation)
+  {
+    d->update(time, dx, dy);
+    d->frame.scale = scale;
+    d->frame.rotation += rotation;
+  };
+  d->pinch.on_end() = [d] (uint32_t serial, uint32_t time, int32_t cancelled) { d->end(serial, time, cancelled); };
+
+  if(gestures.can_get_hold_gesture())
+  {
+    d->hold = gestures.get_hold_gesture(pointer);
+    d->hold.on_begin() = [d] (uint32_t serial, uint32_t time, surface_t surface, uint32_t fingers)
+    {
+      d->begin(gesture_type::hold, serial, time, std::move(surface), fingers);
+    };
+    d->hold.on_end() = [d] (uint32_t serial, uint32_t time, int32_t cancelled) { d->end(serial, time, cancelled); };
+  }
+}
+
+gesture_aggregator_t::~gesture_aggregator_t() = default;
+
+gesture_aggregator_t::gesture_aggregator_t(gesture_aggregator_t&&) noexcept = default;
+
+gesture_aggregator_t &gesture_aggregator_t::operator=(gesture_aggregator_t&&) noexcept = default;
+
+std::function<void(const gesture_frame_t&)> &gesture_aggregator_t::on_frame()
+{
+  return data->frame_handler;
+}
+
+void gesture_aggregator_t::flush()
+{
+  data->deliver();
+}
+
+surface_t gesture_aggregator_t::get_surface() const
+{
+  return data->surface;
+}
@@ -0,0 +1,469 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <wayland-image-capture.hpp>
+#include <wayland-shm-pool.hpp>
+
+using namespace wayland;
+using namespace wayland::detail;
+
+namespace
+{
+  // regions with more rectangles are merged into their bounding box
+  const std::size_t max_rects = 16;
+
+  // shm formats in the order of preference
+  const shm_format preferred_formats[] = { shm_format::xrgb8888, shm_format::argb8888,
+                                           shm_format::xbgr8888, shm_format::abgr8888 };
+
+  // Small damage region. Overlaps are allowed, so some pixels may be
+  // copied twice, which is cheaper than exact region arithmetic for the
+  // few rectangles compositors send per frame.
+  struct damage_region_t
+  {
+    std::vector<capture_rect_t> rects;
+
+    void add(capture_rect_t rect, int32_t width, int32_t height)
+    {
+      int32_t x2 = std::min(rect.x + rect.width, width);
+      int32_t y2 = std::min(rect.y + rect.height, height);
+      rect.x = std::max(rect.x, 0);
+      rect.y = std::max(rect.y, 0);
+      if(x2 <= rect.x || y2 <= rect.y)
+        return;
+      rect.width = x2 - rect.x;
+      rect.height = y2 - rect.y;
+
+      for(auto &r : rects)
+        if(r.x <= rect.x && r.y <= rect.y && r.x + r.width >= x2 && r.y + r.height >= y2)
+          return;
+      rects.push_back(rect);
+      if(rects.size() > max_rects)
+      {
+        capture_rect_t box = rects.front();
+        for(auto &r : rects)
+        {
+          int32_t bx2 = std::max(box.x + box.width, r.x + r.width);
+          int32_t by2 = std::max(box.y + box.height, r.y + r.height);
+          box.x = std::min(box.x, r.x);
+          box.y = std::min(box.y, r.y);
+          box.width = bx2 - box.x;
+          box.height = by2 - box.y;
+        }
+        rects.assign(1, box);
+      }
+    }
+
+    void add(const damage_region_t &region, int32_t width, int32_t height)
+    {
+      for(auto &r : region.rects)
+        add(r, width, height);
+    }
+
+    void fill(int32_t width, int32_t height)
+    {
+      rects.assign(1, capture_rect_t{0, 0, width, height});
+    }
+  };
+
+  struct capture_buffer_t
+  {
+    shm_pool_buffer_t buffer;
+    // parts that changed since this buffer was captured
+    damage_region_t stale;
+  };
+
+  struct frame_slot_t
+  {
+    std::vector<uint8_t> pixels;
+    // parts that changed since this slot was filled, only used by the producer
+    damage_region_t stale;
+  };
+}
+
+struct wayland::detail::image_capture_data_t
+{
+  shm_t shm;
+  ext_image_copy_capture_session_v1_t session;
+  ext_image_copy_capture_frame_v1_t frame;
+  std::unique_ptr<shm_buffer_pool_t> pool;
+  std::function<void()> on_stopped;
+  int frame_fd = -1;
+  int release_fd = -1;
+  bool stopped = false;
+
+  // constraints
+  uint32_t width = 0;
+  uint32_t height = 0;
+  std::vector<shm_format> formats;
+  shm_format format = shm_format::xrgb8888;
+  uint32_t stride = 0;
+
+  // shm buffer ring
+  std::vector<capture_buffer_t> buffers;
+  std::size_t ring_size = 2;
+  std::size_t next_buffer = 0;
+  std::size_t capturing = 0;
+  damage_region_t damage;
+  output_transform transform = output_transform::normal;
+  std::chrono::nanoseconds presentation_time{0};
+
+  // queue to the consumer
+  std::vector<frame_slot_t> slots;
+  std::vector<captured_frame_t> frames;
+  std::atomic<uint64_t> head{0};
+  std::atomic<uint64_t> tail{0};
+  // damage since the last frame in the queue
+  damage_region_t frame_damage;
+  uint64_t sequence = 0;
+  std::atomic<uint64_t> dropped{0};
+  // last ready frame, if it is not in the queue yet
+  bool pending = false;
+  std::size_t ready_buffer = 0;
+  output_transform ready_transform = output_transform::normal;
+  std::chrono::nanoseconds ready_time{0};
+  // set while the producer waits for a free slot
+  std::atomic<bool> waiting{false};
+
+  ~image_capture_data_t()
+  {
+    if(frame_fd >= 0)
+      close(frame_fd);
+    if(release_fd >= 0)
+      close(release_fd);
+  }
+
+  int32_t w() const
+  {
+    return static_cast<int32_t>(width);
+  }
+
+  int32_t h() const
+  {
+    return static_cast<int32_t>(height);
+  }
+
+  void constraints_done()
+  {
+    shm_format new_format = formats.empty() ? format : formats.front();
+    for(auto f : preferred_formats)
+      if(std::find(formats.begin(), formats.end(), f) != formats.end())
+      {
+        new_format = f;
+        break;
+      }
+    formats.clear();
+
+    if(!buffers.empty() && buffers.front().buffer.get_width() == w()
+       && buffers.front().buffer.get_height() == h() && new_format == format)
+    {
+      if(!frame)
+        capture();
+      return;
+    }
+
+    // cancel the capture into the old buffers
+    frame = ext_image_copy_capture_frame_v1_t();
+    if(pending)
+    {
+      pending = false;
+      dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    buffers.clear();
+    pool.reset();
+    format = new_format;
+    stride = 0;
+    std::size_t bpp = shm_format_bytes_per_pixel(format);
+    if(width == 0 || height == 0 || bpp == 0)
+      return;
+
+    // a new pool of the right size, so it never has to grow
+    std::size_t size = (static_cast<std::size_t>(width) * bpp * height + 63) & ~static_cast<std::size_t>(63);
+    pool.reset(new shm_buffer_pool_t(shm, static_cast<unsigned int>(ring_size), size * ring_size));
+    buffers.resize(ring_size);
+    for(auto &b : buffers)
+    {
+      b.buffer = pool->acquire(w(), h(), format);
+      b.stale.fill(w(), h());
+    }
+    stride = static_cast<uint32_t>(buffers.front().buffer.get_stride());
+    next_buffer = 0;
+    for(auto &slot : slots)
+      slot.stale.fill(w(), h());
+    frame_damage.fill(w(), h());
+    capture();
+  }
+
+  void capture()
+  {
+    if(stopped || buffers.empty())
+      return;
+    capturing = next_buffer;
+    next_buffer = (next_buffer + 1) % buffers.size();
+    capture_buffer_t &buffer = buffers[capturing];
+
+    damage.rects.clear();
+    transform = output_transform::normal;
+    presentation_time = std::chrono::nanoseconds(0);
+    frame = session.create_frame();
+    frame.on_transform() = [this] (output_transform t) { transform = t; };
+    frame.on_damage() = [this] (int32_t x, int32_t y, int32_t width, int32_t height)
+    {
+      damage.add(capture_rect_t{x, y, width, height}, w(), h());
+    };
+    frame.on_presentation_time() = [this] (uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec)
+    {
+      presentation_time = std::chrono::seconds((static_cast<uint64_t>(tv_sec_hi) << 32) | tv_sec_lo)
+        + std::chrono::nanoseconds(tv_nsec);
+    };
+    frame.on_ready() = [this] () { ready(); };
+    frame.on_failed() = [this] (ext_image_copy_capture_frame_v1_failure_reason reason) { failed(reason); };
+    frame.attach_buffer(buffer.buffer.get_buffer());
+    for(auto &r : buffer.stale.rects)
+      frame.damage_buffer(r.x, r.y, r.width, r.height);
+    frame.capture();
+  }
+
+  void ready()
+  {
+    std::size_t index = capturing;
+    // The dispatcher holds a reference to the proxy, so it may be replaced
+    // from its own event handler.
+    frame = ext_image_copy_capture_frame_v1_t();
+    for(std::size_t c = 0; c < buffers.size(); c++)
+    {
+      if(c == index)
+        buffers[c].stale.rects.clear();
+      else
+        buffers[c].stale.add(damage, w(), h());
+    }
+
+    sequence++;
+    if(pending)
+      dropped.fetch_add(1, std::memory_order_relaxed);
+    pending = true;
+    ready_buffer = index;
+    ready_transform = transform;
+    ready_time = presentation_time;
+    frame_damage.add(damage, w(), h());
+    for(auto &slot : slots)
+      slot.stale.add(damage, w(), h());
+
+    // let the compositor fill the next buffer while this one is copied out
+    capture();
+    deliver();
+  }
+
+  void failed(ext_image_copy_capture_frame_v1_failure_reason reason)
+  {
+    frame = ext_image_copy_capture_frame_v1_t();
+    if(reason == ext_image_copy_capture_frame_v1_failure_reason::stopped)
+    {
+      stop();
+      return;
+    }
+    // New constraints are followed by a done event, which restarts the
+    // capture. Other failures are retried with the same buffer.
+    next_buffer = capturing;
+    if(reason != ext_image_copy_capture_frame_v1_failure_reason::buffer_constraints)
+      capture();
+  }
+
+  void stop()
+  {
+    if(stopped)
+      return;
+    stopped = true;
+    frame = ext_image_copy_capture_frame_v1_t();
+    if(on_stopped)
+      on_stopped();
+  }
+
+  bool queue_full()
+  {
+    return head.load(std::memory_order_relaxed) - tail.load() >= slots.size();
+  }
+
+  // copy the last ready frame into a free slot of the queue
+  void deliver()
+  {
+    if(!pending)
+      return;
+    if(queue_full())
+    {
+      // Ask the consumer to wake up the producer. Checking again after
+      // setting the flag makes sure that no release is missed.
+      waiting.store(true);
+      if(queue_full())
+        return;
+    }
+    waiting.store(false);
+
+    uint64_t index = head.load(std::memory_order_relaxed);
+    frame_slot_t &slot = slots[index % slots.size()];
+    captured_frame_t &out = frames[index % slots.size()];
+    if(out.width != width || out.height != height || out.stride != stride || out.format != format)
+    {
+      slot.pixels.resize(static_cast<std::size_t>(stride) * height);
+      slot.stale.fill(w(), h());
+      out.width = width;
+      out.height = height;
+      out.stride = stride;
+      out.format = format;
+    }
+
+    const uint8_t *src = static_cast<const uint8_t*>(buffers[ready_buffer].buffer.get_data());
+    std::size_t bpp = shm_format_bytes_per_pixel(format);
+    for(auto &r : slot.stale.rects)
+      for(int32_t y = r.y; y < r.y + r.height; y++)
+      {
+        std::size_t offset = static_cast<std::size_t>(y) * stride + static_cast<std::size_t>(r.x) * bpp;
+        std::memcpy(slot.pixels.data() + offset, src + offset, static_cast<std::size_t>(r.width) * bpp);
+      }
+    slot.stale.rects.clear();
+
+    out.data = slot.pixels.data();
+    out.transform = ready_transform;
+    out.presentation_time = ready_time;
+    out.damage = frame_damage.rects;
+    out.sequence = sequence;
+    frame_damage.rects.clear();
+    pending = false;
+
+    head.store(index + 1, std::memory_order_release);
+    signal(frame_fd);
+  }
+
+  static void signal(int fd)
+  {
+    uint64_t one = 1;
+    if(write(fd, &one, sizeof(one)) < 0 && errno != EAGAIN)
+      check_return_value(-1, "write");
+  }
+
+  static void reset(int fd)
+  {
+    uint64_t count = 0;
+    if(read(fd, &count, sizeof(count)) < 0 && errno != EAGAIN)
+      check_return_value(-1, "read");
+  }
+};
+
+image_capture_session_t::image_capture_session_t(ext_image_copy_capture_manager_v1_t manager,
+                                                 ext_image_capture_source_v1_t source, shm_t shm,
+                                                 ext_image_copy_capture_manager_v1_options options,
+                                                 unsigned int buffers, unsigned int frames)
+  : data(new image_capture_data_t)
+{
+  if(!manager || !source || !shm)
+    throw std::invalid_argument("Image capture needs a capture manager, a source and wl_shm.");
+  if(buffers < 2 || frames == 0)
+    throw std::invalid_argument("Image capture needs at least two buffers and one frame.");
+
+  data->frame_fd = check_return_value(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK), "eventfd");
+  data->release_fd = check_return_value(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK), "eventfd");
+  data->shm = std::move(shm);
+  data->ring_size = buffers;
+  data->slots.resize(frames);
+  data->frames.resize(frames);
+
+  image_capture_data_t *d = data.get();
+  d->session = manager.create_session(source, options);
+  d->session.on_buffer_size() = [d] (uint32_t width, uint32_t height)
+  {
+    d->width = width;
+    d->height = height;
+  };
+  d->session.on_shm_format() = [d] (shm_format format) { d->formats.push_back(format); };
+  d->session.on_done() = [d] () { d->constraints_done(); };
+  d->session.on_stopped() = [d] () { d->stop(); };
+}
+
+image_capture_session_t::~image_capture_session_t() = default;
+
+image_capture_session_t::image_capture_session_t(image_capture_session_t&&) noexcept = default;
+
+image_capture_session_t &image_capture_session_t::operator=(image_capture_session_t&&) noexcept = default;
+
+std::function<void()> &image_capture_session_t::on_stopped()
+{
+  return data->on_stopped;
+}
+
+bool image_capture_session_t::is_stopped() const
+{
+  return data->stopped;
+}
+
+uint64_t image_capture_session_t::get_dropped() const
+{
+  return data->dropped.load(std::memory_order_relaxed);
+}
+
+const captured_frame_t *image_capture_session_t::acquire_frame()
+{
+  uint64_t t = data->tail.load(std::memory_order_relaxed);
+  if(t == data->head.load(std::memory_order_acquire))
+  {
+    // reset the event before checking again, so no wakeup is lost
+    image_capture_data_t::reset(data->frame_fd);
+    if(t == data->head.load(std::memory_order_acquire))
+      return nullptr;
+  }
+  return &data->frames[t % data->frames.size()];
+}
+
+void image_capture_session_t::release_frame()
+{
+  uint64_t t = data->tail.load(std::memory_order_relaxed);
+  if(t == data->head.load(std::memory_order_acquire))
+    throw std::runtime_error("No captured frame to release.");
+  data->tail.store(t + 1);
+  if(data->waiting.exchange(false))
+    image_capture_data_t::signal(data->release_fd);
+}
+
+int image_capture_session_t::get_frame_fd() const
+{
+  return data->frame_fd;
+}
+
+int image_capture_session_t::get_fd() const
+{
+  return data->release_fd;
+}
+
+void image_capture_session_t::dispatch()
+{
+  image_capture_data_t::reset(data->release_fd);
+  data->deliver();
+}
@@ -0,0 +1,383 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <vector>
+#include <wayland-input-frame.hpp>
+
+using namespace wayland;
+using namespace wayland::detail;
+
+const uint32_t pointer_frame_t::max_buttons;
+const uint32_t touch_frame_t::max_points;
+
+struct wayland::detail::pointer_aggregator_data_t
+{
+  pointer_t pointer;
+  std::function<void(const pointer_frame_t&)> frame_handler;
+  bool framed = false;
+  pointer_frame_t frame = pointer_frame_t();
+  surface_t focus;
+  surface_t left;
+  double x = 0;
+  double y = 0;
+
+  ~pointer_aggregator_data_t()
+  {
+    pointer.on_enter() = nullptr;
+    pointer.on_leave() = nullptr;
+    pointer.on_motion() = nullptr;
+    pointer.on_button() = nullptr;
+    pointer.on_axis() = nullptr;
+    pointer.on_frame() = nullptr;
+    pointer.on_axis_source() = nullptr;
+    pointer.on_axis_stop() = nullptr;
+    pointer.on_axis_discrete() = nullptr;
+    pointer.on_axis_value120() = nullptr;
+    pointer.on_axis_relative_direction() = nullptr;
+  }
+
+  void deliver()
+  {
+    if(frame.valid)
+    {
+      frame.x = x;
+      frame.y = y;
+      if(frame_handler)
+        frame_handler(frame);
+    }
+    frame = pointer_frame_t();
+    left = surface_t();
+  }
+
+  // without frame events, every event is a frame
+  void done()
+  {
+    if(!framed)
+      deliver();
+  }
+
+  pointer_axis_event_t *axis_event(pointer_axis axis)
+  {
+    uint32_t n = static_cast<uint32_t>(axis);
+    if(n > 1)
+      return nullptr;
+    frame.valid |= pointer_frame_t::has_axis;
+    return &frame.axes[n];
+  }
+};
+
+pointer_aggregator_t::pointer_aggregator_t(pointer_t pointer)
+  : data(new pointer_aggregator_data_t)
+{
+  pointer_aggregator_data_t *d = data.get();
+  d->pointer = std::move(pointer);
+  // wl_pointer.frame was added in version 5
+  d->framed = d->pointer.get_version() >= 5;
+
+  d->pointer.on_enter() = [d] (uint32_t serial, surface_t surface, double x, double y)
+  {
+    d->frame.valid |= pointer_frame_t::has_enter;
+    d->frame.serial = serial;
+    d->focus = std::move(surface);
+    d->x = x;
+    d->y = y;
+    d->done();
+  };
+  d->pointer.on_leave() = [d] (uint32_t serial, surface_t)
+  {
+    d->frame.valid |= pointer_frame_t::has_leave;
+    d->frame.serial = serial;
+    d->left = std::move(d->focus);
+    d->focus = surface_t();
+    d->done();
+  };
+  d->pointer.on_motion() = [d] (uint32_t time, double x, double y)
+  {
+    d->frame.valid |= pointer_frame_t::has_motion;
+    d->frame.time = time;
+    d->x = x;
+    d->y = y;
+    d->done();
+  };
+  d->pointer.on_button() = [d] (uint32_t serial, uint32_t time, uint32_t button, pointer_button_state state)
+  {
+    if(d->frame.button_count == pointer_frame_t::max_buttons)
+      d->deliver();
+    d->frame.valid |= pointer_frame_t::has_button;
+    d->frame.time = time;
+    d->frame.buttons[d->frame.button_count++] = pointer_button_event_t{serial, time, button, state};
+    d->done();
+  };
+  d->pointer.on_axis() = [d] (uint32_t time, pointer_axis axis, double value)
+  {
+    pointer_axis_event_t *a = d->axis_event(axis);
+    if(a)
+    {
+      a->valid |= pointer_axis_event_t::has_value;
+      a->time = time;
+      a->value += value;
+      d->frame.time = time;
+    }
+    d->done();
+  };
+  d->pointer.on_frame() = [d] () { d->deliver(); };
+  d->pointer.on_axis_source() = [d] (pointer_axis_source source)
+  {
+    d->frame.valid |= pointer_frame_t::has_axis_source;
+    d->frame.axis_source = source;
+    d->done();
+  };
+  d->pointer.on_axis_stop() = [d] (uint32_t time, pointer_axis axis)
+  {
+    pointer_axis_event_t *a = d->axis_event(axis);
+    if(a)
+    {
+      a->valid |= pointer_axis_event_t::has_stop;
+      a->time = time;
+      d->frame.time = time;
+    }
+    d->done();
+  };
+  d->pointer.on_axis_discrete() = [d] (pointer_axis axis, int32_t discrete)
+  {
+    pointer_axis_event_t *a = d->axis_event(axis);
+    if(a)
+    {
+      a->valid |= pointer_axis_event_t::has_discrete;
+      a->discrete += discrete;
+    }
+    d->done();
+  };
+  d->pointer.on_axis_value120() = [d] (pointer_axis axis, int32_t value120)
+  {
+    pointer_axis_event_t *a = d->axis_event(axis);
+    if(a)
+    {
+      a->valid |= pointer_axis_event_t::has_value120;
+      a->value120 += value120;
+    }
+    d->done();
+  };
+  d->pointer.on_axis_relative_direction() = [d] (pointer_axis axis, pointer_axis_relative_direction direction)
+  {
+    pointer_axis_event_t *a = d->axis_event(axis);
+    if(a)
+    {
+      a->valid |= pointer_axis_event_t::has_relative_direction;
+      a->relative_direction = direction;
+    }
+    d->done();
+  };
+}
+
+pointer_aggregator_t::~pointer_aggregator_t() = default;
+
+pointer_aggregator_t::pointer_aggregator_t(pointer_aggregator_t&&) noexcept = default;
+
+pointer_aggregator_t &pointer_aggregator_t::operator=(pointer_aggregator_t&&) noexcept = default;
+
+std::function<void(const pointer_frame_t&)> &pointer_aggregator_t::on_frame()
+{
+  return data->frame_handler;
+}
+
+surface_t pointer_aggregator_t::get_focus() const
+{
+  return data->focus;
+}
+
+surface_t pointer_aggregator_t::get_left() const
+{
+  return data->left;
+}
+
+namespace
+{
+  struct touch_active_t
+  {
+    int32_t id;
+    surface_t surface;
+    double x;
+    double y;
+  };
+}
+
+struct wayland::detail::touch_aggregator_data_t
+{
+  touch_t touch;
+  std::function<void(const touch_frame_t&)> frame_handler;
+  touch_frame_t frame = touch_frame_t();
+  std::vector<touch_active_t> active;
+
+  ~touch_aggregator_data_t()
+  {
+    touch.on_down() = nullptr;
+    touch.on_up() = nullptr;
+    touch.on_motion() = nullptr;
+    touch.on_frame() = nullptr;
+    touch.on_cancel() = nullptr;
+    touch.on_shape() = nullptr;
+    touch.on_orientation() = nullptr;
+  }
+
+  touch_active_t *find_active(int32_t id)
+  {
+    for(auto &a : active)
+      if(a.id == id)
+        return &a;
+    return nullptr;
+  }
+
+  touch_point_t &point(int32_t id)
+  {
+    for(uint32_t n = 0; n < frame.point_count; n++)
+      if(frame.points[n].id == id)
+        return frame.points[n];
+    if(frame.point_count == touch_frame_t::max_points)
+      deliver();
+    touch_point_t &p = frame.points[frame.point_count++];
+    p.id = id;
+    return p;
+  }
+
+  void deliver()
+  {
+    if(frame.valid || frame.point_count)
+    {
+      // positions are always the current ones
+      for(uint32_t n = 0; n < frame.point_count; n++)
+      {
+        touch_active_t *a = find_active(frame.points[n].id);
+        if(a)
+        {
+          frame.points[n].x = a->x;
+          frame.points[n].y = a->y;
+        }
+      }
+      if(frame_handler)
+        frame_handler(frame);
+    }
+
+    if(frame.valid & touch_frame_t::has_cancel)
+      active.clear();
+    else
+      for(uint32_t n = 0; n < frame.point_count; n++)
+        if(frame.points[n].valid & touch_point_t::has_up)
+          for(auto it = active.begin(); it != active.end(); ++it)
+            if(it->id == frame.points[n].id)
+            {
+              active.erase(it);
+              break;
+            }
+    frame = touch_frame_t();
+  }
+};
+
+touch_aggregator_t::touch_aggregator_t(touch_t touch)
+  : data(new touch_aggregator_data_t)
+{
+  touch_aggregator_data_t *d = data.get();
+  d->touch = std::move(touch);
+
+  d->touch.on_down() = [d] (uint32_t serial, uint32_t time, surface_t surface, int32_t id, double x, double y)
+  {
+    touch_point_t &p = d->point(id);
+    p.valid |= touch_point_t::has_down;
+    p.serial = serial;
+    p.time = time;
+    touch_active_t *a = d->find_active(id);
+    if(!a)
+    {
+      d->active.push_back(touch_active_t{id, surface_t(), 0, 0});
+      a = &d->active.back();
+    }
+    a->surface = std::move(surface);
+    a->x = x;
+    a->y = y;
+  };
+  d->touch.on_up() = [d] (uint32_t serial, uint32_t time, int32_t id)
+  {
+    touch_point_t &p = d->point(id);
+    p.valid |= touch_point_t::has_up;
+    p.serial = serial;
+    p.time = time;
+  };
+  d->touch.on_motion() = [d] (uint32_t time, int32_t id, double x, double y)
+  {
+    touch_point_t &p = d->point(id);
+    p.valid |= touch_point_t::has_motion;
+    p.time = time;
+    touch_active_t *a = d->find_active(id);
+    if(a)
+    {
+      a->x = x;
+      a->y = y;
+    }
+    else
+    {
+      p.x = x;
+      p.y = y;
+    }
+  };
+  d->touch.on_frame() = [d] () { d->deliver(); };
+  // no frame event follows a cancel event
+  d->touch.on_cancel() = [d] ()
+  {
+    d->frame.valid |= touch_frame_t::has_cancel;
+    d->deliver();
+  };
+  d->touch.on_shape() = [d] (int32_t id, double major, double minor)
+  {
+    touch_point_t &p = d->point(id);
+    p.valid |= touch_point_t::has_shape;
+    p.major = major;
+    p.minor = minor;
+  };
+  d->touch.on_orientation() = [d] (int32_t id, double orientation)
+  {
+    touch_point_t &p = d->point(id);
+    p.valid |= touch_point_t::has_orientation;
+    p.orientation = orientation;
+  };
+}
+
+touch_aggregator_t::~touch_aggregator_t() = default;
+
+touch_aggregator_t::touch_aggregator_t(touch_aggregator_t&&) noexcept = default;
+
+touch_aggregator_t &touch_aggregator_t::operator=(touch_aggregator_t&&) noexcept = default;
+
+std::function<void(const touch_frame_t&)> &touch_aggregator_t::on_frame()
+{
+  return data->frame_handler;
+}
+
+surface_t touch_aggregator_t::get_surface(int32_t id) const
+{
+  for(const auto &a : data->active)
+    if(a.id == id)
+      return a.surface;
+  return surface_t();
+}
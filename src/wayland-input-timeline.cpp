@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+#include <wayland-input-timeline.hpp>
+#include <wayland-util.h>
+
+using namespace wayland;
+using namespace wayland::detail;
+
+namespace
+{
+  // keeps the indices of producer and consumer on separate cache lines
+  const std::size_t cache_line = 64;
+}
+
+struct wayland::detail::input_timeline_data_t
+{
+  zwp_relative_pointer_v1_t relative_pointer;
+  zwp_input_timestamps_v1_t timestamps;
+  pointer_t pointer;
+
+  std::vector<input_sample_t> ring;
+  std::size_t mask = 0;
+
+  char pad0[cache_line];
+  std::atomic<uint64_t> head{0};
+  char pad1[cache_line];
+  std::atomic<uint64_t> tail{0};
+  char pad2[cache_line];
+  std::atomic<uint64_t> dropped{0};
+
+  // producer only
+  bool has_timestamp = false;
+  uint64_t timestamp = 0;
+  int32_t carry_dx = 0;
+  int32_t carry_dy = 0;
+  int32_t carry_dx_unaccel = 0;
+  int32_t carry_dy_unaccel = 0;
+
+  ~input_timeline_data_t();
+
+  bool push(const input_sample_t &sample)
+  {
+    uint64_t h = head.load(std::memory_order_relaxed);
+    if(h - tail.load(std::memory_order_acquire) == ring.size())
+    {
+      dropped.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    ring[h & mask] = sample;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  void relative_motion(uint64_t time, double dx, double dy, double dx_unaccel, double dy_unaccel)
+  {
+    // the values were converted from wl_fixed_t, so this is lossless
+    input_sample_t sample = input_sample_t();
+    sample.type = input_sample_type::relative_motion;
+    sample.time = time;
+    sample.dx = wl_fixed_from_double(dx) + carry_dx;
+    sample.dy = wl_fixed_from_double(dy) + carry_dy;
+    sample.dx_unaccel = wl_fixed_from_double(dx_unaccel) + carry_dx_unaccel;
+    sample.dy_unaccel = wl_fixed_from_double(dy_unaccel) + carry_dy_unaccel;
+    if(push(sample))
+      carry_dx = carry_dy = carry_dx_unaccel = carry_dy_unaccel = 0;
+    else
+    {
+      carry_dx = sample.dx;
+      carry_dy = sample.dy;
+      carry_dx_unaccel = sample.dx_unaccel;
+      carry_dy_unaccel = sample.dy_unaccel;
+    }
+  }
+
+  void button(uint32_t time, uint32_t button, pointer_button_state state)
+  {
+    input_sample_t sample = input_sample_t();
+    sample.type = input_sample_type::button;
+    // the timestamp belongs to the last event with a timestamp, which
+    // might not have been a button event
+    if(has_timestamp && static_cast<uint32_t>(timestamp / 1000000) == time)
+      sample.time = timestamp;
+    else
+      sample.time = static_cast<uint64_t>(time) * 1000000;
+    has_timestamp = false;
+    sample.button = button;
+    sample.state = state;
+    push(sample);
+  }
+};
+
+namespace
+{
+  struct button_hook_t
+  {
+    input_timeline_data_t *d;
+    std::function<void(uint32_t, uint32_t, uint32_t, pointer_button_state)> next;
+
+    void operator()(uint32_t serial, uint32_t time, uint32_t button, pointer_button_state state) const
+    {
+      d->button(time, button, state);
+      if(next)
+        next(serial, time, button, state);
+    }
+  };
+}
+
+input_timeline_data_t::~input_timeline_data_t()
+{
+  if(!timestamps)
+    return;
+  timestamps.on_timestamp() = nullptr;
+  const button_hook_t *hook = pointer.on_button().target<button_hook_t>();
+  if(hook && hook->d == this)
+    pointer.on_button() = hook->next;
+}
+
+input_timeline_t::input_timeline_t(zwp_relative_pointer_manager_v1_t manager, pointer_t pointer,
+                                   zwp_input_timestamps_manager_v1_t timestamps, std::size_t capacity)
+  : data(new input_timeline_data_t)
+{
+  if(capacity == 0)
+    throw std::invalid_argument("Input timeline capacity must not be 0.");
+  std::size_t size = 1;
+  while(size < capacity)
+    size <<= 1;
+  data->ring.resize(size);
+  data->mask = size - 1;
+
+  input_timeline_data_t *d = data.get();
+  d->relative_pointer = manager.get_relative_pointer(pointer);
+  d->relative_pointer.on_relative_motion() = [d] (uint32_t utime_hi, uint32_t utime_lo, double dx, double dy,
+                                                  double dx_unaccel, double dy_unaccel)
+  {
+    uint64_t utime = (static_cast<uint64_t>(utime_hi) << 32) | utime_lo;
+    d->relative_motion(utime * 1000, dx, dy, dx_unaccel, dy_unaccel);
+  };
+
+  if(timestamps)
+  {
+    d->pointer = pointer;
+    d->timestamps = timestamps.get_pointer_timestamps(pointer);
+    d->timestamps.on_timestamp() = [d] (uint32_t tv_sec_hi, uint32_t tv_sec_lo, uint32_t tv_nsec)
+    {
+      uint64_t sec = (static_cast<uint64_t>(tv_sec_hi) << 32) | tv_sec_lo;
+      d->timestamp = sec * 1000000000 + tv_nsec;
+      d->has_timestamp = true;
+    };
+    d->pointer.on_button() = button_hook_t{d, d->pointer.on_button()};
+  }
+}
+
+input_timeline_t::~input_timeline_t() = default;
+
+input_timeline_t::input_timeline_t(input_timeline_t&&) noexcept = default;
+
+input_timeline_t &input_timeline_t::operator=(input_timeline_t&&) noexcept = default;
+
+std::size_t input_timeline_t::read(input_sample_t *samples, std::size_t count)
+{
+  uint64_t t = data->tail.load(std::memory_order_relaxed);
+  uint64_t available = data->head.load(std::memory_order_acquire) - t;
+  std::size_t n = static_cast<std::size_t>(std::min<uint64_t>(available, count));
+  for(std::size_t c = 0; c < n; c++)
+    samples[c] = data->ring[(t + c) & data->mask];
+  data->tail.store(t + n, std::memory_order_release);
+  return n;
+}
+
+std::size_t input_timeline_t::size() const
+{
+  return static_cast<std::size_t>(data->head.load(std::memory_order_acquire)
+                                  - data->tail.load(std::memory_order_acquire));
+}
+
+uint64_t input_timeline_t::get_dropped() const
+{
+  return data->dropped.load(std::memory_order_relaxed);
+}
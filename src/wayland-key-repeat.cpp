@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cerrno>
+#include <ctime>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <wayland-key-repeat.hpp>
+#include <wayland-util.hpp>
+
+using namespace wayland;
+using namespace wayland::detail;
+
+namespace
+{
+  const uint64_t ns_per_ms = 1000000;
+
+  uint64_t now()
+  {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000 * ns_per_ms + static_cast<uint64_t>(ts.tv_nsec);
+  }
+}
+
+struct wayland::detail::key_repeat_data_t
+{
+  keyboard_t keyboard;
+  int timer_fd = -1;
+  std::function<void(uint32_t, uint32_t, uint32_t, keyboard_key_state)> key_handler;
+  std::function<void(uint32_t, surface_t)> leave_handler;
+  std::function<void(uint32_t, uint32_t)> repeat_handler;
+  std::function<bool(uint32_t)> filter;
+
+  int32_t rate = 25;
+  int32_t delay = 600;
+
+  // the key being repeated
+  bool held = false;
+  uint32_t key = 0;
+  uint64_t repeats = 0;
+  // due time of the next repeat in the monotonic clock ...
+  uint64_t press_time = 0;
+  uint64_t next_time = 0;
+  // ... and in the time base of the key events
+  uint64_t next_event_time = 0;
+
+  ~key_repeat_data_t()
+  {
+    keyboard.on_key() = nullptr;
+    keyboard.on_leave() = nullptr;
+    keyboard.on_repeat_info() = nullptr;
+    if(timer_fd >= 0)
+      close(timer_fd);
+  }
+
+  uint64_t interval() const
+  {
+    return 1000 * ns_per_ms / static_cast<uint64_t>(rate);
+  }
+
+  void arm(uint64_t time)
+  {
+    itimerspec spec = {};
+    spec.it_value.tv_sec = static_cast<time_t>(time / (1000 * ns_per_ms));
+    spec.it_value.tv_nsec = static_cast<long>(time % (1000 * ns_per_ms));
+    check_return_value(timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr), "timerfd_settime");
+  }
+
+  void stop()
+  {
+    if(!held)
+      return;
+    held = false;
+    // a zero value disarms the timer
+    itimerspec spec = {};
+    check_return_value(timerfd_settime(timer_fd, 0, &spec, nullptr), "timerfd_settime");
+  }
+
+  void press(uint32_t time, uint32_t k)
+  {
+    if(rate <= 0 || (filter && !filter(k)))
+      return;
+    held = true;
+    key = k;
+    repeats = 0;
+    press_time = now();
+    next_time = press_time + static_cast<uint64_t>(delay) * ns_per_ms;
+    next_event_time = (static_cast<uint64_t>(time) + static_cast<uint64_t>(delay)) * ns_per_ms;
+    arm(next_time);
+  }
+
+  void set_info(int32_t new_rate, int32_t new_delay)
+  {
+    uint64_t old_delay = static_cast<uint64_t>(delay) * ns_per_ms;
+    uint64_t old_interval = rate > 0 ? interval() : 0;
+    rate = new_rate;
+    delay = new_delay < 0 ? 0 : new_delay;
+    if(!held)
+      return;
+    if(rate <= 0)
+    {
+      stop();
+      return;
+    }
+
+    // move the pending repeat to the new timing
+    uint64_t new_offset = repeats ? interval() : static_cast<uint64_t>(delay) * ns_per_ms;
+    uint64_t old_offset = repeats ? old_interval : old_delay;
+    next_time = next_time - old_offset + new_offset;
+    next_event_time = next_event_time - old_offset + new_offset;
+    arm(next_time);
+  }
+
+  void fire()
+  {
+    uint64_t t = now();
+    // after a stall, skip all but one second of repeats
+    uint64_t step = interval();
+    if(t > next_time && (t - next_time) / step > static_cast<uint64_t>(rate))
+    {
+      uint64_t skip = (t - next_time) / step - static_cast<uint64_t>(rate);
+      next_time += skip * step;
+      next_event_time += skip * step;
+    }
+
+    while(held && next_time <= t)
+    {
+      uint32_t event_time = static_cast<uint32_t>(next_event_time / ns_per_ms);
+      repeats++;
+      next_time += step;
+      next_event_time += step;
+      if(repeat_handler)
+        repeat_handler(event_time, key);
+      // the handler may have changed the rate
+      if(held)
+        step = interval();
+    }
+    if(held)
+      arm(next_time);
+  }
+};
+
+key_repeat_t::key_repeat_t(keyboard_t keyboard)
+  : data(new key_repeat_data_t)
+{
+  key_repeat_data_t *d = data.get();
+  d->keyboard = std::move(keyboard);
+  d->timer_fd = check_return_value(timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC | TFD_NONBLOCK), "timerfd_create");
+
+  d->keyboard.on_key() = [d] (uint32_t serial, uint32_t time, uint32_t key, keyboard_key_state state)
+  {
+    if(state == keyboard_key_state::pressed)
+      d->press(time, key);
+    else if(d->held && d->key == key)
+      d->stop();
+    if(d->key_handler)
+      d->key_handler(serial, time, key, state);
+  };
+  d->keyboard.on_leave() = [d] (uint32_t serial, surface_t surface)
+  {
+    d->stop();
+    if(d->leave_handler)
+      d->leave_handler(serial, surface);
+  };
+  d->keyboard.on_repeat_info() = [d] (int32_t rate, int32_t delay) { d->set_info(rate, delay); };
+}
+
+key_repeat_t::~key_repeat_t() = default;
+
+key_repeat_t::key_repeat_t(key_repeat_t&&) noexcept = default;
+
+key_repeat_t &key_repeat_t::operator=(key_repeat_t&&) noexcept = default;
+
+std::function<void(uint32_t, uint32_t, uint32_t, keyboard_key_state)> &key_repeat_t::on_key()
+{
+  return data->key_handler;
+}
+
+std::function<void(uint32_t, surface_t)> &key_repeat_t::on_leave()
+{
+  return data->leave_handler;
+}
+
+std::function<void(uint32_t, uint32_t)> &key_repeat_t::on_repeat()
+{
+  return data->repeat_handler;
+}
+
+std::function<bool(uint32_t)> &key_repeat_t::on_filter()
+{
+  return data->filter;
+}
+
+int32_t key_repeat_t::get_rate() const
+{
+  return data->rate;
+}
+
+int32_t key_repeat_t::get_delay() const
+{
+  return data->delay;
+}
+
+void key_repeat_t::cancel()
+{
+  data->stop();
+}
+
+int key_repeat_t::get_fd() const
+{
+  return data->timer_fd;
+}
+
+void key_repeat_t::dispatch()
+{
+  uint64_t expirations = 0;
+  if(read(data->timer_fd, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN)
+    check_return_value(-1, "read");
+  if(expirations > 0)
+    data->fire();
+}
@@ -0,0 +1,240 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <wayland-keymap.hpp>
+#include <wayland-util.hpp>
+
+using namespace wayland;
+using namespace wayland::detail;
+
+struct wayland::detail::keymap_data_t
+{
+  keyboard_keymap_format format = keyboard_keymap_format::no_keymap;
+  const char *map = nullptr;
+  std::size_t size = 0;
+  std::uint64_t hash = 0;
+  std::shared_ptr<const void> compiled;
+
+  ~keymap_data_t()
+  {
+    if(map)
+      munmap(const_cast<char*>(map), size);
+  }
+};
+
+namespace
+{
+  // number of keymaps kept alive without other users
+  const std::size_t recent_max = 4;
+
+  typedef std::pair<keyboard_keymap_format, std::uint64_t> keymap_key_t;
+
+  std::mutex keymap_cache_mutex;
+  std::multimap<keymap_key_t, std::weak_ptr<const keymap_t>> keymap_cache;
+  std::deque<std::shared_ptr<const keymap_t>> keymap_recent;
+
+  std::uint64_t mix(std::uint64_t h)
+  {
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return h;
+  }
+
+  // processes eight bytes per step, keymaps are tens of kilobytes
+  std::uint64_t hash_bytes(const char *data, std::size_t size)
+  {
+    const std::uint64_t k = 0x9e3779b97f4a7c15ULL;
+    std::uint64_t h = size * k;
+    std::size_t n = 0;
+    for(; n + 8 <= size; n += 8)
+    {
+      std::uint64_t w;
+      std::memcpy(&w, data + n, 8);
+      h = (h ^ mix(w)) * k;
+    }
+    std::uint64_t w = 0;
+    std::memcpy(&w, data + n, size - n);
+    h = (h ^ mix(w)) * k;
+    return mix(h);
+  }
+
+  bool same_contents(const keymap_t &keymap, keymap_key_t key, const char *data, std::size_t size)
+  {
+    return keymap.get_format() == key.first && keymap.get_hash() == key.second
+      && keymap.get_size() == size
+      && (size == 0 || std::memcmp(keymap.get_data(), data, size) == 0);
+  }
+
+  // expects the cache to be locked
+  std::shared_ptr<const keymap_t> find(keymap_key_t key, const char *data, std::size_t size)
+  {
+    auto range = keymap_cache.equal_range(key);
+    for(auto it = range.first; it != range.second; ++it)
+    {
+      // the last user may just have released it
+      std::shared_ptr<const keymap_t> keymap = it->second.lock();
+      if(keymap && same_contents(*keymap, key, data, size))
+        return keymap;
+    }
+    return nullptr;
+  }
+
+  // Expects the cache to be locked. Returns the keymap that dropped out
+  // of the recent ones, which must be released after unlocking.
+  std::shared_ptr<const keymap_t> use(const std::shared_ptr<const keymap_t> &keymap)
+  {
+    for(auto it = keymap_recent.begin(); it != keymap_recent.end(); ++it)
+      if(*it == keymap)
+      {
+        keymap_recent.erase(it);
+        break;
+      }
+    keymap_recent.push_front(keymap);
+    std::shared_ptr<const keymap_t> evicted;
+    if(keymap_recent.size() > recent_max)
+    {
+      evicted = std::move(keymap_recent.back());
+      keymap_recent.pop_back();
+    }
+    return evicted;
+  }
+}
+
+keymap_t::keymap_t()
+  : data(new keymap_data_t)
+{
+}
+
+keymap_t::~keymap_t() = default;
+
+keyboard_keymap_format keymap_t::get_format() const
+{
+  return data->format;
+}
+
+const char *keymap_t::get_data() const
+{
+  return data->map;
+}
+
+std::size_t keymap_t::get_size() const
+{
+  return data->size;
+}
+
+std::uint64_t keymap_t::get_hash() const
+{
+  return data->hash;
+}
+
+std::shared_ptr<const void> keymap_t::get_compiled() const
+{
+  return data->compiled;
+}
+
+std::shared_ptr<const keymap_t> keymap_cache_t::get(keyboard_keymap_format format, int fd, uint32_t size,
+                                                    const compile_t &compile)
+{
+  std::shared_ptr<keymap_t> keymap(new keymap_t);
+  keymap_data_t &d = *keymap->data;
+  d.format = format;
+
+  if(format != keyboard_keymap_format::no_keymap)
+  {
+    if(size == 0)
+    {
+      close(fd);
+      throw std::invalid_argument("Empty keymap.");
+    }
+    // the compositor may share the fd between clients, so map it private
+    void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED)
+      check_return_value(-1, "mmap");
+    d.map = static_cast<const char*>(map);
+    d.size = size;
+    d.hash = hash_bytes(d.map, d.size);
+  }
+  else if(fd >= 0)
+    close(fd);
+
+  keymap_key_t key(d.format, d.hash);
+  // unloaded outside of the lock, like in clear()
+  std::shared_ptr<const keymap_t> evicted;
+  {
+    std::lock_guard<std::mutex> lock(keymap_cache_mutex);
+    std::shared_ptr<const keymap_t> cached = find(key, d.map, d.size);
+    if(cached)
+    {
+      evicted = use(cached);
+      return cached;
+    }
+  }
+
+  // compile without holding the lock, it may take a while
+  if(compile)
+    d.compiled = compile(*keymap);
+
+  std::lock_guard<std::mutex> lock(keymap_cache_mutex);
+
+  // forget unloaded keymaps
+  for(auto it = keymap_cache.begin(); it != keymap_cache.end(); )
+    if(it->second.expired())
+      it = keymap_cache.erase(it);
+    else
+      ++it;
+
+  // another thread may have loaded the same keymap in the meantime
+  std::shared_ptr<const keymap_t> cached = find(key, d.map, d.size);
+  if(cached)
+  {
+    evicted = use(cached);
+    return cached;
+  }
+
+  keymap_cache.insert(std::make_pair(key, std::weak_ptr<const keymap_t>(keymap)));
+  evicted = use(keymap);
+  return keymap;
+}
+
+void keymap_cache_t::clear()
+{
+  std::deque<std::shared_ptr<const keymap_t>> recent;
+  {
+    std::lock_guard<std::mutex> lock(keymap_cache_mutex);
+    recent.swap(keymap_recent);
+  }
+  // unloaded outside of the lock
+}
@@ -0,0 +1,316 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <array>
+#include <atomic>
+#include <limits>
+#include <list>
+#include <wayland-output-model.hpp>
+
+using namespace wayland;
+using namespace wayland::detail;
+
+namespace
+{
+  const std::size_t slot_count = 16;
+
+  // the state word holds the index of the current slot in the low bits
+  // and the number of handles given out for it in the high bits
+  const unsigned int index_bits = 8;
+  const uint64_t index_mask = (1u << index_bits) - 1;
+
+  // acquired count of the current slot, which is not known yet
+  const uint64_t current_mark = std::numeric_limits<uint64_t>::max();
+
+  struct tracked_output_t
+  {
+    output_t output;
+    zxdg_output_v1_t xdg_output;
+    output_info_t pending;
+    output_info_t current;
+    bool done = false;
+
+    ~tracked_output_t()
+    {
+      output.on_geometry() = nullptr;
+      output.on_mode() = nullptr;
+      output.on_done() = nullptr;
+      output.on_scale() = nullptr;
+      output.on_name() = nullptr;
+      output.on_description() = nullptr;
+    }
+  };
+}
+
+struct wayland::detail::output_snapshot_slot_t
+{
+  std::vector<output_info_t> outputs;
+  uint64_t serial = 0;
+  std::atomic<uint64_t> acquired{0};
+  std::atomic<uint64_t> released{0};
+
+  // only valid in the dispatching thread
+  bool is_free() const
+  {
+    uint64_t a = acquired.load(std::memory_order_relaxed);
+    return a != current_mark && released.load(std::memory_order_acquire) == a;
+  }
+};
+
+struct wayland::detail::output_model_data_t
+{
+  zxdg_output_manager_v1_t xdg_output_manager;
+  std::list<tracked_output_t> outputs;
+  std::function<void()> change_handler;
+
+  std::array<output_snapshot_slot_t, slot_count> slots;
+  std::atomic<uint64_t> state{0};
+  uint64_t serial = 0;
+  // a change could not be published yet
+  bool dirty = false;
+
+  output_model_data_t()
+  {
+    slots[0].acquired.store(current_mark, std::memory_order_relaxed);
+  }
+
+  void commit(tracked_output_t &t)
+  {
+    retry();
+    t.current = t.pending;
+    t.done = true;
+    publish();
+  }
+
+  // wl_output before version 2 has no done event
+  void changed(tracked_output_t &t)
+  {
+    if(t.output.get_version() < 2)
+      commit(t);
+  }
+
+  void retry()
+  {
+    if(dirty)
+      publish();
+  }
+
+  void publish()
+  {
+    std::size_t current = static_cast<std::size_t>(state.load(std::memory_order_relaxed) & index_mask);
+    std::size_t index = slot_count;
+    for(std::size_t c = 0; c < slot_count; c++)
+      if(c != current && slots[c].is_free())
+      {
+        index = c;
+        break;
+      }
+    // all other snapshots are still held, see retry()
+    if(index == slot_count)
+    {
+      dirty = true;
+      return;
+    }
+    dirty = false;
+
+    output_snapshot_slot_t &slot = slots[index];
+    slot.outputs.clear();
+    for(const auto &t : outputs)
+      if(t.done)
+        slot.outputs.push_back(t.current);
+    slot.serial = ++serial;
+    slot.released.store(0, std::memory_order_relaxed);
+    slot.acquired.store(current_mark, std::memory_order_relaxed);
+
+    uint64_t old = state.exchange(index, std::memory_order_acq_rel);
+    slots[old & index_mask].acquired.store(old >> index_bits, std::memory_order_relaxed);
+
+    if(change_handler)
+      change_handler();
+  }
+};
+
+output_snapshot_t::output_snapshot_t(output_snapshot_slot_t *s)
+  : slot(s)
+{
+}
+
+output_snapshot_t::~output_snapshot_t()
+{
+  if(slot)
+    slot->released.fetch_add(1, std::memory_order_release);
+}
+
+output_snapshot_t::output_snapshot_t(output_snapshot_t &&other) noexcept
+  : slot(other.slot)
+{
+  other.slot = nullptr;
+}
+
+output_snapshot_t &output_snapshot_t::operator=(output_snapshot_t &&other) noexcept
+{
+  if(this != &other)
+  {
+    if(slot)
+      slot->released.fetch_add(1, std::memory_order_release);
+    slot = other.slot;
+    other.slot = nullptr;
+  }
+  return *this;
+}
+
+const std::vector<output_info_t> &output_snapshot_t::outputs() const
+{
+  return slot->outputs;
+}
+
+const output_info_t *output_snapshot_t::find(uint32_t id) const
+{
+  for(const auto &output : slot->outputs)
+    if(output.id == id)
+      return &output;
+  return nullptr;
+}
+
+uint64_t output_snapshot_t::get_serial() const
+{
+  return slot->serial;
+}
+
+output_snapshot_t::operator bool() const
+{
+  return slot != nullptr;
+}
+
+output_model_t::output_model_t(zxdg_output_manager_v1_t xdg_output_manager)
+  : data(new output_model_data_t)
+{
+  data->xdg_output_manager = std::move(xdg_output_manager);
+}
+
+output_model_t::~output_model_t() = default;
+
+output_model_t::output_model_t(output_model_t&&) noexcept = default;
+
+output_model_t &output_model_t::operator=(output_model_t&&) noexcept = default;
+
+void output_model_t::add_output(output_t output)
+{
+  output_model_data_t *d = data.get();
+  d->retry();
+  d->outputs.emplace_back();
+  tracked_output_t *t = &d->outputs.back();
+  t->output = std::move(output);
+  t->pending.id = t->output.get_id();
+
+  t->output.on_geometry() = [d, t] (int32_t x, int32_t y, int32_t physical_width, int32_t physical_height,
+                                    output_subpixel subpixel, const std::string &make, const std::string &model,
+                                    output_transform transform)
+  {
+    t->pending.x = x;
+    t->pending.y = y;
+    t->pending.physical_width = physical_width;
+    t->pending.physical_height = physical_height;
+    t->pending.subpixel = subpixel;
+    t->pending.make = make;
+    t->pending.model = model;
+    t->pending.transform = transform;
+    d->changed(*t);
+  };
+  t->output.on_mode() = [d, t] (output_mode flags, int32_t width, int32_t height, int32_t refresh)
+  {
+    if(!(flags & output_mode::current))
+      return;
+    t->pending.width = width;
+    t->pending.height = height;
+    t->pending.refresh = refresh;
+    d->changed(*t);
+  };
+  t->output.on_scale() = [t] (int32_t scale) { t->pending.scale = scale; };
+  t->output.on_name() = [t] (const std::string &name) { t->pending.name = name; };
+  t->output.on_description() = [t] (const std::string &description) { t->pending.description = description; };
+  t->output.on_done() = [d, t] () { d->commit(*t); };
+
+  if(d->xdg_output_manager)
+  {
+    t->xdg_output = d->xdg_output_manager.get_xdg_output(t->output);
+    t->xdg_output.on_logical_position() = [t] (int32_t x, int32_t y)
+    {
+      t->pending.has_logical = true;
+      t->pending.logical_x = x;
+      t->pending.logical_y = y;
+    };
+    t->xdg_output.on_logical_size() = [t] (int32_t width, int32_t height)
+    {
+      t->pending.has_logical = true;
+      t->pending.logical_width = width;
+      t->pending.logical_height = height;
+    };
+    // deprecated since version 3, where wl_output.done follows instead
+    t->xdg_output.on_done() = [d, t] () { d->commit(*t); };
+    // older wl_output versions lack these
+    t->xdg_output.on_name() = [t] (const std::string &name)
+    {
+      if(t->pending.name.empty())
+        t->pending.name = name;
+    };
+    t->xdg_output.on_description() = [t] (const std::string &description)
+    {
+      if(t->pending.description.empty())
+        t->pending.description = description;
+    };
+  }
+}
+
+void output_model_t::remove_output(const output_t &output)
+{
+  data->retry();
+  for(auto it = data->outputs.begin(); it != data->outputs.end(); ++it)
+    if(it->output == output)
+    {
+      bool done = it->done;
+      data->outputs.erase(it);
+      if(done)
+        data->publish();
+      return;
+    }
+}
+
+bool output_model_t::flush()
+{
+  data->retry();
+  return !data->dirty;
+}
+
+output_snapshot_t output_model_t::get_snapshot() const
+{
+  uint64_t state = data->state.fetch_add(uint64_t(1) << index_bits, std::memory_order_acq_rel);
+  return output_snapshot_t(&data->slots[state & index_mask]);
+}
+
+std::function<void()> &output_model_t::on_change()
+{
+  return data->change_handler;
+}
@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <list>
+#include <stdexcept>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <wayland-presentation-queue.hpp>
+
+using namespace wayland;
+using namespace wayland::detail;
+
+namespace
+{
+  // refresh assumed until frame callbacks give a better estimate
+  const std::chrono::nanoseconds default_refresh = std::chrono::nanoseconds(16666667);
+  // callback intervals above this are pauses, not refresh cycles
+  const std::chrono::nanoseconds max_refresh = std::chrono::milliseconds(250);
+
+  struct queued_frame_t
+  {
+    buffer_t buffer;
+    shm_pool_buffer_t shm_buffer;
+    std::chrono::nanoseconds target;
+  };
+}
+
+struct wayland::detail::presentation_queue_data_t
+{
+  surface_t surface;
+  fifo_v1_t fifo;
+  commit_timer_v1_t timer;
+  std::size_t depth = 3;
+  clockid_t clock = CLOCK_MONOTONIC;
+  int timer_fd = -1;
+  std::function<void()> on_ready;
+  std::function<void(buffer_t)> on_discard;
+
+  std::deque<queued_frame_t> frames;
+  // frame callbacks of committed frames that are not presented yet
+  std::list<callback_t> callbacks;
+
+  // frame callback pacing
+  std::chrono::nanoseconds last_callback{0};
+  std::chrono::nanoseconds refresh = default_refresh;
+
+  ~presentation_queue_data_t()
+  {
+    if(timer_fd >= 0)
+      close(timer_fd);
+  }
+
+  std::chrono::nanoseconds now() const
+  {
+    timespec ts{};
+    clock_gettime(clock, &ts);
+    return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+  }
+
+  std::size_t size() const
+  {
+    return frames.size() + callbacks.size();
+  }
+
+  void arm(std::chrono::nanoseconds time)
+  {
+    itimerspec spec{};
+    if(time.count() > 0)
+    {
+      spec.it_value.tv_sec = static_cast<time_t>(std::chrono::duration_cast<std::chrono::seconds>(time).count());
+      spec.it_value.tv_nsec = static_cast<long>((time % std::chrono::seconds(1)).count());
+    }
+    check_return_value(timerfd_settime(timer_fd, TFD_TIMER_ABSTIME, &spec, nullptr), "timerfd_settime");
+  }
+
+  void discard(queued_frame_t &frame)
+  {
+    if(frame.shm_buffer)
+      frame.shm_buffer.discard();
+    if(on_discard)
+      on_discard(frame.buffer);
+  }
+
+  void commit(const queued_frame_t &frame)
+  {
+    surface.attach(frame.buffer, 0, 0);
+    const int32_t max = std::numeric_limits<int32_t>::max();
+    if(surface.can_damage_buffer())
+      surface.damage_buffer(0, 0, max, max);
+    else
+      surface.damage(0, 0, max, max);
+    if(timer)
+    {
+      auto seconds = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(frame.target).count());
+      auto nanoseconds = static_cast<uint32_t>((frame.target % std::chrono::seconds(1)).count());
+      timer.set_timestamp(static_cast<uint32_t>(seconds >> 32), static_cast<uint32_t>(seconds), nanoseconds);
+      if(fifo)
+      {
+        fifo.wait_barrier();
+        fifo.set_barrier();
+      }
+    }
+
+    // The dispatcher holds a reference to the proxy, so it may be erased
+    // from its own event handler.
+    auto it = callbacks.insert(callbacks.end(), surface.frame());
+    it->on_done() = [this, it] (uint32_t /*time*/)
+    {
+      bool was_full = size() >= depth;
+      callbacks.erase(it);
+      presented();
+      if(was_full && size() < depth && on_ready)
+        on_ready();
+    };
+    surface.commit();
+  }
+
+  void presented()
+  {
+    if(timer)
+    {
+      submit();
+      return;
+    }
+    std::chrono::nanoseconds time = now();
+    if(last_callback.count() && time - last_callback < max_refresh)
+      refresh = (refresh * 7 + (time - last_callback)) / 8;
+    last_callback = time;
+    submit();
+  }
+
+  void submit()
+  {
+    if(timer)
+    {
+      // the compositor takes care of the timing
+      while(!frames.empty())
+      {
+        commit(frames.front());
+        frames.pop_front();
+      }
+      return;
+    }
+
+    // one frame per refresh cycle
+    if(!callbacks.empty() || frames.empty())
+      return;
+    std::chrono::nanoseconds deadline = now() + refresh / 2;
+    auto due = std::upper_bound(frames.begin(), frames.end(), deadline,
+                                [] (std::chrono::nanoseconds time, const queued_frame_t &frame) { return time < frame.target; });
+    if(due == frames.begin())
+    {
+      arm(frames.front().target - refresh / 2);
+      return;
+    }
+    // show the latest due frame and drop the older ones
+    queued_frame_t frame = *(due - 1);
+    std::deque<queued_frame_t> dropped(frames.begin(), due - 1);
+    frames.erase(frames.begin(), due);
+    arm(std::chrono::nanoseconds(0));
+    commit(frame);
+    for(auto &d : dropped)
+      discard(d);
+    if(!dropped.empty() && on_ready)
+      on_ready();
+  }
+
+  bool queue(queued_frame_t frame)
+  {
+    if(size() >= depth)
+      return false;
+    auto pos = std::upper_bound(frames.begin(), frames.end(), frame.target,
+                                [] (std::chrono::nanoseconds time, const queued_frame_t &f) { return time < f.target; });
+    frames.insert(pos, frame);
+    submit();
+    return true;
+  }
+};
+
+presentation_queue_t::presentation_queue_t(surface_t surface, fifo_manager_v1_t fifo,
+                                           commit_timing_manager_v1_t timing, std::size_t depth, clockid_t clock)
+  : data(new presentation_queue_data_t)
+{
+  if(depth == 0)
+    throw std::invalid_argument("Presentation queue depth must be positive.");
+  data->surface = std::move(surface);
+  data->depth = depth;
+  data->clock = clock;
+  data->timer_fd = check_return_value(timerfd_create(clock, TFD_CLOEXEC | TFD_NONBLOCK), "timerfd_create");
+  if(timing)
+  {
+    data->timer = timing.get_timer(data->surface);
+    if(fifo)
+      data->fifo = fifo.get_fifo(data->surface);
+  }
+}
+
+presentation_queue_t::~presentation_queue_t() = default;
+
+presentation_queue_t::presentation_queue_t(presentation_queue_t&&) noexcept = default;
+
+presentation_queue_t &presentation_queue_t::operator=(presentation_queue_t&&) noexcept = default;
+
+bool presentation_queue_t::queue(buffer_t buffer, std::chrono::nanoseconds target)
+{
+  queued_frame_t frame;
+  frame.buffer = std::move(buffer);
+  frame.target = target;
+  return data->queue(frame);
+}
+
+bool presentation_queue_t::queue(shm_pool_buffer_t buffer, std::chrono::nanoseconds target)
+{
+  queued_frame_t frame;
+  frame.buffer = buffer.get_buffer();
+  frame.shm_buffer = std::move(buffer);
+  frame.target = target;
+  return data->queue(frame);
+}
+
+void presentation_queue_t::flush()
+{
+  bool was_full = full();
+  std::deque<queued_frame_t> dropped;
+  dropped.swap(data->frames);
+  data->arm(std::chrono::nanoseconds(0));
+  for(auto &frame : dropped)
+    data->discard(frame);
+  if(was_full && !full() && data->on_ready)
+    data->on_ready();
+}
+
+bool presentation_queue_t::full() const
+{
+  return data->size() >= data->depth;
+}
+
+std::size_t presentation_queue_t::size() const
+{
+  return data->size();
+}
+
+bool presentation_queue_t::is_timed() const
+{
+  return !!data->timer;
+}
+
+std::function<void()> &presentation_queue_t::on_ready()
+{
+  return data->on_ready;
+}
+
+std::function<void(buffer_t)> &presentation_queue_t::on_discard()
+{
+  return data->on_discard;
+}
+
+int presentation_queue_t::get_fd() const
+{
+  return data->timer_fd;
+}
+
+void presentation_queue_t::dispatch()
+{
+  uint64_t expirations = 0;
+  if(read(data->timer_fd, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN)
+    check_return_value(-1, "read");
+  if(expirations > 0)
+    data->submit();
+}
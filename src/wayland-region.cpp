@@ -0,0 +1,517 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <wayland-region.hpp>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+using namespace wayland;
+
+static_assert(sizeof(rect_t) == 4 * sizeof(int32_t), "rect_t must be four packed integers");
+
+namespace
+{
+  // index one past the band starting at i
+  std::size_t band_end(const std::vector<rect_t> &rects, std::size_t i)
+  {
+    std::size_t end = i + 1;
+    while(end < rects.size() && rects[end].y1 == rects[i].y1)
+      end++;
+    return end;
+  }
+
+  // append a band, merging it with the previous band if they are equal and touch
+  void append_band(std::vector<rect_t> &rects, std::size_t &last_band, const std::vector<rect_t> &band)
+  {
+    if(band.empty())
+      return;
+    std::size_t last_size = rects.size() - last_band;
+    if(last_size == band.size() && rects[last_band].y2 == band.front().y1)
+    {
+      bool equal = true;
+      for(std::size_t i = 0; i < last_size && equal; i++)
+        equal = rects[last_band + i].x1 == band[i].x1 && rects[last_band + i].x2 == band[i].x2;
+      if(equal)
+      {
+        for(std::size_t i = last_band; i < rects.size(); i++)
+          rects[i].y2 = band.front().y2;
+        return;
+      }
+    }
+    last_band = rects.size();
+    rects.insert(rects.end(), band.begin(), band.end());
+  }
+
+  uint64_t rect_area(const rect_t &r)
+  {
+    return static_cast<uint64_t>(r.width()) * static_cast<uint64_t>(r.height());
+  }
+
+  rect_t rect_extents(const rect_t &a, const rect_t &b)
+  {
+    return { std::min(a.x1, b.x1), std::min(a.y1, b.y1), std::max(a.x2, b.x2), std::max(a.y2, b.y2) };
+  }
+}
+
+rect_t rect_t::from_size(int32_t x, int32_t y, int32_t width, int32_t height)
+{
+  return { x, y, x + width, y + height };
+}
+
+int32_t rect_t::width() const
+{
+  return x2 - x1;
+}
+
+int32_t rect_t::height() const
+{
+  return y2 - y1;
+}
+
+bool rect_t::empty() const
+{
+  return x2 <= x1 || y2 <= y1;
+}
+
+bool rect_t::contains(int32_t x, int32_t y) const
+{
+  return x >= x1 && x < x2 && y >= y1 && y < y2;
+}
+
+bool rect_t::intersects(const rect_t &r) const
+{
+  return !empty() && !r.empty() && x1 < r.x2 && r.x1 < x2 && y1 < r.y2 && r.y1 < y2;
+}
+
+bool rect_t::operator==(const rect_t &r) const
+{
+  return x1 == r.x1 && y1 == r.y1 && x2 == r.x2 && y2 == r.y2;
+}
+
+bool rect_t::operator!=(const rect_t &r) const
+{
+  return !(*this == r);
+}
+
+//-----------------------------------------------------------------------------
+
+rect_set_t::rect_set_t(const rect_t &rect)
+{
+  if(!rect.empty())
+    rects.push_back(rect);
+}
+
+rect_set_t::rect_set_t(const std::vector<rect_t> &input)
+{
+  std::vector<rect_t> sorted;
+  sorted.reserve(input.size());
+  for(const auto &rect : input)
+    if(!rect.empty())
+      sorted.push_back(rect);
+  if(sorted.empty())
+    return;
+  // neighbours in y order are likely to merge, which keeps the partial results small
+  std::sort(sorted.begin(), sorted.end(), [] (const rect_t &a, const rect_t &b)
+            { return a.y1 < b.y1 || (a.y1 == b.y1 && a.x1 < b.x1); });
+
+  // unite pairwise, doubling the width of the pairs in each pass
+  std::vector<rect_set_t> sets(sorted.begin(), sorted.end());
+  while(sets.size() > 1)
+  {
+    std::vector<rect_set_t> merged;
+    merged.reserve((sets.size() + 1) / 2);
+    for(std::size_t i = 0; i + 1 < sets.size(); i += 2)
+      merged.push_back(combine(sets[i], sets[i + 1], op_t::unite));
+    if(sets.size() % 2)
+      merged.push_back(std::move(sets.back()));
+    sets.swap(merged);
+  }
+  rects = std::move(sets.front().rects);
+}
+
+rect_set_t rect_set_t::combine(const rect_set_t &a, const rect_set_t &b, op_t op)
+{
+  // trivial cases
+  if(a.empty() || b.empty())
+  {
+    if(op == op_t::intersect || (op == op_t::subtract && a.empty()))
+      return rect_set_t();
+    return a.empty() ? b : a;
+  }
+  if(op != op_t::unite && !a.extents().intersects(b.extents()))
+    return op == op_t::intersect ? rect_set_t() : a;
+
+  // all band boundaries
+  std::vector<int32_t> ys;
+  ys.reserve(2 * (a.rects.size() + b.rects.size()));
+  for(const auto *set : { &a, &b })
+    for(std::size_t i = 0; i < set->rects.size(); i = band_end(set->rects, i))
+    {
+      ys.push_back(set->rects[i].y1);
+      ys.push_back(set->rects[i].y2);
+    }
+  std::sort(ys.begin(), ys.end());
+  ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+
+  rect_set_t result;
+  std::size_t last_band = 0;
+  std::vector<rect_t> band;
+  std::size_t ia = 0;
+  std::size_t ib = 0;
+  for(std::size_t k = 0; k + 1 < ys.size(); k++)
+  {
+    int32_t y1 = ys[k];
+    int32_t y2 = ys[k + 1];
+    while(ia < a.rects.size() && a.rects[ia].y2 <= y1)
+      ia = band_end(a.rects, ia);
+    while(ib < b.rects.size() && b.rects[ib].y2 <= y1)
+      ib = band_end(b.rects, ib);
+    std::size_t ea = ia < a.rects.size() && a.rects[ia].y1 <= y1 ? band_end(a.rects, ia) : ia;
+    std::size_t eb = ib < b.rects.size() && b.rects[ib].y1 <= y1 ? band_end(b.rects, ib) : ib;
+    if(ea == ia && eb == ib)
+      continue;
+
+    // sweep over the x boundaries of both bands
+    band.clear();
+    std::size_t na = 2 * (ea - ia);
+    std::size_t nb = 2 * (eb - ib);
+    std::size_t i = 0;
+    std::size_t j = 0;
+    bool in_a = false;
+    bool in_b = false;
+    bool inside = false;
+    int32_t start = 0;
+    while(i < na || j < nb)
+    {
+      const int32_t none = std::numeric_limits<int32_t>::max();
+      int32_t xa = i < na ? (i % 2 ? a.rects[ia + i / 2].x2 : a.rects[ia + i / 2].x1) : none;
+      int32_t xb = j < nb ? (j % 2 ? b.rects[ib + j / 2].x2 : b.rects[ib + j / 2].x1) : none;
+      int32_t x = std::min(xa, xb);
+      if(xa == x)
+      {
+        in_a = !in_a;
+        i++;
+      }
+      if(xb == x)
+      {
+        in_b = !in_b;
+        j++;
+      }
+
+      bool now = false;
+      switch(op)
+      {
+      case op_t::unite:
+        now = in_a || in_b;
+        break;
+      case op_t::intersect:
+        now = in_a && in_b;
+        break;
+      case op_t::subtract:
+        now = in_a && !in_b;
+        break;
+      }
+      if(now && !inside)
+        start = x;
+      else if(!now && inside)
+        band.push_back({ start, y1, x, y2 });
+      inside = now;
+    }
+    append_band(result.rects, last_band, band);
+  }
+  return result;
+}
+
+bool rect_set_t::empty() const
+{
+  return rects.empty();
+}
+
+std::size_t rect_set_t::size() const
+{
+  return rects.size();
+}
+
+rect_set_t::const_iterator rect_set_t::begin() const
+{
+  return rects.begin();
+}
+
+rect_set_t::const_iterator rect_set_t::end() const
+{
+  return rects.end();
+}
+
+const std::vector<rect_t> &rect_set_t::get_rects() const
+{
+  return rects;
+}
+
+rect_t rect_set_t::extents() const
+{
+  if(rects.empty())
+    return { 0, 0, 0, 0 };
+
+  // Minimum of (x1, y1, ~x2, ~y2). Bitwise not reverses the order, so the
+  // last two lanes end up holding the maximum of x2 and y2.
+  const rect_t *r = rects.data();
+  std::size_t n = rects.size();
+#if defined(__SSE2__)
+  const __m128i flip = _mm_set_epi32(-1, -1, 0, 0);
+  __m128i acc = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(r)), flip);
+  for(std::size_t i = 1; i < n; i++)
+  {
+    __m128i v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(r + i)), flip);
+    __m128i greater = _mm_cmpgt_epi32(acc, v);
+    acc = _mm_or_si128(_mm_and_si128(greater, v), _mm_andnot_si128(greater, acc));
+  }
+  acc = _mm_xor_si128(acc, flip);
+  rect_t e;
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(&e), acc);
+  return e;
+#elif defined(__ARM_NEON)
+  const int32x4_t flip = { 0, 0, -1, -1 };
+  int32x4_t acc = veorq_s32(vld1q_s32(&r->x1), flip);
+  for(std::size_t i = 1; i < n; i++)
+    acc = vminq_s32(acc, veorq_s32(vld1q_s32(&r[i].x1), flip));
+  acc = veorq_s32(acc, flip);
+  rect_t e;
+  vst1q_s32(&e.x1, acc);
+  return e;
+#else
+  rect_t e = r[0];
+  for(std::size_t i = 1; i < n; i++)
+    e = rect_extents(e, r[i]);
+  return e;
+#endif
+}
+
+uint64_t rect_set_t::area() const
+{
+  uint64_t sum = 0;
+  for(const auto &rect : rects)
+    sum += rect_area(rect);
+  return sum;
+}
+
+bool rect_set_t::contains(int32_t x, int32_t y) const
+{
+  // y2 is sorted as well, since bands do not overlap
+  auto it = std::partition_point(rects.begin(), rects.end(), [y] (const rect_t &r) { return r.y2 <= y; });
+  for(; it != rects.end() && it->y1 <= y; ++it)
+    if(it->contains(x, y))
+      return true;
+  return false;
+}
+
+bool rect_set_t::intersects(const rect_t &rect) const
+{
+  if(rect.empty())
+    return false;
+  auto it = std::partition_point(rects.begin(), rects.end(), [&rect] (const rect_t &r) { return r.y2 <= rect.y1; });
+  for(; it != rects.end() && it->y1 < rect.y2; ++it)
+    if(it->intersects(rect))
+      return true;
+  return false;
+}
+
+void rect_set_t::clear()
+{
+  rects.clear();
+}
+
+void rect_set_t::translate(int32_t dx, int32_t dy)
+{
+  rect_t *r = rects.data();
+  std::size_t n = rects.size();
+#if defined(__SSE2__)
+  const __m128i offset = _mm_set_epi32(dy, dx, dy, dx);
+  for(std::size_t i = 0; i < n; i++)
+  {
+    auto *p = reinterpret_cast<__m128i*>(r + i);
+    _mm_storeu_si128(p, _mm_add_epi32(_mm_loadu_si128(p), offset));
+  }
+#elif defined(__ARM_NEON)
+  const int32x4_t offset = { dx, dy, dx, dy };
+  for(std::size_t i = 0; i < n; i++)
+    vst1q_s32(&r[i].x1, vaddq_s32(vld1q_s32(&r[i].x1), offset));
+#else
+  for(std::size_t i = 0; i < n; i++)
+  {
+    r[i].x1 += dx;
+    r[i].y1 += dy;
+    r[i].x2 += dx;
+    r[i].y2 += dy;
+  }
+#endif
+}
+
+void rect_set_t::simplify(std::size_t max_rects)
+{
+  max_rects = std::max<std::size_t>(max_rects, 1);
+  if(rects.size() <= max_rects)
+    return;
+
+  // one rectangle per band
+  std::vector<rect_t> bands;
+  for(std::size_t i = 0; i < rects.size();)
+  {
+    std::size_t end = band_end(rects, i);
+    bands.push_back({ rects[i].x1, rects[i].y1, rects[end - 1].x2, rects[i].y2 });
+    i = end;
+  }
+
+  // greedily merge the neighbours whose merge adds the least area
+  if(bands.size() > max_rects)
+  {
+    std::size_t count = bands.size();
+    std::vector<std::size_t> next(count);
+    std::vector<std::size_t> prev(count);
+    std::vector<unsigned int> version(count, 0);
+    std::vector<bool> alive(count, true);
+    for(std::size_t i = 0; i < count; i++)
+    {
+      next[i] = i + 1;
+      prev[i] = i - 1; // wraps for the first band, which is never used
+    }
+
+    struct candidate_t
+    {
+      uint64_t cost;
+      std::size_t first;
+      unsigned int version_first;
+      unsigned int version_second;
+      bool operator<(const candidate_t &c) const { return cost > c.cost; }
+    };
+    auto cost = [&bands] (std::size_t i, std::size_t j)
+    {
+      return rect_area(rect_extents(bands[i], bands[j])) - rect_area(bands[i]) - rect_area(bands[j]);
+    };
+
+    std::priority_queue<candidate_t> queue;
+    for(std::size_t i = 0; i + 1 < count; i++)
+      queue.push({ cost(i, i + 1), i, 0, 0 });
+
+    std::size_t remaining = count;
+    while(remaining > max_rects)
+    {
+      candidate_t c = queue.top();
+      queue.pop();
+      std::size_t i = c.first;
+      if(!alive[i] || next[i] >= count)
+        continue;
+      std::size_t j = next[i];
+      if(version[i] != c.version_first || version[j] != c.version_second)
+        continue;
+
+      bands[i] = rect_extents(bands[i], bands[j]);
+      alive[j] = false;
+      version[i]++;
+      next[i] = next[j];
+      if(next[j] < count)
+        prev[next[j]] = i;
+      remaining--;
+
+      if(i > 0 && prev[i] < count)
+        queue.push({ cost(prev[i], i), prev[i], version[prev[i]], version[i] });
+      if(next[i] < count)
+        queue.push({ cost(i, next[i]), i, version[i], version[next[i]] });
+    }
+
+    std::vector<rect_t> merged;
+    for(std::size_t i = 0; i < count; i++)
+      if(alive[i])
+        merged.push_back(bands[i]);
+    bands.swap(merged);
+  }
+
+  rects.clear();
+  std::size_t last_band = 0;
+  for(const auto &band : bands)
+    append_band(rects, last_band, std::vector<rect_t>(1, band));
+}
+
+rect_set_t &rect_set_t::operator|=(const rect_set_t &r)
+{
+  *this = combine(*this, r, op_t::unite);
+  return *this;
+}
+
+rect_set_t &rect_set_t::operator&=(const rect_set_t &r)
+{
+  *this = combine(*this, r, op_t::intersect);
+  return *this;
+}
+
+rect_set_t &rect_set_t::operator-=(const rect_set_t &r)
+{
+  *this = combine(*this, r, op_t::subtract);
+  return *this;
+}
+
+rect_set_t rect_set_t::operator|(const rect_set_t &r) const
+{
+  return combine(*this, r, op_t::unite);
+}
+
+rect_set_t rect_set_t::operator&(const rect_set_t &r) const
+{
+  return combine(*this, r, op_t::intersect);
+}
+
+rect_set_t rect_set_t::operator-(const rect_set_t &r) const
+{
+  return combine(*this, r, op_t::subtract);
+}
+
+bool rect_set_t::operator==(const rect_set_t &r) const
+{
+  return rects.size() == r.rects.size() && std::equal(rects.begin(), rects.end(), r.rects.begin());
+}
+
+bool rect_set_t::operator!=(const rect_set_t &r) const
+{
+  return !(*this == r);
+}
+
+std::size_t rect_set_t::hash() const
+{
+  // FNV-1a over the coordinates
+  uint64_t h = 14695981039346656037ULL;
+  for(const auto &rect : rects)
+    for(int32_t v : { rect.x1, rect.y1, rect.x2, rect.y2 })
+    {
+      h ^= static_cast<uint32_t>(v);
+      h *= 1099511628211ULL;
+    }
+  return static_cast<std::size_t>(h);
+}
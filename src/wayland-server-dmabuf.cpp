@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <wayland-server-dmabuf.hpp>
+
+using namespace wayland;
+using namespace wayland::server;
+using namespace wayland::detail;
+
+dmabuf_format_table_t::data_t::~data_t()
+{
+  if(fd >= 0)
+    close(fd);
+}
+
+dmabuf_format_table_t::dmabuf_format_table_t(const std::vector<std::pair<uint32_t, uint64_t>> &formats)
+  : data(std::make_shared<data_t>())
+{
+  for(const auto &f : formats)
+  {
+    if(data->indices.count(f))
+      continue;
+    if(data->formats.size() > UINT16_MAX)
+      throw std::length_error("Too many formats for a dmabuf format table.");
+    data->indices[f] = static_cast<uint16_t>(data->formats.size());
+    data->formats.push_back({f.first, 0, f.second});
+  }
+
+  data->fd = check_return_value(memfd_create("wayland-dmabuf-format-table", MFD_CLOEXEC | MFD_ALLOW_SEALING), "memfd_create");
+  const char *buf = reinterpret_cast<const char*>(data->formats.data());
+  size_t size = get_size();
+  while(size > 0)
+  {
+    ssize_t written = write(data->fd, buf, size);
+    if(written < 0 && errno == EINTR)
+      continue;
+    check_return_value(static_cast<int>(written), "write");
+    buf += written;
+    size -= written;
+  }
+  // Clients may map the file, so it must never change again
+  check_return_value(fcntl(data->fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL), "fcntl");
+}
+
+void dmabuf_format_table_t::send(zwp_linux_dmabuf_feedback_v1_t &feedback) const
+{
+  feedback.format_table(data->fd, get_size());
+}
+
+uint16_t dmabuf_format_table_t::get_index(uint32_t format, uint64_t modifier) const
+{
+  auto it = data->indices.find(std::make_pair(format, modifier));
+  if(it == data->indices.end())
+    throw std::out_of_range("Format is not in the dmabuf format table.");
+  return it->second;
+}
+
+array_t dmabuf_format_table_t::get_indices(const std::vector<std::pair<uint32_t, uint64_t>> &formats) const
+{
+  std::vector<uint16_t> indices;
+  indices.reserve(formats.size());
+  for(const auto &f : formats)
+    indices.push_back(get_index(f.first, f.second));
+  return indices;
+}
+
+array_t dmabuf_format_table_t::get_indices() const
+{
+  std::vector<uint16_t> indices(data->formats.size());
+  for(size_t c = 0; c < indices.size(); c++)
+    indices[c] = static_cast<uint16_t>(c);
+  return indices;
+}
+
+const std::vector<dmabuf_format_t> &dmabuf_format_table_t::get_formats() const
+{
+  return data->formats;
+}
+
+int dmabuf_format_table_t::get_fd() const
+{
+  return data->fd;
+}
+
+uint32_t dmabuf_format_table_t::get_size() const
+{
+  return static_cast<uint32_t>(data->formats.size() * sizeof(dmabuf_format_t));
+}
@@ -105,6 +105,7 @@ void display_t::init()
 {
   data = new data_t;
   data->counter = 1;
+  data->resource = wayland::new_delete_resource();
   data->destroy_listener.user = data;
   data->client_created_listener.user = data;
   data->destroy_listener.listener.notify = destroy_func;
@@ -132,6 +133,13 @@ display_t::display_t()
   init();
 }
 
+display_t::display_t(wayland::memory_resource_t *resource)
+  : display_t()
+{
+  if(resource)
+    data->resource = resource;
+}
+
 display_t::display_t(wl_display *c)
 {
   display = c;
@@ -214,6 +222,17 @@ int display_t::add_socket_fd(int sock_fd) const
   return wl_display_add_socket_fd(c_ptr(), sock_fd);
 }
 
+int display_t::init_shm() const
+{
+  return wl_display_init_shm(c_ptr());
+}
+
+void display_t::add_shm_format(uint32_t format) const
+{
+  if(!wl_display_add_shm_format(c_ptr(), format))
+    throw std::runtime_error("Failed to add shm format.");
+}
+
 void display_t::terminate() const
 {
   wl_display_terminate(c_ptr());
@@ -239,6 +258,16 @@ uint32_t display_t::next_serial() const
   return wl_display_next_serial(c_ptr());
 }
 
+wayland::memory_resource_t *display_t::get_memory_resource() const
+{
+  return data->resource;
+}
+
+wayland::memory_stats_t display_t::get_memory_stats() const
+{
+  return data->resource->get_stats();
+}
+
 std::function<void()> &display_t::on_destroy()
 {
   return data->destroy;
@@ -315,12 +344,19 @@ void client_t::resource_created_func(wl_listener *listener, void *resource_ptr)
 
 void client_t::user_data_destroy_func(void *data)
 {
-  delete static_cast<data_t*>(data);
+  auto *d = static_cast<data_t*>(data);
+  wayland::detail::destroy(d->data_resource, d);
 }
 
 void client_t::init()
 {
-  data = new data_t;
+  wayland::memory_resource_t *resource = wayland::new_delete_resource();
+  display_t::data_t *display_data = display_t::wl_display_get_user_data(wl_client_get_display(client));
+  if(display_data)
+    resource = display_data->resource;
+  data = wayland::detail::create<data_t>(resource);
+  data->resource = resource;
+  data->data_resource = resource;
   data->client = client;
   data->counter = 1;
   data->destroyed = false;
@@ -423,6 +459,21 @@ int client_t::get_fd() const
   return wl_client_get_fd(c_ptr());
 }
 
+void client_t::set_memory_resource(wayland::memory_resource_t *resource)
+{
+  data->resource = resource ? resource : data->data_resource;
+}
+
+wayland::memory_resource_t *client_t::get_memory_resource() const
+{
+  return data->resource;
+}
+
+wayland::memory_stats_t client_t::get_memory_stats() const
+{
+  return data->resource->get_stats();
+}
+
 std::function<void()> &client_t::on_destroy()
 {
   return data->destroy;
@@ -491,7 +542,7 @@ void resource_t::destroy_func(wl_listener *listener, void */*unused*/)
   if(data->destroy)
     data->destroy();
   reinterpret_cast<listener_t*>(listener)->user = nullptr;
-  delete data;
+  wayland::detail::destroy(data->resource, data);
 }
 
 int resource_t::dummy_dispatcher(int /*opcode*/, const std::vector<wayland::detail::any>& /*args*/, const std::shared_ptr<resource_t::events_base_t>& /*events*/)
@@ -501,7 +552,9 @@ int resource_t::dummy_dispatcher(int /*opcode*/, const std::vector<wayland::deta
 
 void resource_t::init()
 {
-  data = new data_t;
+  client_t client(wl_resource_get_client(resource));
+  data = wayland::detail::create<data_t>(client.data->resource);
+  data->resource = client.data->resource;
   data->counter = 1;
   data->destroy_listener.user = data;
   data->destroy_listener.listener.notify = destroy_func;
@@ -513,17 +566,49 @@ void resource_t::init()
 resource_t::resource_t(const client_t& client, const wl_interface *interface, int version, uint32_t id)
 {
   resource = wl_resource_create(client.c_ptr(), interface, version, id);
-  init();
+  // may already be wrapped by the resource created listener of the client
+  data = wl_resource_get_data(resource);
+  if(data)
+    data->counter++;
+  else
+    init();
+}
+
+resource_t::data_t *resource_t::wl_resource_get_data(wl_resource *resource)
+{
+  wl_listener *listener = wl_resource_get_destroy_listener(resource, destroy_func);
+  if(listener)
+    return reinterpret_cast<data_t*>(reinterpret_cast<listener_t*>(listener)->user);
+  return nullptr;
 }
 
 resource_t::resource_t(wl_resource *c)
 {
   resource = c;
-  data = static_cast<data_t*>(wl_resource_get_user_data(c_ptr()));
-  if(!data)
+  data = wl_resource_get_data(c_ptr());
+  if(data)
+  {
+    data->counter++;
+    // The implementation was replaced after the resource was wrapped by
+    // the resource created listener.
+    if(wl_resource_get_user_data(c_ptr()) != data)
+      data->foreign = true;
+  }
+  else if(!wl_resource_get_user_data(c_ptr()))
     init();
   else
-    data->counter++;
+  {
+    // Resources implemented elsewhere, like the buffers of wl_shm, only
+    // get the destroy listener, which carries the data of the wrapper.
+    client_t client(wl_resource_get_client(resource));
+    data = wayland::detail::create<data_t>(client.data->resource);
+    data->resource = client.data->resource;
+    data->counter = 1;
+    data->foreign = true;
+    data->destroy_listener.user = data;
+    data->destroy_listener.listener.notify = destroy_func;
+    wl_resource_add_destroy_listener(resource, reinterpret_cast<wl_listener*>(&data->destroy_listener));
+  }
 }
 
 resource_t::~resource_t()
@@ -680,10 +765,16 @@ void resource_t::set_events(const std::shared_ptr<events_base_t>& events,
   {
     data->events = events;
     // the dispatcher gets 'implemetation'
-    wl_resource_set_dispatcher(c_ptr(), c_dispatcher, reinterpret_cast<void*>(dispatcher), data, nullptr);
+    if(!data->foreign)
+      wl_resource_set_dispatcher(c_ptr(), c_dispatcher, reinterpret_cast<void*>(dispatcher), data, nullptr);
   }
 }
 
+bool resource_t::has_events() const
+{
+  return data->events != nullptr;
+}
+
 std::shared_ptr<resource_t::events_base_t> resource_t::get_events() const
 {
   return data->events;
@@ -744,6 +835,186 @@ std::function<void()> &resource_t::on_destroy()
 
 //-----------------------------------------------------------------------------
 
+const bitfield<8, -2> serial_event_t::pointer_enter{1 << 0};
+const bitfield<8, -2> serial_event_t::pointer_button{1 << 1};
+const bitfield<8, -2> serial_event_t::keyboard_enter{1 << 2};
+const bitfield<8, -2> serial_event_t::keyboard_key{1 << 3};
+const bitfield<8, -2> serial_event_t::touch_down{1 << 4};
+const bitfield<8, -2> serial_event_t::tablet_tool_down{1 << 5};
+const bitfield<8, -2> serial_event_t::configure{1 << 6};
+const bitfield<8, -2> serial_event_t::other{1 << 7};
+
+serial_tracker_t::serial_tracker_t(const display_t &d, uint32_t capacity)
+  : display(d)
+{
+  if(capacity == 0 || capacity > (1U << 31))
+    throw std::invalid_argument("Invalid serial tracker capacity.");
+  uint32_t size = 1;
+  while(size < capacity)
+    size <<= 1;
+  ring.resize(size);
+  mask = size - 1;
+}
+
+uint32_t serial_tracker_t::next_serial(const client_t &client, const resource_t &seat, const serial_event_t &kind, uint32_t time)
+{
+  uint32_t serial = display.next_serial();
+  record(serial, client, seat, kind, time);
+  return serial;
+}
+
+void serial_tracker_t::record(uint32_t serial, const client_t &client, const resource_t &seat, const serial_event_t &kind, uint32_t time)
+{
+  serial_entry_t &entry = ring[serial & mask];
+  entry.serial = serial;
+  entry.kind = static_cast<uint32_t>(kind);
+  entry.time = time;
+  entry.client = client.c_ptr();
+  entry.seat = seat ? seat.c_ptr() : nullptr;
+}
+
+bool serial_tracker_t::find(uint32_t serial, serial_entry_t &entry) const
+{
+  const serial_entry_t &e = ring[serial & mask];
+  if(e.kind == 0 || e.serial != serial || display.get_serial() - serial > mask)
+    return false;
+  entry = e;
+  return true;
+}
+
+bool serial_tracker_t::validate(uint32_t serial, const client_t &client, const resource_t &seat, const serial_event_t &kinds) const
+{
+  const serial_entry_t &e = ring[serial & mask];
+  if(e.serial != serial || (e.kind & static_cast<uint32_t>(kinds)) == 0)
+    return false;
+  // Serials are handed out in order, so anything older than the ring is stale
+  if(display.get_serial() - serial > mask)
+    return false;
+  if(e.client != client.c_ptr())
+    return false;
+  return !seat || e.seat == seat.c_ptr();
+}
+
+void serial_tracker_t::forget(const client_t &client)
+{
+  for(auto &e : ring)
+    if(e.client == client.c_ptr())
+      e = serial_entry_t();
+}
+
+uint32_t serial_tracker_t::capacity() const
+{
+  return mask + 1;
+}
+
+//-----------------------------------------------------------------------------
+
+shm_buffer_t::access_t::access_t(wl_shm_buffer *b)
+  : buffer(b)
+{
+  wl_shm_buffer_begin_access(buffer);
+}
+
+shm_buffer_t::access_t::access_t(access_t&& a) noexcept
+{
+  operator=(std::move(a));
+}
+
+shm_buffer_t::access_t &shm_buffer_t::access_t::operator=(access_t&& a) noexcept
+{
+  std::swap(buffer, a.buffer);
+  return *this;
+}
+
+shm_buffer_t::access_t::~access_t()
+{
+  if(buffer)
+    wl_shm_buffer_end_access(buffer);
+}
+
+shm_buffer_t::shm_buffer_t(const resource_t &b)
+{
+  buffer = wl_shm_buffer_get(b.c_ptr());
+  if(buffer)
+  {
+    format = wl_shm_buffer_get_format(buffer);
+    width = wl_shm_buffer_get_width(buffer);
+    height = wl_shm_buffer_get_height(buffer);
+    stride = wl_shm_buffer_get_stride(buffer);
+  }
+}
+
+bool shm_buffer_t::is_shm_buffer(const resource_t &buffer)
+{
+  return wl_shm_buffer_get(buffer.c_ptr()) != nullptr;
+}
+
+shm_buffer_t::operator bool() const
+{
+  return buffer != nullptr;
+}
+
+uint32_t shm_buffer_t::get_format() const
+{
+  return format;
+}
+
+int32_t shm_buffer_t::get_width() const
+{
+  return width;
+}
+
+int32_t shm_buffer_t::get_height() const
+{
+  return height;
+}
+
+int32_t shm_buffer_t::get_stride() const
+{
+  return stride;
+}
+
+std::size_t shm_buffer_t::get_size() const
+{
+  return static_cast<std::size_t>(stride) * static_cast<std::size_t>(height);
+}
+
+void shm_buffer_t::ref_pool()
+{
+  if(!pool)
+  {
+    pool = std::shared_ptr<wl_shm_pool>(wl_shm_buffer_ref_pool(c_ptr()), wl_shm_pool_unref);
+    // The mapping cannot move while the pool is referenced
+    data = wl_shm_buffer_get_data(buffer);
+  }
+}
+
+bool shm_buffer_t::has_pool_ref() const
+{
+  return static_cast<bool>(pool);
+}
+
+shm_buffer_t::access_t shm_buffer_t::begin_access() const
+{
+  return access_t(c_ptr());
+}
+
+const void *shm_buffer_t::get_data() const
+{
+  if(data)
+    return data;
+  return wl_shm_buffer_get_data(c_ptr());
+}
+
+wl_shm_buffer *shm_buffer_t::c_ptr() const
+{
+  if(!buffer)
+    throw std::runtime_error("shm buffer is null.");
+  return buffer;
+}
+
+//-----------------------------------------------------------------------------
+
 bool global_base_t::has_interface(const wl_interface *interface) const
 {
   return interface == wl_global_get_interface(c_ptr());
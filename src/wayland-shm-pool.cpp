@@ -0,0 +1,552 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <stdexcept>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <wayland-shm-pool.hpp>
+
+using namespace wayland;
+using namespace wayland::detail;
+
+namespace
+{
+  // offsets of buffers in the pool are aligned to cache lines
+  const std::size_t block_alignment = 64;
+
+  std::size_t align_block(std::size_t size)
+  {
+    return (size + block_alignment - 1) & ~(block_alignment - 1);
+  }
+
+  std::size_t align_up(std::size_t size, std::size_t alignment)
+  {
+    return (size + alignment - 1) / alignment * alignment;
+  }
+
+  // size of a transparent huge page
+  std::size_t transparent_huge_page_size()
+  {
+    std::ifstream file("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size");
+    std::size_t size = 0;
+    if(file >> size && size > 0)
+      return size;
+    return 2 * 1024 * 1024;
+  }
+
+  // Reserve an address range of the given size that is aligned for huge
+  // pages, so that the kernel can use PMD mappings for it.
+  void *reserve_aligned(std::size_t size, std::size_t alignment)
+  {
+    void *reserved = mmap(nullptr, size + alignment, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if(reserved == MAP_FAILED)
+      return MAP_FAILED;
+    auto begin = reinterpret_cast<std::uintptr_t>(reserved);
+    auto aligned = (begin + alignment - 1) & ~(static_cast<std::uintptr_t>(alignment) - 1);
+    if(aligned > begin)
+      munmap(reserved, aligned - begin);
+    if(aligned + size < begin + size + alignment)
+      munmap(reinterpret_cast<void*>(aligned + size), begin + alignment - aligned);
+    return reinterpret_cast<void*>(aligned);
+  }
+}
+
+struct wayland::detail::shm_pool_record_t
+{
+  buffer_t buffer;
+  std::size_t offset = 0;
+  std::size_t capacity = 0;
+  int32_t width = 0;
+  int32_t height = 0;
+  int32_t stride = 0;
+  shm_format format = shm_format::argb8888;
+  bool busy = false;
+};
+
+struct wayland::detail::shm_pool_data_t
+{
+  shm_t shm;
+  shm_pool_t pool;
+  int fd = -1;
+  void *mem = nullptr;
+  std::size_t size = 0;
+  shm_pool_pages pages = shm_pool_pages::normal;
+  std::size_t page_size = 0;
+  bool sealed = false;
+  bool want_seal = false;
+  unsigned int max_buffers = 0;
+  // offset -> size of unused blocks
+  std::map<std::size_t, std::size_t> free_blocks;
+  std::vector<std::shared_ptr<shm_pool_record_t>> records;
+
+  ~shm_pool_data_t()
+  {
+    records.clear();
+    pool.proxy_release();
+    if(mem)
+      munmap(mem, size);
+    if(fd >= 0)
+      close(fd);
+  }
+
+  // A buffer can be reused if the compositor released it and nobody holds a handle
+  static bool is_free(const std::shared_ptr<shm_pool_record_t> &record)
+  {
+    return !record->busy && record.use_count() == 1;
+  }
+
+  // Create the memfd, falling back to smaller pages if necessary
+  void open(shm_pool_pages requested)
+  {
+    if(fd >= 0)
+      close(fd);
+    fd = -1;
+    pages = requested;
+
+    if(pages == shm_pool_pages::huge)
+    {
+      fd = memfd_create("wayland-shm-pool", MFD_CLOEXEC | MFD_ALLOW_SEALING | MFD_HUGETLB);
+      struct stat st;
+      if(fd >= 0 && fstat(fd, &st) == 0)
+        page_size = static_cast<std::size_t>(st.st_blksize);
+      else
+      {
+        // the hugetlb file is useless without its page size
+        if(fd >= 0)
+          close(fd);
+        fd = -1;
+        pages = shm_pool_pages::transparent_huge;
+      }
+    }
+    if(fd < 0)
+    {
+      fd = check_return_value(memfd_create("wayland-shm-pool", MFD_CLOEXEC | MFD_ALLOW_SEALING), "memfd_create");
+      page_size = pages == shm_pool_pages::transparent_huge ? transparent_huge_page_size()
+                                                            : static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+    }
+
+    // sealing hugetlbfs files is not supported by older kernels
+    sealed = want_seal && fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK) == 0;
+  }
+
+  // Map the first new_size bytes of the file, moving the existing mapping if there is one
+  void *map(std::size_t new_size)
+  {
+    void *target = nullptr;
+    if(pages == shm_pool_pages::transparent_huge)
+    {
+      target = reserve_aligned(new_size, page_size);
+      if(target == MAP_FAILED)
+        return MAP_FAILED;
+    }
+
+    void *new_mem = MAP_FAILED;
+    if(mem)
+    {
+      // moving the page tables is cheaper than faulting everything in again
+      if(target)
+        new_mem = mremap(mem, size, new_size, MREMAP_MAYMOVE | MREMAP_FIXED, target);
+      else
+        new_mem = mremap(mem, size, new_size, MREMAP_MAYMOVE);
+      // older kernels cannot mremap hugetlb mappings
+      if(new_mem == MAP_FAILED && errno == EINVAL)
+      {
+        new_mem = mmap(target, new_size, PROT_READ | PROT_WRITE, MAP_SHARED | (target ? MAP_FIXED : 0), fd, 0);
+        if(new_mem != MAP_FAILED)
+          munmap(mem, size);
+      }
+    }
+    else
+      new_mem = mmap(target, new_size, PROT_READ | PROT_WRITE, MAP_SHARED | (target ? MAP_FIXED : 0), fd, 0);
+
+    if(new_mem == MAP_FAILED)
+    {
+      if(target)
+        munmap(target, new_size);
+      return MAP_FAILED;
+    }
+
+    // madvise fails if transparent huge pages are not supported by the kernel
+    if(pages == shm_pool_pages::transparent_huge && madvise(new_mem, new_size, MADV_HUGEPAGE) != 0)
+      pages = shm_pool_pages::normal;
+    return new_mem;
+  }
+
+  void grow(std::size_t min_size)
+  {
+    std::size_t new_size = align_up(std::max(min_size, size * 2), page_size);
+    if(new_size > static_cast<std::size_t>(std::numeric_limits<int32_t>::max()))
+      new_size = align_up(min_size, page_size);
+    if(new_size > static_cast<std::size_t>(std::numeric_limits<int32_t>::max()))
+      throw std::invalid_argument("shm pool size exceeds the protocol limit.");
+
+    check_return_value(ftruncate(fd, static_cast<off_t>(new_size)), "ftruncate");
+    void *new_mem = map(new_size);
+    // Huge pages are reserved on mmap. If there are not enough, fall back
+    // to regular pages, as long as the compositor has not seen the file.
+    while(new_mem == MAP_FAILED && !mem && pages != shm_pool_pages::normal)
+    {
+      open(pages == shm_pool_pages::huge ? shm_pool_pages::transparent_huge : shm_pool_pages::normal);
+      new_size = align_up(min_size, page_size);
+      check_return_value(ftruncate(fd, static_cast<off_t>(new_size)), "ftruncate");
+      new_mem = map(new_size);
+    }
+    if(new_mem == MAP_FAILED)
+      check_return_value(-1, mem ? "mremap" : "mmap");
+    mem = new_mem;
+
+    if(pool)
+      pool.resize(static_cast<int32_t>(new_size));
+    else
+      pool = shm.create_pool(fd, static_cast<int32_t>(new_size));
+
+    // the new space is free, merged with a free block at the end
+    std::size_t offset = size;
+    std::size_t length = new_size - size;
+    size = new_size;
+    release_block(offset, length);
+  }
+
+  std::size_t allocate_block(std::size_t length)
+  {
+    // first fit
+    for(auto it = free_blocks.begin(); it != free_blocks.end(); ++it)
+      if(it->second >= length)
+      {
+        std::size_t offset = it->first;
+        std::size_t rest = it->second - length;
+        free_blocks.erase(it);
+        if(rest > 0)
+          free_blocks[offset + length] = rest;
+        return offset;
+      }
+
+    // grow, so that a free block at the end can be extended
+    std::size_t tail = 0;
+    if(!free_blocks.empty())
+    {
+      auto last = std::prev(free_blocks.end());
+      if(last->first + last->second == size)
+        tail = last->second;
+    }
+    grow(size + length - tail);
+    return allocate_block(length);
+  }
+
+  void release_block(std::size_t offset, std::size_t length)
+  {
+    auto next = free_blocks.lower_bound(offset);
+    if(next != free_blocks.end() && offset + length == next->first)
+    {
+      length += next->second;
+      next = free_blocks.erase(next);
+    }
+    if(next != free_blocks.begin())
+    {
+      auto prev = std::prev(next);
+      if(prev->first + prev->second == offset)
+      {
+        prev->second += length;
+        return;
+      }
+    }
+    free_blocks[offset] = length;
+  }
+
+  void create_buffer(shm_pool_record_t &record, int32_t width, int32_t height, int32_t stride, shm_format format)
+  {
+    record.buffer = pool.create_buffer(static_cast<int32_t>(record.offset), width, height, stride, format);
+    shm_pool_record_t *r = &record;
+    record.buffer.on_release() = [r] () { r->busy = false; };
+    record.width = width;
+    record.height = height;
+    record.stride = stride;
+    record.format = format;
+  }
+};
+
+unsigned int wayland::shm_format_bytes_per_pixel(shm_format format)
+{
+  switch(format)
+  {
+  case shm_format::c8:
+  case shm_format::rgb332:
+  case shm_format::bgr233:
+  case shm_format::r8:
+    return 1;
+  case shm_format::xrgb4444:
+  case shm_format::xbgr4444:
+  case shm_format::rgbx4444:
+  case shm_format::bgrx4444:
+  case shm_format::argb4444:
+  case shm_format::abgr4444:
+  case shm_format::rgba4444:
+  case shm_format::bgra4444:
+  case shm_format::xrgb1555:
+  case shm_format::xbgr1555:
+  case shm_format::rgbx5551:
+  case shm_format::bgrx5551:
+  case shm_format::argb1555:
+  case shm_format::abgr1555:
+  case shm_format::rgba5551:
+  case shm_format::bgra5551:
+  case shm_format::rgb565:
+  case shm_format::bgr565:
+  case shm_format::r16:
+  case shm_format::rg88:
+  case shm_format::gr88:
+    return 2;
+  case shm_format::rgb888:
+  case shm_format::bgr888:
+    return 3;
+  case shm_format::argb8888:
+  case shm_format::xrgb8888:
+  case shm_format::xbgr8888:
+  case shm_format::rgbx8888:
+  case shm_format::bgrx8888:
+  case shm_format::abgr8888:
+  case shm_format::rgba8888:
+  case shm_format::bgra8888:
+  case shm_format::xrgb2101010:
+  case shm_format::xbgr2101010:
+  case shm_format::rgbx1010102:
+  case shm_format::bgrx1010102:
+  case shm_format::argb2101010:
+  case shm_format::abgr2101010:
+  case shm_format::rgba1010102:
+  case shm_format::bgra1010102:
+  case shm_format::rg1616:
+  case shm_format::gr1616:
+    return 4;
+  case shm_format::xrgb16161616f:
+  case shm_format::xbgr16161616f:
+  case shm_format::argb16161616f:
+  case shm_format::abgr16161616f:
+  case shm_format::xrgb16161616:
+  case shm_format::xbgr16161616:
+  case shm_format::argb16161616:
+  case shm_format::abgr16161616:
+    return 8;
+  default:
+    return 0;
+  }
+}
+
+shm_pool_buffer_t::shm_pool_buffer_t(std::shared_ptr<shm_pool_data_t> pool,
+                                     std::shared_ptr<shm_pool_record_t> record)
+  : pool(std::move(pool)), record(std::move(record))
+{
+}
+
+shm_pool_buffer_t::operator bool() const
+{
+  return static_cast<bool>(record);
+}
+
+buffer_t &shm_pool_buffer_t::get_buffer() const
+{
+  if(!record)
+    throw std::runtime_error("shm pool buffer is empty.");
+  return record->buffer;
+}
+
+void *shm_pool_buffer_t::get_data() const
+{
+  if(!record)
+    throw std::runtime_error("shm pool buffer is empty.");
+  return static_cast<char*>(pool->mem) + record->offset;
+}
+
+int32_t shm_pool_buffer_t::get_width() const
+{
+  return record ? record->width : 0;
+}
+
+int32_t shm_pool_buffer_t::get_height() const
+{
+  return record ? record->height : 0;
+}
+
+int32_t shm_pool_buffer_t::get_stride() const
+{
+  return record ? record->stride : 0;
+}
+
+shm_format shm_pool_buffer_t::get_format() const
+{
+  return record ? record->format : shm_format::argb8888;
+}
+
+std::size_t shm_pool_buffer_t::get_size() const
+{
+  return record ? static_cast<std::size_t>(record->stride) * static_cast<std::size_t>(record->height) : 0;
+}
+
+bool shm_pool_buffer_t::is_busy() const
+{
+  return record && record->busy;
+}
+
+void shm_pool_buffer_t::discard()
+{
+  if(record)
+    record->busy = false;
+}
+
+shm_buffer_pool_t::shm_buffer_pool_t(shm_t &shm, unsigned int max_buffers, std::size_t initial_size,
+                                     const shm_pool_options_t &options)
+  : data(std::make_shared<shm_pool_data_t>())
+{
+  if(max_buffers == 0)
+    throw std::invalid_argument("shm pool needs at least one buffer.");
+  data->shm = shm;
+  data->max_buffers = max_buffers;
+  data->want_seal = options.seal;
+  data->open(options.pages);
+  if(initial_size > 0)
+    data->grow(align_block(initial_size));
+}
+
+shm_pool_buffer_t shm_buffer_pool_t::acquire(int32_t width, int32_t height, shm_format format, int32_t stride)
+{
+  if(width <= 0 || height <= 0)
+    throw std::invalid_argument("Invalid shm buffer size.");
+  if(stride == 0)
+  {
+    unsigned int bpp = shm_format_bytes_per_pixel(format);
+    if(bpp == 0)
+      throw std::invalid_argument("Stride needed for this shm format.");
+    stride = width * static_cast<int32_t>(bpp);
+  }
+  if(stride <= 0)
+    throw std::invalid_argument("Invalid shm buffer stride.");
+  std::size_t needed = align_block(static_cast<std::size_t>(stride) * static_cast<std::size_t>(height));
+
+  auto &records = data->records;
+  std::shared_ptr<shm_pool_record_t> fit;
+  std::shared_ptr<shm_pool_record_t> other;
+  for(auto &record : records)
+  {
+    if(!shm_pool_data_t::is_free(record))
+      continue;
+    // same buffer as before
+    if(record->width == width && record->height == height && record->stride == stride && record->format == format)
+    {
+      record->busy = true;
+      return shm_pool_buffer_t(data, record);
+    }
+    // smallest block that is large enough
+    if(record->capacity >= needed)
+    {
+      if(!fit || record->capacity < fit->capacity)
+        fit = record;
+    }
+    else if(!other)
+      other = record;
+  }
+
+  if(!fit)
+  {
+    if(records.size() < data->max_buffers)
+    {
+      fit = std::make_shared<shm_pool_record_t>();
+      fit->offset = data->allocate_block(needed);
+      fit->capacity = needed;
+      records.push_back(fit);
+    }
+    else if(other)
+    {
+      // replace a buffer that is too small
+      other->buffer = buffer_t();
+      data->release_block(other->offset, other->capacity);
+      other->offset = data->allocate_block(needed);
+      other->capacity = needed;
+      fit = other;
+    }
+    else
+      return shm_pool_buffer_t();
+  }
+
+  data->create_buffer(*fit, width, height, stride, format);
+  fit->busy = true;
+  return shm_pool_buffer_t(data, fit);
+}
+
+void shm_buffer_pool_t::trim()
+{
+  auto &records = data->records;
+  for(auto it = records.begin(); it != records.end();)
+  {
+    if(shm_pool_data_t::is_free(*it))
+    {
+      data->release_block((*it)->offset, (*it)->capacity);
+      it = records.erase(it);
+    }
+    else
+      ++it;
+  }
+}
+
+std::size_t shm_buffer_pool_t::get_size() const
+{
+  return data->size;
+}
+
+shm_pool_pages shm_buffer_pool_t::get_pages() const
+{
+  return data->pages;
+}
+
+std::size_t shm_buffer_pool_t::get_page_size() const
+{
+  return data->page_size;
+}
+
+bool shm_buffer_pool_t::is_sealed() const
+{
+  return data->sealed;
+}
+
+unsigned int shm_buffer_pool_t::get_buffer_count() const
+{
+  return static_cast<unsigned int>(data->records.size());
+}
+
+unsigned int shm_buffer_pool_t::get_busy_count() const
+{
+  unsigned int count = 0;
+  for(const auto &record : data->records)
+    if(record->busy)
+      count++;
+  return count;
+}
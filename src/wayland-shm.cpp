@@ -0,0 +1,1102 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <wayland-shm.hpp>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define WAYLAND_SHM_X86
+#include <immintrin.h>
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#elif defined(__aarch64__)
+#define WAYLAND_SHM_NEON
+#include <arm_neon.h>
+#endif
+
+using namespace wayland;
+
+// Pixels are read and written as little endian words, as defined by
+// wl_shm.format. Only little endian hosts are supported.
+
+namespace
+{
+  constexpr uint32_t fourcc(char a, char b, char c, char d)
+  {
+    return static_cast<uint32_t>(a) | static_cast<uint32_t>(b) << 8 | static_cast<uint32_t>(c) << 16 | static_cast<uint32_t>(d) << 24;
+  }
+
+  struct channel_t
+  {
+    unsigned int shift;
+    unsigned int bits;
+  };
+
+  struct format_info_t
+  {
+    uint32_t format;
+    unsigned int bytes;
+    // for formats without alpha, a describes the unused X bits
+    channel_t a, r, g, b;
+    bool alpha;
+  };
+
+  const format_info_t format_infos[] =
+  {
+    { 0, 4, { 24, 8 }, { 16, 8 }, { 8, 8 }, { 0, 8 }, true }, // argb8888
+    { 1, 4, { 24, 8 }, { 16, 8 }, { 8, 8 }, { 0, 8 }, false }, // xrgb8888
+    { fourcc('A', 'B', '2', '4'), 4, { 24, 8 }, { 0, 8 }, { 8, 8 }, { 16, 8 }, true },
+    { fourcc('X', 'B', '2', '4'), 4, { 24, 8 }, { 0, 8 }, { 8, 8 }, { 16, 8 }, false },
+    { fourcc('R', 'A', '2', '4'), 4, { 0, 8 }, { 24, 8 }, { 16, 8 }, { 8, 8 }, true },
+    { fourcc('R', 'X', '2', '4'), 4, { 0, 8 }, { 24, 8 }, { 16, 8 }, { 8, 8 }, false },
+    { fourcc('B', 'A', '2', '4'), 4, { 0, 8 }, { 8, 8 }, { 16, 8 }, { 24, 8 }, true },
+    { fourcc('B', 'X', '2', '4'), 4, { 0, 8 }, { 8, 8 }, { 16, 8 }, { 24, 8 }, false },
+    { fourcc('A', 'R', '3', '0'), 4, { 30, 2 }, { 20, 10 }, { 10, 10 }, { 0, 10 }, true },
+    { fourcc('X', 'R', '3', '0'), 4, { 30, 2 }, { 20, 10 }, { 10, 10 }, { 0, 10 }, false },
+    { fourcc('A', 'B', '3', '0'), 4, { 30, 2 }, { 0, 10 }, { 10, 10 }, { 20, 10 }, true },
+    { fourcc('X', 'B', '3', '0'), 4, { 30, 2 }, { 0, 10 }, { 10, 10 }, { 20, 10 }, false },
+    { fourcc('R', 'A', '3', '0'), 4, { 0, 2 }, { 22, 10 }, { 12, 10 }, { 2, 10 }, true },
+    { fourcc('R', 'X', '3', '0'), 4, { 0, 2 }, { 22, 10 }, { 12, 10 }, { 2, 10 }, false },
+    { fourcc('B', 'A', '3', '0'), 4, { 0, 2 }, { 2, 10 }, { 12, 10 }, { 22, 10 }, true },
+    { fourcc('B', 'X', '3', '0'), 4, { 0, 2 }, { 2, 10 }, { 12, 10 }, { 22, 10 }, false },
+    { fourcc('A', 'R', '1', '2'), 2, { 12, 4 }, { 8, 4 }, { 4, 4 }, { 0, 4 }, true },
+    { fourcc('X', 'R', '1', '2'), 2, { 12, 4 }, { 8, 4 }, { 4, 4 }, { 0, 4 }, false },
+    { fourcc('A', 'B', '1', '2'), 2, { 12, 4 }, { 0, 4 }, { 4, 4 }, { 8, 4 }, true },
+    { fourcc('X', 'B', '1', '2'), 2, { 12, 4 }, { 0, 4 }, { 4, 4 }, { 8, 4 }, false },
+    { fourcc('R', 'A', '1', '2'), 2, { 0, 4 }, { 12, 4 }, { 8, 4 }, { 4, 4 }, true },
+    { fourcc('R', 'X', '1', '2'), 2, { 0, 4 }, { 12, 4 }, { 8, 4 }, { 4, 4 }, false },
+    { fourcc('B', 'A', '1', '2'), 2, { 0, 4 }, { 4, 4 }, { 8, 4 }, { 12, 4 }, true },
+    { fourcc('B', 'X', '1', '2'), 2, { 0, 4 }, { 4, 4 }, { 8, 4 }, { 12, 4 }, false },
+    { fourcc('A', 'R', '1', '5'), 2, { 15, 1 }, { 10, 5 }, { 5, 5 }, { 0, 5 }, true },
+    { fourcc('X', 'R', '1', '5'), 2, { 15, 1 }, { 10, 5 }, { 5, 5 }, { 0, 5 }, false },
+    { fourcc('A', 'B', '1', '5'), 2, { 15, 1 }, { 0, 5 }, { 5, 5 }, { 10, 5 }, true },
+    { fourcc('X', 'B', '1', '5'), 2, { 15, 1 }, { 0, 5 }, { 5, 5 }, { 10, 5 }, false },
+    { fourcc('R', 'A', '1', '5'), 2, { 0, 1 }, { 11, 5 }, { 6, 5 }, { 1, 5 }, true },
+    { fourcc('R', 'X', '1', '5'), 2, { 0, 1 }, { 11, 5 }, { 6, 5 }, { 1, 5 }, false },
+    { fourcc('B', 'A', '1', '5'), 2, { 0, 1 }, { 1, 5 }, { 6, 5 }, { 11, 5 }, true },
+    { fourcc('B', 'X', '1', '5'), 2, { 0, 1 }, { 1, 5 }, { 6, 5 }, { 11, 5 }, false },
+    { fourcc('R', 'G', '1', '6'), 2, { 0, 0 }, { 11, 5 }, { 5, 6 }, { 0, 5 }, false },
+    { fourcc('B', 'G', '1', '6'), 2, { 0, 0 }, { 0, 5 }, { 5, 6 }, { 11, 5 }, false },
+    { fourcc('R', 'G', '2', '4'), 3, { 0, 0 }, { 16, 8 }, { 8, 8 }, { 0, 8 }, false },
+    { fourcc('B', 'G', '2', '4'), 3, { 0, 0 }, { 0, 8 }, { 8, 8 }, { 16, 8 }, false },
+    { fourcc('R', 'G', 'B', '8'), 1, { 0, 0 }, { 5, 3 }, { 2, 3 }, { 0, 2 }, false },
+    { fourcc('B', 'G', 'R', '8'), 1, { 0, 0 }, { 0, 3 }, { 3, 3 }, { 6, 2 }, false },
+    { fourcc('A', 'R', '4', '8'), 8, { 48, 16 }, { 32, 16 }, { 16, 16 }, { 0, 16 }, true },
+    { fourcc('X', 'R', '4', '8'), 8, { 48, 16 }, { 32, 16 }, { 16, 16 }, { 0, 16 }, false },
+    { fourcc('A', 'B', '4', '8'), 8, { 48, 16 }, { 0, 16 }, { 16, 16 }, { 32, 16 }, true },
+    { fourcc('X', 'B', '4', '8'), 8, { 48, 16 }, { 0, 16 }, { 16, 16 }, { 32, 16 }, false },
+  };
+
+  const format_info_t &xrgb8888_info = format_infos[1];
+  const format_info_t &xbgr8888_info = format_infos[3];
+  const uint32_t rgb565 = fourcc('R', 'G', '1', '6');
+  const uint32_t bgr565 = fourcc('B', 'G', '1', '6');
+
+  const format_info_t *find_format(uint32_t format)
+  {
+    for(const auto &info : format_infos)
+      if(info.format == format)
+        return &info;
+    return nullptr;
+  }
+
+  const format_info_t &require_format(uint32_t format)
+  {
+    const format_info_t *info = find_format(format);
+    if(!info)
+      throw std::invalid_argument("Unsupported shm format.");
+    return *info;
+  }
+
+  bool is_8888(const format_info_t &info)
+  {
+    return info.bytes == 4 && info.a.bits == 8 && info.r.bits == 8 && info.g.bits == 8 && info.b.bits == 8;
+  }
+
+  bool is_565(const format_info_t &info)
+  {
+    return info.format == rgb565 || info.format == bgr565;
+  }
+
+  // rows are processed in chunks that fit in the L1 cache
+  const std::size_t chunk_size = 256;
+
+  //---------------------------------------------------------------------------
+  // generic path with 16 bits per channel
+
+  uint64_t load_pixel(const uint8_t *p, unsigned int bytes)
+  {
+    uint64_t word = 0;
+    std::memcpy(&word, p, bytes);
+    return word;
+  }
+
+  void store_pixel(uint8_t *p, unsigned int bytes, uint64_t word)
+  {
+    std::memcpy(p, &word, bytes);
+  }
+
+  uint16_t expand(uint64_t word, channel_t c)
+  {
+    uint64_t max = (uint64_t(1) << c.bits) - 1;
+    uint64_t v = (word >> c.shift) & max;
+    return static_cast<uint16_t>((v * 65535 + max / 2) / max);
+  }
+
+  uint64_t reduce(uint16_t v, channel_t c)
+  {
+    uint64_t max = (uint64_t(1) << c.bits) - 1;
+    return ((uint64_t(v) * max + 32767) / 65535) << c.shift;
+  }
+
+  // pixel with 16 bit channels in the order a, r, g, b
+  struct pixel16_t
+  {
+    uint16_t a, r, g, b;
+  };
+
+  void decode_row(pixel16_t *dst, const uint8_t *src, const format_info_t &info, std::size_t n)
+  {
+    for(std::size_t i = 0; i < n; i++, src += info.bytes)
+    {
+      uint64_t word = load_pixel(src, info.bytes);
+      dst[i].a = info.alpha ? expand(word, info.a) : 65535;
+      dst[i].r = expand(word, info.r);
+      dst[i].g = expand(word, info.g);
+      dst[i].b = expand(word, info.b);
+    }
+  }
+
+  void encode_row(uint8_t *dst, const pixel16_t *src, const format_info_t &info, std::size_t n)
+  {
+    // unused bits are set
+    uint64_t x = info.alpha ? 0 : ((uint64_t(1) << info.a.bits) - 1) << info.a.shift;
+    for(std::size_t i = 0; i < n; i++, dst += info.bytes)
+    {
+      uint64_t word = x | reduce(src[i].r, info.r) | reduce(src[i].g, info.g) | reduce(src[i].b, info.b);
+      if(info.alpha)
+        word |= reduce(src[i].a, info.a);
+      store_pixel(dst, info.bytes, word);
+    }
+  }
+
+  //---------------------------------------------------------------------------
+  // kernels for 32 bit pixels with 8 bit channels
+
+  // Kernels of one instruction set. Byte i of a swizzled pixel is byte
+  // perm[i] of the source pixel, or 0xff if perm[i] > 3. The 565 kernels
+  // convert from and to the xrgb8888 layout.
+  struct kernels_t
+  {
+    shm_isa isa;
+    void (*fill32)(uint32_t *dst, std::size_t n, uint32_t value);
+    void (*premultiply32)(uint32_t *p, std::size_t n, unsigned int alpha_byte);
+    void (*unpremultiply32)(uint32_t *p, std::size_t n, unsigned int alpha_byte);
+    void (*swizzle32)(uint32_t *dst, const uint32_t *src, std::size_t n, const uint8_t *perm);
+    void (*rgb565_to_xrgb8888)(uint32_t *dst, const uint16_t *src, std::size_t n);
+    void (*xrgb8888_to_rgb565)(uint16_t *dst, const uint32_t *src, std::size_t n);
+  };
+
+  // x / 255 rounded to nearest, for x <= 255 * 255
+  inline uint32_t div255(uint32_t x)
+  {
+    x += 128;
+    return (x + (x >> 8)) >> 8;
+  }
+
+  void fill32_scalar(uint32_t *dst, std::size_t n, uint32_t value)
+  {
+    std::fill_n(dst, n, value);
+  }
+
+  void premultiply32_scalar(uint32_t *p, std::size_t n, unsigned int alpha_byte)
+  {
+    unsigned int alpha_shift = alpha_byte * 8;
+    for(std::size_t i = 0; i < n; i++)
+    {
+      uint32_t a = (p[i] >> alpha_shift) & 0xff;
+      uint32_t out = p[i] & (0xffU << alpha_shift);
+      for(unsigned int shift = 0; shift < 32; shift += 8)
+        if(shift != alpha_shift)
+          out |= div255(((p[i] >> shift) & 0xff) * a) << shift;
+      p[i] = out;
+    }
+  }
+
+  void unpremultiply32_scalar(uint32_t *p, std::size_t n, unsigned int alpha_byte)
+  {
+    unsigned int alpha_shift = alpha_byte * 8;
+    for(std::size_t i = 0; i < n; i++)
+    {
+      uint32_t a = (p[i] >> alpha_shift) & 0xff;
+      if(a == 0)
+      {
+        p[i] = 0;
+        continue;
+      }
+      uint32_t out = p[i] & (0xffU << alpha_shift);
+      for(unsigned int shift = 0; shift < 32; shift += 8)
+        if(shift != alpha_shift)
+          out |= std::min<uint32_t>(255, ((((p[i] >> shift) & 0xff) * 255) + a / 2) / a) << shift;
+      p[i] = out;
+    }
+  }
+
+  void swizzle32_scalar(uint32_t *dst, const uint32_t *src, std::size_t n, const uint8_t *perm)
+  {
+    for(std::size_t i = 0; i < n; i++)
+    {
+      uint32_t in = src[i];
+      uint32_t out = 0;
+      for(unsigned int byte = 0; byte < 4; byte++)
+        out |= (perm[byte] > 3 ? 0xffU : (in >> (perm[byte] * 8)) & 0xff) << (byte * 8);
+      dst[i] = out;
+    }
+  }
+
+  void rgb565_to_xrgb8888_scalar(uint32_t *dst, const uint16_t *src, std::size_t n)
+  {
+    for(std::size_t i = 0; i < n; i++)
+    {
+      uint32_t r = src[i] >> 11;
+      uint32_t g = (src[i] >> 5) & 0x3f;
+      uint32_t b = src[i] & 0x1f;
+      dst[i] = 0xff000000U | ((r << 3 | r >> 2) << 16) | ((g << 2 | g >> 4) << 8) | (b << 3 | b >> 2);
+    }
+  }
+
+  void xrgb8888_to_rgb565_scalar(uint16_t *dst, const uint32_t *src, std::size_t n)
+  {
+    for(std::size_t i = 0; i < n; i++)
+    {
+      uint32_t r = div255(((src[i] >> 16) & 0xff) * 31);
+      uint32_t g = div255(((src[i] >> 8) & 0xff) * 63);
+      uint32_t b = div255((src[i] & 0xff) * 31);
+      dst[i] = static_cast<uint16_t>(r << 11 | g << 5 | b);
+    }
+  }
+
+  const kernels_t scalar_kernels =
+  {
+    shm_isa::scalar, fill32_scalar, premultiply32_scalar, unpremultiply32_scalar,
+    swizzle32_scalar, rgb565_to_xrgb8888_scalar, xrgb8888_to_rgb565_scalar
+  };
+
+#ifdef WAYLAND_SHM_X86
+  //---------------------------------------------------------------------------
+  // SSE2
+
+  TARGET_SSE2 void fill32_sse2(uint32_t *dst, std::size_t n, uint32_t value)
+  {
+    __m128i v = _mm_set1_epi32(static_cast<int>(value));
+    std::size_t i = 0;
+    for(; i + 4 <= n; i += 4)
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+    fill32_scalar(dst + i, n - i, value);
+  }
+
+  TARGET_SSE2 inline __m128i div255_sse2(__m128i x)
+  {
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+  }
+
+  template <int A>
+  TARGET_SSE2 void premultiply32_sse2_t(uint32_t *p, std::size_t n)
+  {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha_mask = _mm_set1_epi32(static_cast<int>(0xffU << (A * 8)));
+    std::size_t i = 0;
+    for(; i + 4 <= n; i += 4)
+    {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+      __m128i lo = _mm_unpacklo_epi8(v, zero);
+      __m128i hi = _mm_unpackhi_epi8(v, zero);
+      __m128i alo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(A, A, A, A)), _MM_SHUFFLE(A, A, A, A));
+      __m128i ahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(A, A, A, A)), _MM_SHUFFLE(A, A, A, A));
+      lo = div255_sse2(_mm_mullo_epi16(lo, alo));
+      hi = div255_sse2(_mm_mullo_epi16(hi, ahi));
+      __m128i out = _mm_packus_epi16(lo, hi);
+      out = _mm_or_si128(_mm_and_si128(v, alpha_mask), _mm_andnot_si128(alpha_mask, out));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(p + i), out);
+    }
+    premultiply32_scalar(p + i, n - i, A);
+  }
+
+  TARGET_SSE2 void premultiply32_sse2(uint32_t *p, std::size_t n, unsigned int alpha_byte)
+  {
+    if(alpha_byte == 3)
+      premultiply32_sse2_t<3>(p, n);
+    else
+      premultiply32_sse2_t<0>(p, n);
+  }
+
+  // Unpremultiplies one pixel with 32 bit channels. The quotient of
+  // integers below 2^16 is rounded correctly by the float division, and its
+  // distance to the next integer is large enough, so truncation gives the
+  // same result as the integer division.
+  template <int A>
+  TARGET_SSE2 inline __m128i unpremultiply_pixel_sse2(__m128i c)
+  {
+    const __m128i zero = _mm_setzero_si128();
+    __m128i a = _mm_shuffle_epi32(c, _MM_SHUFFLE(A, A, A, A));
+    __m128i transparent = _mm_cmpeq_epi32(a, zero);
+    __m128i divisor = _mm_or_si128(a, _mm_and_si128(transparent, _mm_set1_epi32(1)));
+    __m128i numerator = _mm_add_epi32(_mm_sub_epi32(_mm_slli_epi32(c, 8), c), _mm_srli_epi32(a, 1));
+    __m128 q = _mm_div_ps(_mm_cvtepi32_ps(numerator), _mm_cvtepi32_ps(divisor));
+    q = _mm_min_ps(q, _mm_set1_ps(255.0F));
+    return _mm_andnot_si128(transparent, _mm_cvttps_epi32(q));
+  }
+
+  template <int A>
+  TARGET_SSE2 void unpremultiply32_sse2_t(uint32_t *p, std::size_t n)
+  {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i alpha_mask = _mm_set1_epi32(static_cast<int>(0xffU << (A * 8)));
+    std::size_t i = 0;
+    for(; i + 4 <= n; i += 4)
+    {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+      __m128i lo = _mm_unpacklo_epi8(v, zero);
+      __m128i hi = _mm_unpackhi_epi8(v, zero);
+      __m128i p0 = unpremultiply_pixel_sse2<A>(_mm_unpacklo_epi16(lo, zero));
+      __m128i p1 = unpremultiply_pixel_sse2<A>(_mm_unpackhi_epi16(lo, zero));
+      __m128i p2 = unpremultiply_pixel_sse2<A>(_mm_unpacklo_epi16(hi, zero));
+      __m128i p3 = unpremultiply_pixel_sse2<A>(_mm_unpackhi_epi16(hi, zero));
+      __m128i out = _mm_packus_epi16(_mm_packs_epi32(p0, p1), _mm_packs_epi32(p2, p3));
+      out = _mm_or_si128(_mm_and_si128(v, alpha_mask), _mm_andnot_si128(alpha_mask, out));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(p + i), out);
+    }
+    unpremultiply32_scalar(p + i, n - i, A);
+  }
+
+  TARGET_SSE2 void unpremultiply32_sse2(uint32_t *p, std::size_t n, unsigned int alpha_byte)
+  {
+    if(alpha_byte == 3)
+      unpremultiply32_sse2_t<3>(p, n);
+    else
+      unpremultiply32_sse2_t<0>(p, n);
+  }
+
+  // SSE2 has no byte shuffle, so the bytes are moved with shifts. Bytes
+  // that move by the same distance share one shift.
+  TARGET_SSE2 void swizzle32_sse2(uint32_t *dst, const uint32_t *src, std::size_t n, const uint8_t *perm)
+  {
+    int shifts[4];
+    uint32_t masks[4];
+    unsigned int terms = 0;
+    uint32_t fill = 0;
+    for(unsigned int byte = 0; byte < 4; byte++)
+    {
+      if(perm[byte] > 3)
+      {
+        fill |= 0xffU << (byte * 8);
+        continue;
+      }
+      int shift = (static_cast<int>(byte) - static_cast<int>(perm[byte])) * 8;
+      unsigned int t = 0;
+      while(t < terms && shifts[t] != shift)
+        t++;
+      if(t == terms)
+      {
+        shifts[terms] = shift;
+        masks[terms++] = 0;
+      }
+      masks[t] |= 0xffU << (byte * 8);
+    }
+
+    __m128i counts[4];
+    __m128i vmasks[4];
+    for(unsigned int t = 0; t < terms; t++)
+    {
+      counts[t] = _mm_cvtsi32_si128(std::abs(shifts[t]));
+      vmasks[t] = _mm_set1_epi32(static_cast<int>(masks[t]));
+    }
+    const __m128i vfill = _mm_set1_epi32(static_cast<int>(fill));
+
+    std::size_t i = 0;
+    for(; i + 4 <= n; i += 4)
+    {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+      __m128i out = vfill;
+      for(unsigned int t = 0; t < terms; t++)
+      {
+        __m128i moved = shifts[t] >= 0 ? _mm_sll_epi32(v, counts[t]) : _mm_srl_epi32(v, counts[t]);
+        out = _mm_or_si128(out, _mm_and_si128(moved, vmasks[t]));
+      }
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), out);
+    }
+    swizzle32_scalar(dst + i, src + i, n - i, perm);
+  }
+
+  TARGET_SSE2 void rgb565_to_xrgb8888_sse2(uint32_t *dst, const uint16_t *src, std::size_t n)
+  {
+    const __m128i mask5 = _mm_set1_epi16(0x1f);
+    const __m128i mask6 = _mm_set1_epi16(0x3f);
+    const __m128i opaque = _mm_set1_epi16(static_cast<short>(0xff00));
+    std::size_t i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+      __m128i r = _mm_srli_epi16(v, 11);
+      __m128i g = _mm_and_si128(_mm_srli_epi16(v, 5), mask6);
+      __m128i b = _mm_and_si128(v, mask5);
+      r = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+      g = _mm_or_si128(_mm_slli_epi16(g, 2), _mm_srli_epi16(g, 4));
+      b = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+      __m128i gb = _mm_or_si128(_mm_slli_epi16(g, 8), b);
+      __m128i xr = _mm_or_si128(r, opaque);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_unpacklo_epi16(gb, xr));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i + 4), _mm_unpackhi_epi16(gb, xr));
+    }
+    rgb565_to_xrgb8888_scalar(dst + i, src + i, n - i);
+  }
+
+  TARGET_SSE2 void xrgb8888_to_rgb565_sse2(uint16_t *dst, const uint32_t *src, std::size_t n)
+  {
+    const __m128i mask = _mm_set1_epi32(0xff);
+    std::size_t i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+      __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+      __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 4));
+      __m128i b = _mm_packs_epi32(_mm_and_si128(v0, mask), _mm_and_si128(v1, mask));
+      __m128i g = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(v0, 8), mask), _mm_and_si128(_mm_srli_epi32(v1, 8), mask));
+      __m128i r = _mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(v0, 16), mask), _mm_and_si128(_mm_srli_epi32(v1, 16), mask));
+      r = div255_sse2(_mm_mullo_epi16(r, _mm_set1_epi16(31)));
+      g = div255_sse2(_mm_mullo_epi16(g, _mm_set1_epi16(63)));
+      b = div255_sse2(_mm_mullo_epi16(b, _mm_set1_epi16(31)));
+      __m128i out = _mm_or_si128(_mm_or_si128(_mm_slli_epi16(r, 11), _mm_slli_epi16(g, 5)), b);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), out);
+    }
+    xrgb8888_to_rgb565_scalar(dst + i, src + i, n - i);
+  }
+
+  const kernels_t sse2_kernels =
+  {
+    shm_isa::sse2, fill32_sse2, premultiply32_sse2, unpremultiply32_sse2,
+    swizzle32_sse2, rgb565_to_xrgb8888_sse2, xrgb8888_to_rgb565_sse2
+  };
+
+  //---------------------------------------------------------------------------
+  // AVX2
+
+  TARGET_AVX2 void fill32_avx2(uint32_t *dst, std::size_t n, uint32_t value)
+  {
+    __m256i v = _mm256_set1_epi32(static_cast<int>(value));
+    std::size_t i = 0;
+    for(; i + 8 <= n; i += 8)
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+    fill32_scalar(dst + i, n - i, value);
+  }
+
+  TARGET_AVX2 inline __m256i div255_avx2(__m256i x)
+  {
+    x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+  }
+
+  // All operations work within 128 bit lanes, so unpacking and packing
+  // again keeps the order of the pixels.
+  template <int A>
+  TARGET_AVX2 void premultiply32_avx2_t(uint32_t *p, std::size_t n)
+  {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i alpha_mask = _mm256_set1_epi32(static_cast<int>(0xffU << (A * 8)));
+    std::size_t i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+      __m256i lo = _mm256_unpacklo_epi8(v, zero);
+      __m256i hi = _mm256_unpackhi_epi8(v, zero);
+      __m256i alo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(lo, _MM_SHUFFLE(A, A, A, A)), _MM_SHUFFLE(A, A, A, A));
+      __m256i ahi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(hi, _MM_SHUFFLE(A, A, A, A)), _MM_SHUFFLE(A, A, A, A));
+      lo = div255_avx2(_mm256_mullo_epi16(lo, alo));
+      hi = div255_avx2(_mm256_mullo_epi16(hi, ahi));
+      __m256i out = _mm256_packus_epi16(lo, hi);
+      out = _mm256_blendv_epi8(out, v, alpha_mask);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(p + i), out);
+    }
+    premultiply32_sse2_t<A>(p + i, n - i);
+  }
+
+  TARGET_AVX2 void premultiply32_avx2(uint32_t *p, std::size_t n, unsigned int alpha_byte)
+  {
+    if(alpha_byte == 3)
+      premultiply32_avx2_t<3>(p, n);
+    else
+      premultiply32_avx2_t<0>(p, n);
+  }
+
+  // same as unpremultiply_pixel_sse2(), for two pixels
+  template <int A>
+  TARGET_AVX2 inline __m256i unpremultiply_pixels_avx2(__m256i c)
+  {
+    __m256i a = _mm256_shuffle_epi32(c, _MM_SHUFFLE(A, A, A, A));
+    __m256i transparent = _mm256_cmpeq_epi32(a, _mm256_setzero_si256());
+    __m256i divisor = _mm256_max_epi32(a, _mm256_set1_epi32(1));
+    __m256i numerator = _mm256_add_epi32(_mm256_mullo_epi32(c, _mm256_set1_epi32(255)), _mm256_srli_epi32(a, 1));
+    __m256 q = _mm256_div_ps(_mm256_cvtepi32_ps(numerator), _mm256_cvtepi32_ps(divisor));
+    q = _mm256_min_ps(q, _mm256_set1_ps(255.0F));
+    return _mm256_andnot_si256(transparent, _mm256_cvttps_epi32(q));
+  }
+
+  template <int A>
+  TARGET_AVX2 void unpremultiply32_avx2_t(uint32_t *p, std::size_t n)
+  {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i alpha_mask = _mm256_set1_epi32(static_cast<int>(0xffU << (A * 8)));
+    std::size_t i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+      __m256i lo = _mm256_unpacklo_epi8(v, zero);
+      __m256i hi = _mm256_unpackhi_epi8(v, zero);
+      __m256i p0 = unpremultiply_pixels_avx2<A>(_mm256_unpacklo_epi16(lo, zero));
+      __m256i p1 = unpremultiply_pixels_avx2<A>(_mm256_unpackhi_epi16(lo, zero));
+      __m256i p2 = unpremultiply_pixels_avx2<A>(_mm256_unpacklo_epi16(hi, zero));
+      __m256i p3 = unpremultiply_pixels_avx2<A>(_mm256_unpackhi_epi16(hi, zero));
+      __m256i out = _mm256_packus_epi16(_mm256_packs_epi32(p0, p1), _mm256_packs_epi32(p2, p3));
+      out = _mm256_blendv_epi8(out, v, alpha_mask);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(p + i), out);
+    }
+    unpremultiply32_sse2_t<A>(p + i, n - i);
+  }
+
+  TARGET_AVX2 void unpremultiply32_avx2(uint32_t *p, std::size_t n, unsigned int alpha_byte)
+  {
+    if(alpha_byte == 3)
+      unpremultiply32_avx2_t<3>(p, n);
+    else
+      unpremultiply32_avx2_t<0>(p, n);
+  }
+
+  TARGET_AVX2 void swizzle32_avx2(uint32_t *dst, const uint32_t *src, std::size_t n, const uint8_t *perm)
+  {
+    alignas(32) uint8_t indices[32];
+    uint32_t fill = 0;
+    for(unsigned int byte = 0; byte < 4; byte++)
+      if(perm[byte] > 3)
+        fill |= 0xffU << (byte * 8);
+    for(unsigned int i = 0; i < 32; i++)
+    {
+      uint8_t from = perm[i % 4];
+      // indices with the high bit set produce zero
+      indices[i] = from > 3 ? 0x80 : static_cast<uint8_t>((i % 16) / 4 * 4 + from);
+    }
+    const __m256i shuffle = _mm256_load_si256(reinterpret_cast<const __m256i*>(indices));
+    const __m256i vfill = _mm256_set1_epi32(static_cast<int>(fill));
+
+    std::size_t i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+      v = _mm256_or_si256(_mm256_shuffle_epi8(v, shuffle), vfill);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+    }
+    swizzle32_sse2(dst + i, src + i, n - i, perm);
+  }
+
+  TARGET_AVX2 void rgb565_to_xrgb8888_avx2(uint32_t *dst, const uint16_t *src, std::size_t n)
+  {
+    const __m256i mask5 = _mm256_set1_epi16(0x1f);
+    const __m256i mask6 = _mm256_set1_epi16(0x3f);
+    const __m256i opaque = _mm256_set1_epi16(static_cast<short>(0xff00));
+    std::size_t i = 0;
+    for(; i + 16 <= n; i += 16)
+    {
+      __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+      __m256i r = _mm256_srli_epi16(v, 11);
+      __m256i g = _mm256_and_si256(_mm256_srli_epi16(v, 5), mask6);
+      __m256i b = _mm256_and_si256(v, mask5);
+      r = _mm256_or_si256(_mm256_slli_epi16(r, 3), _mm256_srli_epi16(r, 2));
+      g = _mm256_or_si256(_mm256_slli_epi16(g, 2), _mm256_srli_epi16(g, 4));
+      b = _mm256_or_si256(_mm256_slli_epi16(b, 3), _mm256_srli_epi16(b, 2));
+      __m256i gb = _mm256_or_si256(_mm256_slli_epi16(g, 8), b);
+      __m256i xr = _mm256_or_si256(r, opaque);
+      // pixels 0-3 and 8-11, and 4-7 and 12-15
+      __m256i lo = _mm256_unpacklo_epi16(gb, xr);
+      __m256i hi = _mm256_unpackhi_epi16(gb, xr);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_permute2x128_si256(lo, hi, 0x20));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i + 8), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    rgb565_to_xrgb8888_sse2(dst + i, src + i, n - i);
+  }
+
+  TARGET_AVX2 void xrgb8888_to_rgb565_avx2(uint16_t *dst, const uint32_t *src, std::size_t n)
+  {
+    const __m256i mask = _mm256_set1_epi32(0xff);
+    std::size_t i = 0;
+    for(; i + 16 <= n; i += 16)
+    {
+      __m256i v0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+      __m256i v1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 8));
+      __m256i b = _mm256_packs_epi32(_mm256_and_si256(v0, mask), _mm256_and_si256(v1, mask));
+      __m256i g = _mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(v0, 8), mask), _mm256_and_si256(_mm256_srli_epi32(v1, 8), mask));
+      __m256i r = _mm256_packs_epi32(_mm256_and_si256(_mm256_srli_epi32(v0, 16), mask), _mm256_and_si256(_mm256_srli_epi32(v1, 16), mask));
+      r = div255_avx2(_mm256_mullo_epi16(r, _mm256_set1_epi16(31)));
+      g = div255_avx2(_mm256_mullo_epi16(g, _mm256_set1_epi16(63)));
+      b = div255_avx2(_mm256_mullo_epi16(b, _mm256_set1_epi16(31)));
+      __m256i out = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi16(r, 11), _mm256_slli_epi16(g, 5)), b);
+      // packing interleaves the 64 bit blocks of both inputs
+      out = _mm256_permute4x64_epi64(out, _MM_SHUFFLE(3, 1, 2, 0));
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), out);
+    }
+    xrgb8888_to_rgb565_sse2(dst + i, src + i, n - i);
+  }
+
+  const kernels_t avx2_kernels =
+  {
+    shm_isa::avx2, fill32_avx2, premultiply32_avx2, unpremultiply32_avx2,
+    swizzle32_avx2, rgb565_to_xrgb8888_avx2, xrgb8888_to_rgb565_avx2
+  };
+#endif
+
+#ifdef WAYLAND_SHM_NEON
+  //---------------------------------------------------------------------------
+  // NEON
+
+  void fill32_neon(uint32_t *dst, std::size_t n, uint32_t value)
+  {
+    uint32x4_t v = vdupq_n_u32(value);
+    std::size_t i = 0;
+    for(; i + 4 <= n; i += 4)
+      vst1q_u32(dst + i, v);
+    fill32_scalar(dst + i, n - i, value);
+  }
+
+  // same rounding as div255()
+  inline uint8x8_t div255_neon(uint16x8_t x)
+  {
+    return vraddhn_u16(x, vrshrq_n_u16(x, 8));
+  }
+
+  inline uint8x16_t multiply_neon(uint8x16_t c, uint8x16_t a)
+  {
+    return vcombine_u8(div255_neon(vmull_u8(vget_low_u8(c), vget_low_u8(a))),
+                       div255_neon(vmull_u8(vget_high_u8(c), vget_high_u8(a))));
+  }
+
+  void premultiply32_neon(uint32_t *p, std::size_t n, unsigned int alpha_byte)
+  {
+    std::size_t i = 0;
+    for(; i + 16 <= n; i += 16)
+    {
+      uint8x16x4_t v = vld4q_u8(reinterpret_cast<const uint8_t*>(p + i));
+      uint8x16_t a = v.val[alpha_byte];
+      for(unsigned int c = 0; c < 4; c++)
+        if(c != alpha_byte)
+          v.val[c] = multiply_neon(v.val[c], a);
+      vst4q_u8(reinterpret_cast<uint8_t*>(p + i), v);
+    }
+    premultiply32_scalar(p + i, n - i, alpha_byte);
+  }
+
+  // see unpremultiply_pixel_sse2()
+  inline uint32x4_t unpremultiply_neon(uint32x4_t c, uint32x4_t a)
+  {
+    uint32x4_t numerator = vmlaq_n_u32(vshrq_n_u32(a, 1), c, 255);
+    float32x4_t q = vdivq_f32(vcvtq_f32_u32(numerator), vcvtq_f32_u32(vmaxq_u32(a, vdupq_n_u32(1))));
+    q = vminq_f32(q, vdupq_n_f32(255.0F));
+    return vandq_u32(vcvtq_u32_f32(q), vtstq_u32(a, a));
+  }
+
+  void unpremultiply32_neon(uint32_t *p, std::size_t n, unsigned int alpha_byte)
+  {
+    std::size_t i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+      uint8x8x4_t v = vld4_u8(reinterpret_cast<const uint8_t*>(p + i));
+      uint16x8_t a16 = vmovl_u8(v.val[alpha_byte]);
+      uint32x4_t alo = vmovl_u16(vget_low_u16(a16));
+      uint32x4_t ahi = vmovl_u16(vget_high_u16(a16));
+      uint8x8_t transparent = vceq_u8(v.val[alpha_byte], vdup_n_u8(0));
+      for(unsigned int c = 0; c < 4; c++)
+        if(c != alpha_byte)
+        {
+          uint16x8_t c16 = vmovl_u8(v.val[c]);
+          uint32x4_t lo = unpremultiply_neon(vmovl_u16(vget_low_u16(c16)), alo);
+          uint32x4_t hi = unpremultiply_neon(vmovl_u16(vget_high_u16(c16)), ahi);
+          v.val[c] = vbic_u8(vmovn_u16(vcombine_u16(vmovn_u32(lo), vmovn_u32(hi))), transparent);
+        }
+      vst4_u8(reinterpret_cast<uint8_t*>(p + i), v);
+    }
+    unpremultiply32_scalar(p + i, n - i, alpha_byte);
+  }
+
+  void swizzle32_neon(uint32_t *dst, const uint32_t *src, std::size_t n, const uint8_t *perm)
+  {
+    uint8_t indices[16];
+    uint32_t fill = 0;
+    for(unsigned int byte = 0; byte < 4; byte++)
+      if(perm[byte] > 3)
+        fill |= 0xffU << (byte * 8);
+    for(unsigned int i = 0; i < 16; i++)
+    {
+      uint8_t from = perm[i % 4];
+      // out of range indices produce zero
+      indices[i] = from > 3 ? 0xff : static_cast<uint8_t>(i / 4 * 4 + from);
+    }
+    const uint8x16_t shuffle = vld1q_u8(indices);
+    const uint8x16_t vfill = vreinterpretq_u8_u32(vdupq_n_u32(fill));
+
+    std::size_t i = 0;
+    for(; i + 4 <= n; i += 4)
+    {
+      uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t*>(src + i));
+      vst1q_u8(reinterpret_cast<uint8_t*>(dst + i), vorrq_u8(vqtbl1q_u8(v, shuffle), vfill));
+    }
+    swizzle32_scalar(dst + i, src + i, n - i, perm);
+  }
+
+  void rgb565_to_xrgb8888_neon(uint32_t *dst, const uint16_t *src, std::size_t n)
+  {
+    std::size_t i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+      uint16x8_t v = vld1q_u16(src + i);
+      uint16x8_t r = vshrq_n_u16(v, 11);
+      uint16x8_t g = vandq_u16(vshrq_n_u16(v, 5), vdupq_n_u16(0x3f));
+      uint16x8_t b = vandq_u16(v, vdupq_n_u16(0x1f));
+      uint8x8x4_t out;
+      out.val[0] = vmovn_u16(vorrq_u16(vshlq_n_u16(b, 3), vshrq_n_u16(b, 2)));
+      out.val[1] = vmovn_u16(vorrq_u16(vshlq_n_u16(g, 2), vshrq_n_u16(g, 4)));
+      out.val[2] = vmovn_u16(vorrq_u16(vshlq_n_u16(r, 3), vshrq_n_u16(r, 2)));
+      out.val[3] = vdup_n_u8(0xff);
+      vst4_u8(reinterpret_cast<uint8_t*>(dst + i), out);
+    }
+    rgb565_to_xrgb8888_scalar(dst + i, src + i, n - i);
+  }
+
+  void xrgb8888_to_rgb565_neon(uint16_t *dst, const uint32_t *src, std::size_t n)
+  {
+    std::size_t i = 0;
+    for(; i + 8 <= n; i += 8)
+    {
+      uint8x8x4_t v = vld4_u8(reinterpret_cast<const uint8_t*>(src + i));
+      uint16x8_t b = vmovl_u8(div255_neon(vmull_u8(v.val[0], vdup_n_u8(31))));
+      uint16x8_t g = vmovl_u8(div255_neon(vmull_u8(v.val[1], vdup_n_u8(63))));
+      uint16x8_t r = vmovl_u8(div255_neon(vmull_u8(v.val[2], vdup_n_u8(31))));
+      vst1q_u16(dst + i, vorrq_u16(vorrq_u16(vshlq_n_u16(r, 11), vshlq_n_u16(g, 5)), b));
+    }
+    xrgb8888_to_rgb565_scalar(dst + i, src + i, n - i);
+  }
+
+  const kernels_t neon_kernels =
+  {
+    shm_isa::neon, fill32_neon, premultiply32_neon, unpremultiply32_neon,
+    swizzle32_neon, rgb565_to_xrgb8888_neon, xrgb8888_to_rgb565_neon
+  };
+#endif
+
+  //---------------------------------------------------------------------------
+  // dispatch
+
+  const kernels_t *kernels_for(shm_isa isa)
+  {
+    switch(isa)
+    {
+    case shm_isa::scalar:
+      return &scalar_kernels;
+#ifdef WAYLAND_SHM_X86
+    case shm_isa::sse2:
+      return __builtin_cpu_supports("sse2") ? &sse2_kernels : nullptr;
+    case shm_isa::avx2:
+      return __builtin_cpu_supports("avx2") ? &avx2_kernels : nullptr;
+#endif
+#ifdef WAYLAND_SHM_NEON
+    case shm_isa::neon:
+      return &neon_kernels;
+#endif
+    default:
+      return nullptr;
+    }
+  }
+
+  std::atomic<const kernels_t*> active_kernels{nullptr};
+
+  const kernels_t &kernels()
+  {
+    const kernels_t *k = active_kernels.load(std::memory_order_relaxed);
+    if(!k)
+    {
+      for(shm_isa isa : { shm_isa::avx2, shm_isa::neon, shm_isa::sse2, shm_isa::scalar })
+        if((k = kernels_for(isa)))
+          break;
+      active_kernels.store(k, std::memory_order_relaxed);
+    }
+    return *k;
+  }
+
+  //---------------------------------------------------------------------------
+  // row operations
+
+  // permutation for swizzle32 between two 8888 layouts, unused bits are set
+  // like in encode_row()
+  void make_perm(uint8_t *perm, const format_info_t &dst, const format_info_t &src)
+  {
+    perm[dst.r.shift / 8] = static_cast<uint8_t>(src.r.shift / 8);
+    perm[dst.g.shift / 8] = static_cast<uint8_t>(src.g.shift / 8);
+    perm[dst.b.shift / 8] = static_cast<uint8_t>(src.b.shift / 8);
+    perm[dst.a.shift / 8] = dst.alpha && src.alpha ? static_cast<uint8_t>(src.a.shift / 8) : 0xff;
+  }
+
+  // Converts a row of pixels. dst and src do not overlap.
+  void convert_row(uint8_t *dst, const format_info_t &dst_info, const uint8_t *src, const format_info_t &src_info, std::size_t n)
+  {
+    const kernels_t &k = kernels();
+    if(is_8888(dst_info) && is_8888(src_info))
+    {
+      uint8_t perm[4];
+      make_perm(perm, dst_info, src_info);
+      k.swizzle32(reinterpret_cast<uint32_t*>(dst), reinterpret_cast<const uint32_t*>(src), n, perm);
+    }
+    else if(is_8888(dst_info) && is_565(src_info))
+    {
+      // bgr565 decodes to xbgr8888
+      const format_info_t &wide = src_info.format == rgb565 ? xrgb8888_info : xbgr8888_info;
+      auto *out = reinterpret_cast<uint32_t*>(dst);
+      k.rgb565_to_xrgb8888(out, reinterpret_cast<const uint16_t*>(src), n);
+      if(dst_info.format != wide.format)
+      {
+        uint8_t perm[4];
+        make_perm(perm, dst_info, wide);
+        k.swizzle32(out, out, n, perm);
+      }
+    }
+    else if(is_565(dst_info) && is_8888(src_info))
+    {
+      const format_info_t &wide = dst_info.format == rgb565 ? xrgb8888_info : xbgr8888_info;
+      uint8_t perm[4];
+      make_perm(perm, wide, src_info);
+      uint32_t tmp[chunk_size];
+      for(std::size_t i = 0; i < n; i += chunk_size)
+      {
+        std::size_t count = std::min(chunk_size, n - i);
+        k.swizzle32(tmp, reinterpret_cast<const uint32_t*>(src) + i, count, perm);
+        k.xrgb8888_to_rgb565(reinterpret_cast<uint16_t*>(dst) + i, tmp, count);
+      }
+    }
+    else
+    {
+      pixel16_t tmp[chunk_size];
+      for(std::size_t i = 0; i < n; i += chunk_size)
+      {
+        std::size_t count = std::min(chunk_size, n - i);
+        decode_row(tmp, src + i * src_info.bytes, src_info, count);
+        encode_row(dst + i * dst_info.bytes, tmp, dst_info, count);
+      }
+    }
+  }
+
+  template <typename F>
+  void for_each_chunk16(uint8_t *row, const format_info_t &info, std::size_t n, F f)
+  {
+    pixel16_t tmp[chunk_size];
+    for(std::size_t i = 0; i < n; i += chunk_size)
+    {
+      std::size_t count = std::min(chunk_size, n - i);
+      decode_row(tmp, row + i * info.bytes, info, count);
+      for(std::size_t j = 0; j < count; j++)
+        f(tmp[j]);
+      encode_row(row + i * info.bytes, tmp, info, count);
+    }
+  }
+
+  uint8_t *pixel_address(const shm_image_t &image, const format_info_t &info, int32_t x, int32_t y)
+  {
+    return static_cast<uint8_t*>(image.data) + static_cast<std::ptrdiff_t>(y) * image.stride
+      + static_cast<std::ptrdiff_t>(x) * info.bytes;
+  }
+
+  // Clips a rectangle to [0, width) x [0, height). Returns false if nothing is left.
+  bool clip(int32_t &x, int32_t &y, int32_t &width, int32_t &height, int32_t max_width, int32_t max_height,
+            int32_t &other_x, int32_t &other_y)
+  {
+    if(x < 0)
+    {
+      width += x;
+      other_x -= x;
+      x = 0;
+    }
+    if(y < 0)
+    {
+      height += y;
+      other_y -= y;
+      y = 0;
+    }
+    width = std::min(width, max_width - x);
+    height = std::min(height, max_height - y);
+    return width > 0 && height > 0;
+  }
+}
+
+bool wayland::shm_format_supported(uint32_t format)
+{
+  return find_format(format) != nullptr;
+}
+
+bool wayland::shm_format_has_alpha(uint32_t format)
+{
+  const format_info_t *info = find_format(format);
+  return info && info->alpha;
+}
+
+shm_isa wayland::shm_get_isa()
+{
+  return kernels().isa;
+}
+
+bool wayland::shm_isa_supported(shm_isa isa)
+{
+  return kernels_for(isa) != nullptr;
+}
+
+bool wayland::shm_set_isa(shm_isa isa)
+{
+  const kernels_t *k = kernels_for(isa);
+  if(!k)
+    return false;
+  active_kernels.store(k, std::memory_order_relaxed);
+  return true;
+}
+
+void wayland::shm_fill_rect(const shm_image_t &dst, int32_t x, int32_t y, int32_t width, int32_t height, uint32_t color)
+{
+  const format_info_t &info = require_format(dst.format);
+  int32_t unused_x = 0;
+  int32_t unused_y = 0;
+  if(!clip(x, y, width, height, dst.width, dst.height, unused_x, unused_y))
+    return;
+
+  uint8_t pixel[8];
+  auto argb = reinterpret_cast<const uint8_t*>(&color);
+  convert_row(pixel, info, argb, format_infos[0], 1);
+  uint32_t value32 = 0;
+  if(info.bytes == 4)
+    std::memcpy(&value32, pixel, 4);
+
+  for(int32_t row = 0; row < height; row++)
+  {
+    uint8_t *p = pixel_address(dst, info, x, y + row);
+    if(info.bytes == 4)
+      kernels().fill32(reinterpret_cast<uint32_t*>(p), width, value32);
+    else if(info.bytes == 1)
+      std::memset(p, pixel[0], width);
+    else
+    {
+      // doubling copies
+      std::memcpy(p, pixel, info.bytes);
+      std::size_t done = info.bytes;
+      std::size_t total = static_cast<std::size_t>(width) * info.bytes;
+      while(done < total)
+      {
+        std::size_t count = std::min(done, total - done);
+        std::memcpy(p + done, p, count);
+        done += count;
+      }
+    }
+  }
+}
+
+void wayland::shm_blit(const shm_image_t &dst, int32_t dst_x, int32_t dst_y,
+                       const shm_image_t &src, int32_t src_x, int32_t src_y,
+                       int32_t width, int32_t height)
+{
+  const format_info_t &dst_info = require_format(dst.format);
+  const format_info_t &src_info = require_format(src.format);
+  if(!clip(dst_x, dst_y, width, height, dst.width, dst.height, src_x, src_y)
+     || !clip(src_x, src_y, width, height, src.width, src.height, dst_x, dst_y))
+    return;
+
+  bool same = dst_info.format == src_info.format;
+  // copy rows bottom up if they overlap downwards
+  bool reverse = same && dst.data == src.data && dst_y > src_y;
+  for(int32_t i = 0; i < height; i++)
+  {
+    int32_t row = reverse ? height - 1 - i : i;
+    uint8_t *d = pixel_address(dst, dst_info, dst_x, dst_y + row);
+    const uint8_t *s = pixel_address(src, src_info, src_x, src_y + row);
+    if(same)
+      std::memmove(d, s, static_cast<std::size_t>(width) * dst_info.bytes);
+    else
+      convert_row(d, dst_info, s, src_info, width);
+  }
+}
+
+void wayland::shm_convert(const shm_image_t &dst, const shm_image_t &src)
+{
+  shm_blit(dst, 0, 0, src, 0, 0, std::min(dst.width, src.width), std::min(dst.height, src.height));
+}
+
+void wayland::shm_premultiply(const shm_image_t &image)
+{
+  const format_info_t &info = require_format(image.format);
+  if(!info.alpha)
+    return;
+  for(int32_t y = 0; y < image.height; y++)
+  {
+    uint8_t *row = pixel_address(image, info, 0, y);
+    if(is_8888(info))
+      kernels().premultiply32(reinterpret_cast<uint32_t*>(row), image.width, info.a.shift / 8);
+    else
+      for_each_chunk16(row, info, image.width, [] (pixel16_t &p)
+      {
+        p.r = static_cast<uint16_t>((uint32_t(p.r) * p.a + 32767) / 65535);
+        p.g = static_cast<uint16_t>((uint32_t(p.g) * p.a + 32767) / 65535);
+        p.b = static_cast<uint16_t>((uint32_t(p.b) * p.a + 32767) / 65535);
+      });
+  }
+}
+
+void wayland::shm_unpremultiply(const shm_image_t &image)
+{
+  const format_info_t &info = require_format(image.format);
+  if(!info.alpha)
+    return;
+  for(int32_t y = 0; y < image.height; y++)
+  {
+    uint8_t *row = pixel_address(image, info, 0, y);
+    if(is_8888(info))
+      kernels().unpremultiply32(reinterpret_cast<uint32_t*>(row), image.width, info.a.shift / 8);
+    else
+      for_each_chunk16(row, info, image.width, [] (pixel16_t &p)
+      {
+        if(p.a == 0)
+        {
+          p = pixel16_t{ 0, 0, 0, 0 };
+          return;
+        }
+        p.r = static_cast<uint16_t>(std::min<uint32_t>(65535, (uint32_t(p.r) * 65535 + p.a / 2) / p.a));
+        p.g = static_cast<uint16_t>(std::min<uint32_t>(65535, (uint32_t(p.g) * 65535 + p.a / 2) / p.a));
+        p.b = static_cast<uint16_t>(std::min<uint32_t>(65535, (uint32_t(p.b) * 65535 + p.a / 2) / p.a));
+      });
+  }
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <wayland-solid-surface.hpp>
+
+using namespace wayland;
+
+namespace
+{
+  uint32_t channel(uint32_t color, unsigned int shift)
+  {
+    return (color >> shift) & 0xff;
+  }
+
+  // premultiplied channel with 32 bits, as used by wp_single_pixel_buffer_v1
+  uint32_t premultiply32(uint32_t value, uint32_t alpha)
+  {
+    const uint64_t max = std::numeric_limits<uint32_t>::max();
+    return static_cast<uint32_t>((value * alpha * max + 255 * 255 / 2) / (255 * 255));
+  }
+
+  // premultiplied channel with 8 bits
+  uint32_t premultiply8(uint32_t value, uint32_t alpha)
+  {
+    return (value * alpha + 127) / 255;
+  }
+}
+
+solid_buffer_cache_t::solid_buffer_cache_t(single_pixel_buffer_manager_v1_t manager, shm_t shm)
+  : manager(std::move(manager))
+{
+  if(!this->manager)
+  {
+    if(!shm)
+      throw std::invalid_argument("Solid buffers need a single pixel buffer manager or a shm global.");
+    pool.reset(new shm_buffer_pool_t(shm, std::numeric_limits<unsigned int>::max()));
+  }
+}
+
+buffer_t solid_buffer_cache_t::get(uint32_t color)
+{
+  auto it = buffers.find(color);
+  if(it != buffers.end())
+    return it->second.buffer;
+
+  uint32_t a = channel(color, 24);
+  uint32_t r = channel(color, 16);
+  uint32_t g = channel(color, 8);
+  uint32_t b = channel(color, 0);
+  entry_t entry;
+  if(manager)
+    entry.buffer = manager.create_u32_rgba_buffer(premultiply32(r, a), premultiply32(g, a), premultiply32(b, a),
+                                                  premultiply32(255, a));
+  else
+  {
+    // opaque colours use xrgb8888, so the compositor can skip blending
+    entry.shm_buffer = pool->acquire(1, 1, a == 255 ? shm_format::xrgb8888 : shm_format::argb8888);
+    uint32_t pixel = a << 24 | premultiply8(r, a) << 16 | premultiply8(g, a) << 8 | premultiply8(b, a);
+    std::memcpy(entry.shm_buffer.get_data(), &pixel, sizeof(pixel));
+    entry.buffer = entry.shm_buffer.get_buffer();
+  }
+  buffers[color] = entry;
+  return entry.buffer;
+}
+
+void solid_buffer_cache_t::clear()
+{
+  buffers.clear();
+  if(pool)
+    pool->trim();
+}
+
+std::size_t solid_buffer_cache_t::size() const
+{
+  return buffers.size();
+}
+
+solid_surface_t::solid_surface_t(surface_t surface, viewporter_t viewporter, solid_buffer_cache_t &cache)
+  : surface(std::move(surface)), cache(&cache)
+{
+  if(!viewporter)
+    throw std::invalid_argument("Solid surfaces need a viewporter.");
+  viewport = viewporter.get_viewport(this->surface);
+}
+
+void solid_surface_t::set(uint32_t color, int32_t width, int32_t height)
+{
+  if(width <= 0 || height <= 0)
+    throw std::invalid_argument("Surface size must be positive.");
+  buffer_t new_buffer = cache->get(color);
+  if(!buffer || !(new_buffer == buffer))
+  {
+    surface.attach(new_buffer, 0, 0);
+    if(surface.can_damage_buffer())
+      surface.damage_buffer(0, 0, 1, 1);
+    else
+      surface.damage(0, 0, width, height);
+    buffer = new_buffer;
+  }
+  if(width != this->width || height != this->height)
+  {
+    viewport.set_destination(width, height);
+    this->width = width;
+    this->height = height;
+  }
+}
+
+surface_t solid_surface_t::get_surface() const
+{
+  return surface;
+}
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdexcept>
+#include <wayland-surface-scale.hpp>
+
+using namespace wayland;
+using namespace wayland::detail;
+
+namespace
+{
+  // wp_fractional_scale_v1 uses a denominator of 120
+  const uint32_t scale_denominator = 120;
+}
+
+struct wayland::detail::surface_scale_data_t
+{
+  surface_t surface;
+  viewport_t viewport;
+  fractional_scale_v1_t fractional_scale;
+  std::function<void(int32_t, int32_t)> on_buffer_size;
+
+  int32_t logical_width = 0;
+  int32_t logical_height = 0;
+  uint32_t integer_scale = 1;
+  // 0 until the compositor sends a fractional scale
+  uint32_t preferred_scale = 0;
+  int32_t buffer_width = 0;
+  int32_t buffer_height = 0;
+
+  // state sent to the compositor
+  int32_t destination_width = 0;
+  int32_t destination_height = 0;
+  int32_t buffer_scale = 1;
+
+  uint32_t scale() const
+  {
+    if(viewport && preferred_scale)
+      return preferred_scale;
+    return integer_scale * scale_denominator;
+  }
+
+  // without viewport, only integer scales are possible
+  int32_t rounded_scale() const
+  {
+    return static_cast<int32_t>((scale() + scale_denominator - 1) / scale_denominator);
+  }
+
+  int32_t to_buffer(int32_t length) const
+  {
+    if(!viewport)
+      return length * rounded_scale();
+    // rounding half away from zero, as required by the protocol
+    return static_cast<int32_t>((static_cast<uint64_t>(length) * scale() + scale_denominator / 2) / scale_denominator);
+  }
+
+  void update()
+  {
+    int32_t width = to_buffer(logical_width);
+    int32_t height = to_buffer(logical_height);
+    if(width == buffer_width && height == buffer_height)
+      return;
+    buffer_width = width;
+    buffer_height = height;
+    if(on_buffer_size && width > 0 && height > 0)
+      on_buffer_size(width, height);
+  }
+};
+
+surface_scale_t::surface_scale_t(surface_t surface, viewporter_t viewporter, fractional_scale_manager_v1_t manager)
+  : data(new surface_scale_data_t)
+{
+  data->surface = std::move(surface);
+  if(viewporter)
+  {
+    data->viewport = viewporter.get_viewport(data->surface);
+    if(manager)
+    {
+      data->fractional_scale = manager.get_fractional_scale(data->surface);
+      surface_scale_data_t *d = data.get();
+      data->fractional_scale.on_preferred_scale() = [d] (uint32_t scale)
+      {
+        d->preferred_scale = scale;
+        d->update();
+      };
+    }
+  }
+}
+
+surface_scale_t::~surface_scale_t() = default;
+
+surface_scale_t::surface_scale_t(surface_scale_t&&) noexcept = default;
+
+surface_scale_t &surface_scale_t::operator=(surface_scale_t&&) noexcept = default;
+
+void surface_scale_t::set_logical_size(int32_t width, int32_t height)
+{
+  if(width < 0 || height < 0)
+    throw std::invalid_argument("Surface size must not be negative.");
+  data->logical_width = width;
+  data->logical_height = height;
+  data->update();
+}
+
+void surface_scale_t::set_integer_scale(int32_t scale)
+{
+  if(scale < 1)
+    throw std::invalid_argument("Scale must be positive.");
+  data->integer_scale = static_cast<uint32_t>(scale);
+  data->update();
+}
+
+std::function<void(int32_t, int32_t)> &surface_scale_t::on_buffer_size()
+{
+  return data->on_buffer_size;
+}
+
+void surface_scale_t::apply()
+{
+  if(data->viewport)
+  {
+    if(data->logical_width > 0 && data->logical_height > 0
+       && (data->logical_width != data->destination_width || data->logical_height != data->destination_height))
+    {
+      data->viewport.set_destination(data->logical_width, data->logical_height);
+      data->destination_width = data->logical_width;
+      data->destination_height = data->logical_height;
+    }
+  }
+  else if(data->rounded_scale() != data->buffer_scale && data->surface.can_set_buffer_scale())
+  {
+    data->surface.set_buffer_scale(data->rounded_scale());
+    data->buffer_scale = data->rounded_scale();
+  }
+}
+
+shm_pool_buffer_t surface_scale_t::acquire_buffer(shm_buffer_pool_t &pool, shm_format format)
+{
+  if(data->buffer_width <= 0 || data->buffer_height <= 0)
+    throw std::runtime_error("The logical size of the surface is not set.");
+  return pool.acquire(data->buffer_width, data->buffer_height, format);
+}
+
+double surface_scale_t::get_scale() const
+{
+  if(!data->viewport)
+    return data->rounded_scale();
+  return static_cast<double>(data->scale()) / scale_denominator;
+}
+
+bool surface_scale_t::is_fractional() const
+{
+  return data->viewport && data->preferred_scale != 0;
+}
+
+int32_t surface_scale_t::get_logical_width() const
+{
+  return data->logical_width;
+}
+
+int32_t surface_scale_t::get_logical_height() const
+{
+  return data->logical_height;
+}
+
+int32_t surface_scale_t::get_buffer_width() const
+{
+  return data->buffer_width;
+}
+
+int32_t surface_scale_t::get_buffer_height() const
+{
+  return data->buffer_height;
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <wayland-tablet-frame.hpp>
+
+using namespace wayland;
+using namespace wayland::detail;
+
+const uint32_t tablet_tool_frame_t::max_buttons;
+
+struct wayland::detail::tablet_tool_aggregator_data_t
+{
+  zwp_tablet_tool_v2_t tool;
+  std::function<void(const tablet_tool_frame_t&)> frame_handler;
+  tablet_tool_frame_t frame = tablet_tool_frame_t();
+  tablet_tool_frame_t state = tablet_tool_frame_t();
+  surface_t focus;
+  zwp_tablet_v2_t tablet;
+
+  ~tablet_tool_aggregator_data_t()
+  {
+    tool.on_proximity_in() = nullptr;
+    tool.on_proximity_out() = nullptr;
+    tool.on_down() = nullptr;
+    tool.on_up() = nullptr;
+    tool.on_motion() = nullptr;
+    tool.on_pressure() = nullptr;
+    tool.on_distance() = nullptr;
+    tool.on_tilt() = nullptr;
+    tool.on_rotation() = nullptr;
+    tool.on_slider() = nullptr;
+    tool.on_wheel() = nullptr;
+    tool.on_button() = nullptr;
+    tool.on_frame() = nullptr;
+  }
+
+  void deliver(uint32_t time)
+  {
+    state.time = time;
+    if(frame.valid)
+    {
+      frame.time = time;
+      frame.x = state.x;
+      frame.y = state.y;
+      frame.pressure = state.pressure;
+      frame.distance = state.distance;
+      frame.tilt_x = state.tilt_x;
+      frame.tilt_y = state.tilt_y;
+      frame.rotation = state.rotation;
+      frame.slider = state.slider;
+      if(frame_handler)
+        frame_handler(frame);
+    }
+    if(frame.valid & tablet_tool_frame_t::has_proximity_out)
+    {
+      focus = surface_t();
+      tablet = zwp_tablet_v2_t();
+    }
+    frame = tablet_tool_frame_t();
+  }
+};
+
+tablet_tool_aggregator_t::tablet_tool_aggregator_t(zwp_tablet_tool_v2_t tool)
+  : data(new tablet_tool_aggregator_data_t)
+{
+  tablet_tool_aggregator_data_t *d = data.get();
+  d->tool = std::move(tool);
+
+  d->tool.on_proximity_in() = [d] (uint32_t serial, zwp_tablet_v2_t tablet, surface_t surface)
+  {
+    d->frame.valid |= tablet_tool_frame_t::has_proximity_in;
+    d->frame.serial = serial;
+    d->tablet = std::move(tablet);
+    d->focus = std::move(surface);
+  };
+  d->tool.on_proximity_out() = [d] () { d->frame.valid |= tablet_tool_frame_t::has_proximity_out; };
+  d->tool.on_down() = [d] (uint32_t serial)
+  {
+    d->frame.valid |= tablet_tool_frame_t::has_down;
+    d->frame.serial = serial;
+  };
+  d->tool.on_up() = [d] () { d->frame.valid |= tablet_tool_frame_t::has_up; };
+  d->tool.on_motion() = [d] (double x, double y)
+  {
+    d->frame.valid |= tablet_tool_frame_t::has_motion;
+    d->state.x = x;
+    d->state.y = y;
+  };
+  d->tool.on_pressure() = [d] (uint32_t pressure)
+  {
+    d->frame.valid |= tablet_tool_frame_t::has_pressure;
+    d->state.pressure = pressure;
+  };
+  d->tool.on_distance() = [d] (uint32_t distance)
+  {
+    d->frame.valid |= tablet_tool_frame_t::has_distance;
+    d->state.distance = distance;
+  };
+  d->tool.on_tilt() = [d] (double tilt_x, double tilt_y)
+  {
+    d->frame.valid |= tablet_tool_frame_t::has_tilt;
+    d->state.tilt_x = tilt_x;
+    d->state.tilt_y = tilt_y;
+  };
+  d->tool.on_rotation() = [d] (double rotation)
+  {
+    d->frame.valid |= tablet_tool_frame_t::has_rotation;
+    d->state.rotation = rotation;
+  };
+  d->tool.on_slider() = [d] (int32_t slider)
+  {
+    d->frame.valid |= tablet_tool_frame_t::has_slider;
+    d->state.slider = slider;
+  };
+  d->tool.on_wheel() = [d] (double degrees, int32_t clicks)
+  {
+    d->frame.valid |= tablet_tool_frame_t::has_wheel;
+    d->frame.wheel += degrees;
+    d->frame.wheel_clicks += clicks;
+  };
+  d->tool.on_button() = [d] (uint32_t serial, uint32_t button, zwp_tablet_tool_v2_button_state state)
+  {
+    // the time is only sent with the frame event, use the previous one
+    if(d->frame.button_count == tablet_tool_frame_t::max_buttons)
+      d->deliver(d->state.time);
+    d->frame.valid |= tablet_tool_frame_t::has_button;
+    d->frame.buttons[d->frame.button_count++] = tablet_tool_button_event_t{serial, button, state};
+  };
+  d->tool.on_frame() = [d] (uint32_t time) { d->deliver(time); };
+}
+
+tablet_tool_aggregator_t::~tablet_tool_aggregator_t() = default;
+
+tablet_tool_aggregator_t::tablet_tool_aggregator_t(tablet_tool_aggregator_t&&) noexcept = default;
+
+tablet_tool_aggregator_t &tablet_tool_aggregator_t::operator=(tablet_tool_aggregator_t&&) noexcept = default;
+
+std::function<void(const tablet_tool_frame_t&)> &tablet_tool_aggregator_t::on_frame()
+{
+  return data->frame_handler;
+}
+
+surface_t tablet_tool_aggregator_t::get_focus() const
+{
+  return data->focus;
+}
+
+zwp_tablet_v2_t tablet_tool_aggregator_t::get_tablet() const
+{
+  return data->tablet;
+}
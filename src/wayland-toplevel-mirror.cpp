@@ -0,0 +1,723 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <unordered_map>
+#include <utility>
+#include <wayland-toplevel-mirror.hpp>
+
+using namespace wayland;
+using namespace wayland::detail;
+
+namespace
+{
+  // Collects the changes of a batch. Entries keep the order in which the
+  // keys were first touched, so change sets are deterministic.
+  class change_set_builder_t
+  {
+  private:
+    static const uint32_t added_bit = 1u << 31;
+    static const uint32_t removed_bit = 1u << 30;
+
+    std::vector<mirror_change_t> entries;
+    std::unordered_map<uint32_t, std::size_t> index;
+
+    uint32_t &fields(uint32_t key)
+    {
+      auto it = index.find(key);
+      if(it != index.end())
+        return entries[it->second].fields;
+      index.emplace(key, entries.size());
+      entries.push_back({key, 0});
+      return entries.back().fields;
+    }
+
+  public:
+    void add(uint32_t key) { fields(key) |= added_bit; }
+    void modify(uint32_t key, uint32_t mask) { if(mask) fields(key) |= mask; }
+    void remove(uint32_t key) { fields(key) |= removed_bit; }
+
+    bool empty() const
+    {
+      return entries.empty();
+    }
+
+    mirror_changes_t take()
+    {
+      mirror_changes_t changes;
+      for(const mirror_change_t &e : entries)
+      {
+        bool added = e.fields & added_bit;
+        bool removed = e.fields & removed_bit;
+        if(added && removed)
+          continue;
+        if(removed)
+          changes.removed.push_back(e.key);
+        else if(added)
+          changes.added.push_back(e.key);
+        else
+          changes.modified.push_back(e);
+      }
+      entries.clear();
+      index.clear();
+      return changes;
+    }
+  };
+
+  // Removes a row by moving the last row into its place.
+  template <typename T>
+  void swap_remove(std::vector<T> &column, std::size_t row)
+  {
+    if(row + 1 != column.size())
+      column[row] = std::move(column.back());
+    column.pop_back();
+  }
+
+  std::size_t find_row(const std::unordered_map<uint32_t, std::size_t> &rows, uint32_t key)
+  {
+    auto it = rows.find(key);
+    return it == rows.end() ? static_cast<std::size_t>(-1) : it->second;
+  }
+}
+
+bool mirror_changes_t::empty() const
+{
+  return added.empty() && removed.empty() && modified.empty();
+}
+
+struct wayland::detail::toplevel_mirror_data_t
+{
+  struct pending_t
+  {
+    uint32_t fields = 0;
+    std::string title;
+    std::string app_id;
+    std::string identifier;
+    // set until the first done event
+    ext_foreign_toplevel_handle_v1_t handle;
+  };
+
+  ext_foreign_toplevel_list_v1_t list;
+  uint32_t next_key = 1;
+
+  std::vector<uint32_t> keys;
+  std::vector<ext_foreign_toplevel_handle_v1_t> handles;
+  std::vector<std::string> titles;
+  std::vector<std::string> app_ids;
+  std::vector<std::string> identifiers;
+  std::unordered_map<uint32_t, std::size_t> rows;
+
+  // changes are rare compared to reads, so they are kept out of the columns
+  std::unordered_map<uint32_t, pending_t> pending;
+  change_set_builder_t changes;
+  std::function<void(const mirror_changes_t&)> changes_handler;
+
+  static void release(ext_foreign_toplevel_handle_v1_t &handle)
+  {
+    handle.on_title() = nullptr;
+    handle.on_app_id() = nullptr;
+    handle.on_identifier() = nullptr;
+    handle.on_done() = nullptr;
+    handle.on_closed() = nullptr;
+  }
+
+  ~toplevel_mirror_data_t()
+  {
+    if(list)
+    {
+      list.on_toplevel() = nullptr;
+      list.on_finished() = nullptr;
+    }
+    for(auto &handle : handles)
+      release(handle);
+    for(auto &p : pending)
+      if(p.second.handle)
+        release(p.second.handle);
+  }
+
+  void apply(uint32_t key)
+  {
+    auto it = pending.find(key);
+    if(it == pending.end())
+      return;
+    pending_t &p = it->second;
+
+    std::size_t row = find_row(rows, key);
+    if(row == static_cast<std::size_t>(-1))
+    {
+      rows.emplace(key, keys.size());
+      keys.push_back(key);
+      handles.push_back(std::move(p.handle));
+      titles.push_back(std::move(p.title));
+      app_ids.push_back(std::move(p.app_id));
+      identifiers.push_back(std::move(p.identifier));
+      changes.add(key);
+    }
+    else
+    {
+      if(p.fields & toplevel_mirror_t::field_title)
+        titles[row] = std::move(p.title);
+      if(p.fields & toplevel_mirror_t::field_app_id)
+        app_ids[row] = std::move(p.app_id);
+      if(p.fields & toplevel_mirror_t::field_identifier)
+        identifiers[row] = std::move(p.identifier);
+      changes.modify(key, p.fields);
+    }
+    pending.erase(it);
+  }
+
+  void remove(uint32_t key)
+  {
+    // no events follow closed, so the handlers can stay until the handle
+    // is destroyed
+    pending.erase(key);
+
+    std::size_t row = find_row(rows, key);
+    if(row == static_cast<std::size_t>(-1))
+      return;
+    rows.erase(key);
+    if(row + 1 != keys.size())
+      rows[keys.back()] = row;
+    swap_remove(keys, row);
+    swap_remove(handles, row);
+    swap_remove(titles, row);
+    swap_remove(app_ids, row);
+    swap_remove(identifiers, row);
+    changes.remove(key);
+  }
+
+  void add(ext_foreign_toplevel_handle_v1_t handle)
+  {
+    uint32_t key = next_key++;
+    toplevel_mirror_data_t *d = this;
+    handle.on_title() = [d, key] (const std::string &title)
+    {
+      pending_t &p = d->pending[key];
+      p.title = title;
+      p.fields |= toplevel_mirror_t::field_title;
+    };
+    handle.on_app_id() = [d, key] (const std::string &app_id)
+    {
+      pending_t &p = d->pending[key];
+      p.app_id = app_id;
+      p.fields |= toplevel_mirror_t::field_app_id;
+    };
+    handle.on_identifier() = [d, key] (const std::string &identifier)
+    {
+      pending_t &p = d->pending[key];
+      p.identifier = identifier;
+      p.fields |= toplevel_mirror_t::field_identifier;
+    };
+    handle.on_done() = [d, key] () { d->apply(key); };
+    handle.on_closed() = [d, key] () { d->remove(key); };
+    pending[key].handle = std::move(handle);
+  }
+};
+
+toplevel_mirror_t::toplevel_mirror_t(ext_foreign_toplevel_list_v1_t list)
+  : data(new toplevel_mirror_data_t)
+{
+  toplevel_mirror_data_t *d = data.get();
+  d->list = std::move(list);
+  d->list.on_toplevel() = [d] (ext_foreign_toplevel_handle_v1_t handle) { d->add(std::move(handle)); };
+}
+
+toplevel_mirror_t::~toplevel_mirror_t() = default;
+toplevel_mirror_t::toplevel_mirror_t(toplevel_mirror_t&&) noexcept = default;
+toplevel_mirror_t &toplevel_mirror_t::operator=(toplevel_mirror_t&&) noexcept = default;
+
+std::size_t toplevel_mirror_t::size() const
+{
+  return data->keys.size();
+}
+
+std::size_t toplevel_mirror_t::find(uint32_t key) const
+{
+  return find_row(data->rows, key);
+}
+
+const std::vector<uint32_t> &toplevel_mirror_t::keys() const
+{
+  return data->keys;
+}
+
+const std::vector<ext_foreign_toplevel_handle_v1_t> &toplevel_mirror_t::handles() const
+{
+  return data->handles;
+}
+
+const std::vector<std::string> &toplevel_mirror_t::titles() const
+{
+  return data->titles;
+}
+
+const std::vector<std::string> &toplevel_mirror_t::app_ids() const
+{
+  return data->app_ids;
+}
+
+const std::vector<std::string> &toplevel_mirror_t::identifiers() const
+{
+  return data->identifiers;
+}
+
+void toplevel_mirror_t::flush()
+{
+  if(data->changes.empty())
+    return;
+  mirror_changes_t changes = data->changes.take();
+  if(!changes.empty() && data->changes_handler)
+    data->changes_handler(changes);
+}
+
+std::function<void(const mirror_changes_t&)> &toplevel_mirror_t::on_changes()
+{
+  return data->changes_handler;
+}
+
+struct wayland::detail::workspace_mirror_data_t
+{
+  struct pending_t
+  {
+    uint32_t fields = 0;
+    bool removed = false;
+    std::string id;
+    std::string name;
+    std::vector<uint32_t> coordinates;
+    uint32_t state = 0;
+    uint32_t capabilities = 0;
+    uint32_t group = 0;
+    // set until the first done event
+    ext_workspace_handle_v1_t handle;
+  };
+
+  struct group_pending_t
+  {
+    uint32_t fields = 0;
+    bool removed = false;
+    uint32_t capabilities = 0;
+    std::vector<output_t> outputs;
+    // set until the first done event
+    ext_workspace_group_handle_v1_t handle;
+  };
+
+  ext_workspace_manager_v1_t manager;
+  uint32_t next_key = 1;
+
+  std::vector<uint32_t> keys;
+  std::vector<ext_workspace_handle_v1_t> handles;
+  std::vector<std::string> ids;
+  std::vector<std::string> names;
+  std::vector<std::vector<uint32_t>> coordinates;
+  std::vector<uint32_t> states;
+  std::vector<uint32_t> capabilities;
+  std::vector<uint32_t> groups;
+  std::unordered_map<uint32_t, std::size_t> rows;
+
+  std::vector<uint32_t> group_keys;
+  std::vector<ext_workspace_group_handle_v1_t> group_handles;
+  std::vector<uint32_t> group_capabilities;
+  std::vector<std::vector<output_t>> group_outputs;
+  std::unordered_map<uint32_t, std::size_t> group_rows;
+
+  // workspaces are passed to groups as objects, so they are looked up by id
+  std::unordered_map<uint32_t, uint32_t> workspace_keys;
+
+  // pending changes in the order of their first event
+  std::vector<uint32_t> pending_order;
+  std::unordered_map<uint32_t, pending_t> pending;
+  std::vector<uint32_t> group_pending_order;
+  std::unordered_map<uint32_t, group_pending_t> group_pending;
+
+  change_set_builder_t changes;
+  change_set_builder_t group_changes;
+  std::function<void(const mirror_changes_t&, const mirror_changes_t&)> changes_handler;
+
+  static void release(ext_workspace_handle_v1_t &handle)
+  {
+    handle.on_id() = nullptr;
+    handle.on_name() = nullptr;
+    handle.on_coordinates() = nullptr;
+    handle.on_state() = nullptr;
+    handle.on_capabilities() = nullptr;
+    handle.on_removed() = nullptr;
+  }
+
+  static void release(ext_workspace_group_handle_v1_t &handle)
+  {
+    handle.on_capabilities() = nullptr;
+    handle.on_output_enter() = nullptr;
+    handle.on_output_leave() = nullptr;
+    handle.on_workspace_enter() = nullptr;
+    handle.on_workspace_leave() = nullptr;
+    handle.on_removed() = nullptr;
+  }
+
+  ~workspace_mirror_data_t()
+  {
+    if(manager)
+    {
+      manager.on_workspace_group() = nullptr;
+      manager.on_workspace() = nullptr;
+      manager.on_done() = nullptr;
+      manager.on_finished() = nullptr;
+    }
+    for(auto &handle : handles)
+      release(handle);
+    for(auto &p : pending)
+      if(p.second.handle)
+        release(p.second.handle);
+    for(auto &handle : group_handles)
+      release(handle);
+    for(auto &p : group_pending)
+      if(p.second.handle)
+        release(p.second.handle);
+  }
+
+  pending_t &get_pending(uint32_t key)
+  {
+    auto it = pending.find(key);
+    if(it != pending.end())
+      return it->second;
+    pending_order.push_back(key);
+    return pending[key];
+  }
+
+  group_pending_t &get_group_pending(uint32_t key)
+  {
+    auto it = group_pending.find(key);
+    if(it != group_pending.end())
+      return it->second;
+    group_pending_order.push_back(key);
+    return group_pending[key];
+  }
+
+  // group of a workspace including pending changes
+  uint32_t current_group(uint32_t key)
+  {
+    auto it = pending.find(key);
+    if(it != pending.end() && (it->second.fields & workspace_mirror_t::field_group))
+      return it->second.group;
+    std::size_t row = find_row(rows, key);
+    return row == static_cast<std::size_t>(-1) ? 0 : groups[row];
+  }
+
+  void set_group(ext_workspace_handle_v1_t &workspace, uint32_t group, bool enter)
+  {
+    auto it = workspace_keys.find(workspace.get_id());
+    if(it == workspace_keys.end())
+      return;
+    // the leave of the old group may follow the enter of the new one
+    if(!enter && current_group(it->second) != group)
+      return;
+    pending_t &p = get_pending(it->second);
+    p.group = enter ? group : 0;
+    p.fields |= workspace_mirror_t::field_group;
+  }
+
+  void change_outputs(uint32_t key, const output_t &output, bool enter)
+  {
+    group_pending_t &p = get_group_pending(key);
+    if(!(p.fields & workspace_mirror_t::group_field_outputs))
+    {
+      std::size_t row = find_row(group_rows, key);
+      if(row != static_cast<std::size_t>(-1))
+        p.outputs = group_outputs[row];
+      p.fields |= workspace_mirror_t::group_field_outputs;
+    }
+    for(auto it = p.outputs.begin(); it != p.outputs.end(); ++it)
+      if(*it == output)
+      {
+        p.outputs.erase(it);
+        break;
+      }
+    if(enter)
+      p.outputs.push_back(output);
+  }
+
+  void apply_workspace(uint32_t key, pending_t &p)
+  {
+    std::size_t row = find_row(rows, key);
+    if(p.removed)
+    {
+      if(row == static_cast<std::size_t>(-1))
+      {
+        workspace_keys.erase(p.handle.get_id());
+        return;
+      }
+      workspace_keys.erase(handles[row].get_id());
+      rows.erase(key);
+      if(row + 1 != keys.size())
+        rows[keys.back()] = row;
+      swap_remove(keys, row);
+      swap_remove(handles, row);
+      swap_remove(ids, row);
+      swap_remove(names, row);
+      swap_remove(coordinates, row);
+      swap_remove(states, row);
+      swap_remove(capabilities, row);
+      swap_remove(groups, row);
+      changes.remove(key);
+    }
+    else if(row == static_cast<std::size_t>(-1))
+    {
+      rows.emplace(key, keys.size());
+      keys.push_back(key);
+      handles.push_back(std::move(p.handle));
+      ids.push_back(std::move(p.id));
+      names.push_back(std::move(p.name));
+      coordinates.push_back(std::move(p.coordinates));
+      states.push_back(p.state);
+      capabilities.push_back(p.capabilities);
+      groups.push_back(p.group);
+      changes.add(key);
+    }
+    else
+    {
+      if(p.fields & workspace_mirror_t::field_id)
+        ids[row] = std::move(p.id);
+      if(p.fields & workspace_mirror_t::field_name)
+        names[row] = std::move(p.name);
+      if(p.fields & workspace_mirror_t::field_coordinates)
+        coordinates[row] = std::move(p.coordinates);
+      if(p.fields & workspace_mirror_t::field_state)
+        states[row] = p.state;
+      if(p.fields & workspace_mirror_t::field_capabilities)
+        capabilities[row] = p.capabilities;
+      if(p.fields & workspace_mirror_t::field_group)
+        groups[row] = p.group;
+      changes.modify(key, p.fields);
+    }
+  }
+
+  void apply_group(uint32_t key, group_pending_t &p)
+  {
+    std::size_t row = find_row(group_rows, key);
+    if(p.removed)
+    {
+      if(row == static_cast<std::size_t>(-1))
+        return;
+      group_rows.erase(key);
+      if(row + 1 != group_keys.size())
+        group_rows[group_keys.back()] = row;
+      swap_remove(group_keys, row);
+      swap_remove(group_handles, row);
+      swap_remove(group_capabilities, row);
+      swap_remove(group_outputs, row);
+      group_changes.remove(key);
+    }
+    else if(row == static_cast<std::size_t>(-1))
+    {
+      group_rows.emplace(key, group_keys.size());
+      group_keys.push_back(key);
+      group_handles.push_back(std::move(p.handle));
+      group_capabilities.push_back(p.capabilities);
+      group_outputs.push_back(std::move(p.outputs));
+      group_changes.add(key);
+    }
+    else
+    {
+      if(p.fields & workspace_mirror_t::group_field_capabilities)
+        group_capabilities[row] = p.capabilities;
+      if(p.fields & workspace_mirror_t::group_field_outputs)
+        group_outputs[row] = std::move(p.outputs);
+      group_changes.modify(key, p.fields);
+    }
+  }
+
+  void done()
+  {
+    for(uint32_t key : group_pending_order)
+      apply_group(key, group_pending[key]);
+    group_pending_order.clear();
+    group_pending.clear();
+    for(uint32_t key : pending_order)
+      apply_workspace(key, pending[key]);
+    pending_order.clear();
+    pending.clear();
+
+    if(changes.empty() && group_changes.empty())
+      return;
+    mirror_changes_t workspace_set = changes.take();
+    mirror_changes_t group_set = group_changes.take();
+    if(changes_handler && !(workspace_set.empty() && group_set.empty()))
+      changes_handler(workspace_set, group_set);
+  }
+
+  void add_workspace(ext_workspace_handle_v1_t handle)
+  {
+    uint32_t key = next_key++;
+    workspace_mirror_data_t *d = this;
+    handle.on_id() = [d, key] (const std::string &id)
+    {
+      pending_t &p = d->get_pending(key);
+      p.id = id;
+      p.fields |= workspace_mirror_t::field_id;
+    };
+    handle.on_name() = [d, key] (const std::string &name)
+    {
+      pending_t &p = d->get_pending(key);
+      p.name = name;
+      p.fields |= workspace_mirror_t::field_name;
+    };
+    handle.on_coordinates() = [d, key] (const array_t &coordinates)
+    {
+      pending_t &p = d->get_pending(key);
+      p.coordinates = coordinates.operator std::vector<uint32_t>();
+      p.fields |= workspace_mirror_t::field_coordinates;
+    };
+    handle.on_state() = [d, key] (ext_workspace_handle_v1_state state)
+    {
+      pending_t &p = d->get_pending(key);
+      p.state = static_cast<uint32_t>(state);
+      p.fields |= workspace_mirror_t::field_state;
+    };
+    handle.on_capabilities() = [d, key] (ext_workspace_handle_v1_workspace_capabilities capabilities)
+    {
+      pending_t &p = d->get_pending(key);
+      p.capabilities = static_cast<uint32_t>(capabilities);
+      p.fields |= workspace_mirror_t::field_capabilities;
+    };
+    handle.on_removed() = [d, key] () { d->get_pending(key).removed = true; };
+    workspace_keys[handle.get_id()] = key;
+    get_pending(key).handle = std::move(handle);
+  }
+
+  void add_group(ext_workspace_group_handle_v1_t handle)
+  {
+    uint32_t key = next_key++;
+    workspace_mirror_data_t *d = this;
+    handle.on_capabilities() = [d, key] (ext_workspace_group_handle_v1_group_capabilities capabilities)
+    {
+      group_pending_t &p = d->get_group_pending(key);
+      p.capabilities = static_cast<uint32_t>(capabilities);
+      p.fields |= workspace_mirror_t::group_field_capabilities;
+    };
+    handle.on_output_enter() = [d, key] (output_t output) { d->change_outputs(key, output, true); };
+    handle.on_output_leave() = [d, key] (output_t output) { d->change_outputs(key, output, false); };
+    handle.on_workspace_enter() = [d, key] (ext_workspace_handle_v1_t workspace) { d->set_group(workspace, key, true); };
+    handle.on_workspace_leave() = [d, key] (ext_workspace_handle_v1_t workspace) { d->set_group(workspace, key, false); };
+    handle.on_removed() = [d, key] () { d->get_group_pending(key).removed = true; };
+    get_group_pending(key).handle = std::move(handle);
+  }
+};
+
+workspace_mirror_t::workspace_mirror_t(ext_workspace_manager_v1_t manager)
+  : data(new workspace_mirror_data_t)
+{
+  workspace_mirror_data_t *d = data.get();
+  d->manager = std::move(manager);
+  d->manager.on_workspace_group() = [d] (ext_workspace_group_handle_v1_t group) { d->add_group(std::move(group)); };
+  d->manager.on_workspace() = [d] (ext_workspace_handle_v1_t workspace) { d->add_workspace(std::move(workspace)); };
+  d->manager.on_done() = [d] () { d->done(); };
+}
+
+workspace_mirror_t::~workspace_mirror_t() = default;
+workspace_mirror_t::workspace_mirror_t(workspace_mirror_t&&) noexcept = default;
+workspace_mirror_t &workspace_mirror_t::operator=(workspace_mirror_t&&) noexcept = default;
+
+std::size_t workspace_mirror_t::size() const
+{
+  return data->keys.size();
+}
+
+std::size_t workspace_mirror_t::find(uint32_t key) const
+{
+  return find_row(data->rows, key);
+}
+
+const std::vector<uint32_t> &workspace_mirror_t::keys() const
+{
+  return data->keys;
+}
+
+const std::vector<ext_workspace_handle_v1_t> &workspace_mirror_t::handles() const
+{
+  return data->handles;
+}
+
+const std::vector<std::string> &workspace_mirror_t::ids() const
+{
+  return data->ids;
+}
+
+const std::vector<std::string> &workspace_mirror_t::names() const
+{
+  return data->names;
+}
+
+const std::vector<std::vector<uint32_t>> &workspace_mirror_t::coordinates() const
+{
+  return data->coordinates;
+}
+
+const std::vector<uint32_t> &workspace_mirror_t::states() const
+{
+  return data->states;
+}
+
+const std::vector<uint32_t> &workspace_mirror_t::capabilities() const
+{
+  return data->capabilities;
+}
+
+const std::vector<uint32_t> &workspace_mirror_t::groups() const
+{
+  return data->groups;
+}
+
+std::size_t workspace_mirror_t::group_count() const
+{
+  return data->group_keys.size();
+}
+
+std::size_t workspace_mirror_t::find_group(uint32_t key) const
+{
+  return find_row(data->group_rows, key);
+}
+
+const std::vector<uint32_t> &workspace_mirror_t::group_keys() const
+{
+  return data->group_keys;
+}
+
+const std::vector<ext_workspace_group_handle_v1_t> &workspace_mirror_t::group_handles() const
+{
+  return data->group_handles;
+}
+
+const std::vector<uint32_t> &workspace_mirror_t::group_capabilities() const
+{
+  return data->group_capabilities;
+}
+
+const std::vector<std::vector<output_t>> &workspace_mirror_t::group_outputs() const
+{
+  return data->group_outputs;
+}
+
+std::function<void(const mirror_changes_t&, const mirror_changes_t&)> &workspace_mirror_t::on_changes()
+{
+  return data->changes_handler;
+}
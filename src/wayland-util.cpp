@@ -45,6 +45,58 @@ namespace wayland
   }
 }
 
+namespace
+{
+  class new_delete_resource_t : public memory_resource_t
+  {
+  protected:
+    void *do_allocate(std::size_t bytes, std::size_t /*alignment*/) override
+    {
+      return ::operator new(bytes);
+    }
+
+    void do_deallocate(void *p, std::size_t /*bytes*/, std::size_t /*alignment*/) override
+    {
+      ::operator delete(p);
+    }
+  };
+}
+
+void *memory_resource_t::allocate(std::size_t bytes, std::size_t alignment)
+{
+  void *p = do_allocate(bytes, alignment);
+  allocations++;
+  std::size_t in_use = bytes_in_use += bytes;
+  std::size_t peak = peak_bytes_in_use;
+  while(in_use > peak && !peak_bytes_in_use.compare_exchange_weak(peak, in_use))
+    ;
+  return p;
+}
+
+void memory_resource_t::deallocate(void *p, std::size_t bytes, std::size_t alignment)
+{
+  deallocations++;
+  bytes_in_use -= bytes;
+  // Last access, so that do_deallocate() may destroy the resource
+  do_deallocate(p, bytes, alignment);
+}
+
+memory_stats_t memory_resource_t::get_stats() const
+{
+  memory_stats_t stats;
+  stats.allocations = allocations;
+  stats.deallocations = deallocations;
+  stats.bytes_in_use = bytes_in_use;
+  stats.peak_bytes_in_use = peak_bytes_in_use;
+  return stats;
+}
+
+memory_resource_t *wayland::new_delete_resource()
+{
+  static new_delete_resource_t resource;
+  return &resource;
+}
+
 argument_t::argument_t(const argument_t &arg)
 {
   operator=(arg);
@@ -189,3 +241,13 @@ array_t &array_t::operator=(array_t &&arr) noexcept
   std::swap(a, arr.a);
   return *this;
 }
+
+const void *array_t::data() const
+{
+  return a.data;
+}
+
+std::size_t array_t::size() const
+{
+  return a.size;
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2026, Nils Christopher Brause
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ * ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <wayland-xdg-window.hpp>
+
+using namespace wayland;
+using namespace wayland::detail;
+
+bool xdg_window_state_t::has_state(xdg_toplevel_state state) const
+{
+  return std::find(states.begin(), states.end(), state) != states.end();
+}
+
+bool xdg_window_state_t::has_capability(xdg_toplevel_wm_capabilities capability) const
+{
+  return std::find(capabilities.begin(), capabilities.end(), capability) != capabilities.end();
+}
+
+struct wayland::detail::xdg_window_data_t
+{
+  surface_t surface;
+  frame_clock_t *clock = nullptr;
+  xdg_surface_t xdg_surface;
+  xdg_toplevel_t toplevel;
+  std::function<void(const xdg_window_state_t&)> configure_handler;
+  std::function<void(const frame_tick_t&)> render_handler;
+  std::function<void()> close_handler;
+
+  // toplevel events of the configure sequence in progress
+  xdg_window_state_t pending;
+  // latest complete configure sequence, not acknowledged yet
+  xdg_window_state_t configured;
+  bool has_configure = false;
+  // last acknowledged configure sequence
+  xdg_window_state_t current;
+
+  ~xdg_window_data_t()
+  {
+    if(clock)
+      clock->remove_surface(surface);
+  }
+
+  void render(const frame_tick_t &tick)
+  {
+    if(has_configure)
+    {
+      // every configure up to this serial is acknowledged with it
+      has_configure = false;
+      xdg_surface.ack_configure(configured.serial);
+      current = configured;
+      if(configure_handler)
+        configure_handler(current);
+    }
+    if(render_handler)
+      render_handler(tick);
+    else
+      surface.commit();
+  }
+};
+
+xdg_window_t::xdg_window_t(xdg_wm_base_t wm_base, surface_t surface, frame_clock_t &clock)
+  : data(new xdg_window_data_t)
+{
+  xdg_window_data_t *d = data.get();
+  d->surface = std::move(surface);
+  d->xdg_surface = wm_base.get_xdg_surface(d->surface);
+  d->toplevel = d->xdg_surface.get_toplevel();
+
+  d->toplevel.on_configure() = [d] (int32_t width, int32_t height, array_t states)
+  {
+    d->pending.width = width;
+    d->pending.height = height;
+    d->pending.states = states;
+  };
+  d->toplevel.on_configure_bounds() = [d] (int32_t width, int32_t height)
+  {
+    d->pending.bounds_width = width;
+    d->pending.bounds_height = height;
+  };
+  d->toplevel.on_wm_capabilities() = [d] (array_t capabilities) { d->pending.capabilities = capabilities; };
+  d->toplevel.on_close() = [d] ()
+  {
+    if(d->close_handler)
+      d->close_handler();
+  };
+  d->xdg_surface.on_configure() = [d] (uint32_t serial)
+  {
+    d->pending.serial = serial;
+    d->configured = d->pending;
+    bool scheduled = d->has_configure;
+    d->has_configure = true;
+    if(!scheduled)
+      d->clock->schedule(d->surface);
+  };
+
+  clock.add_surface(d->surface, [d] (const frame_tick_t &tick) { d->render(tick); });
+  d->clock = &clock;
+}
+
+xdg_window_t::~xdg_window_t() = default;
+
+xdg_window_t::xdg_window_t(xdg_window_t&&) noexcept = default;
+
+xdg_window_t &xdg_window_t::operator=(xdg_window_t&&) noexcept = default;
+
+xdg_surface_t xdg_window_t::get_xdg_surface() const
+{
+  return data->xdg_surface;
+}
+
+xdg_toplevel_t xdg_window_t::get_toplevel() const
+{
+  return data->toplevel;
+}
+
+const xdg_window_state_t &xdg_window_t::get_state() const
+{
+  return data->current;
+}
+
+bool xdg_window_t::is_configure_pending() const
+{
+  return data->has_configure;
+}
+
+void xdg_window_t::schedule()
+{
+  data->clock->schedule(data->surface);
+}
+
+std::function<void(const xdg_window_state_t&)> &xdg_window_t::on_configure()
+{
+  return data->configure_handler;
+}
+
+std::function<void(const frame_tick_t&)> &xdg_window_t::on_render()
+{
+  return data->render_handler;
+}
+
+std::function<void()> &xdg_window_t::on_close()
+{
+  return data->close_handler;
+}